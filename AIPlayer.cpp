@@ -1,14 +1,74 @@
 // AIPlayer.cpp
 #include "aiplayer.h"
+#include "decisionCache.h"
+#include "handBatch.h"
+#include "moveBatcher.h"
 #include <algorithm>
 #include <chrono>
-#include <map>
-#include <set>
-#include <functional>
-#include <numeric> // std::iota 需要这个
+#include <climits>
+#include <span>
 #include <QTimer>
 #include <QDebug>
 
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+// 搜索最多估计这么多手候选（按启发式分数从好到差）
+constexpr size_t kSearchWidth = 24;
+
+// 搜索用的剩余手牌：从 AI 自己已刷新的索引复制一份开始，有序手牌去掉若干张后仍保持次序，
+// 每出一手、每次还原都只重算受影响的点数，单步耗时不超过一次增量刷新
+struct Remainder {
+    std::vector<Card> hand;
+    std::vector<Card> step;
+    std::vector<Card> removed; // 还原前拿掉的全部牌
+    MoveIndex index;
+
+    void start(const std::vector<Card>& from, const MoveIndex& fromIndex) {
+        hand = from;
+        index = fromIndex;
+        removed.clear();
+    }
+    void remove(std::span<const Card> play) {
+        step.assign(play.begin(), play.end());
+        for (const Card& c : play) {
+            auto it = std::find(hand.begin(), hand.end(), c);
+            if (it != hand.end()) hand.erase(it);
+        }
+        removed.insert(removed.end(), play.begin(), play.end());
+        index.cardsChanged(step);
+    }
+    // 回到 start 时的手牌
+    void restore(const std::vector<Card>& from) {
+        hand = from;
+        index.cardsChanged(removed);
+        removed.clear();
+    }
+};
+
+// 贪心估计出完剩余手牌还要几手：每次出张数最多的一手；到 deadline 还没估完返回 -1
+int handsToFinish(Remainder& rest, int levelRank, SteadyClock::time_point deadline) {
+    int hands = 0;
+    Play play;
+    while (!rest.hand.empty()) {
+        if (SteadyClock::now() >= deadline) return -1;
+        // 只比张数，不展开全部候选（也不会覆盖调用方手里 legalMoves 的展开结果）
+        const auto& moves = rest.index.packedMoves(rest.hand, levelRank);
+        if (moves.empty()) return -1;
+        size_t pick = 0;
+        for (size_t i = 1; i < moves.size(); ++i) {
+            if (moves[i].size() > moves[pick].size()) pick = i;
+        }
+        moves[pick].unpack(play);
+        rest.remove(play);
+        ++hands;
+    }
+    return hands;
+}
+
+} // namespace
+
 AIPlayer::AIPlayer(int id, const std::string& name, QObject* parent)
     : QObject(parent), Player(id, name),
     rng_(static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count()))
@@ -57,302 +117,155 @@ bool AIPlayer::canBeat(const std::vector<Card>& candidate, const std::vector<Car
     return candInfo.primaryRank > baseInfo.primaryRank;
 }
 
-// 生成可能出牌 - 最终修复版 (支持所有掼蛋牌型)
+// 生成可能出牌：直接取 Player 维护的合法出牌索引（支持所有掼蛋牌型，见 MoveIndex）
 std::vector<std::vector<Card>> AIPlayer::generatePossiblePlays(int levelRank) const {
-    std::vector<std::vector<Card>> valid;
-    std::vector<Card> hand = getHandCopy();
-    if (hand.empty()) return valid;
-
-    // 判定红桃级牌（万能牌）
-    auto isWild = [levelRank](const Card& c) {
-        return c.getSuit() == Suit::Hearts && c.getRankInt() == levelRank;
-    };
-
-    // 预处理
-    std::map<int, std::vector<Card>> rankGroups;
-    std::map<int, std::vector<Card>> logGroups;
-    std::map<Suit, std::map<int, std::vector<Card>>> suitGroups;
-    std::vector<Card> wildCards;
-
-    auto logValue = [levelRank](const Card& c) {
-        int r = c.getRankInt();
-        if (c.getRank() == Rank::B) return 20;
-        if (c.getRank() == Rank::S) return 19;
-        if (r == levelRank) return 18;
-        if (r == 15) return 2; // 还原 2
-        return r;
-    };
-
-    // 排序
-    std::sort(hand.begin(), hand.end(), [](const Card& a, const Card& b){
-        if (a.getRankInt() != b.getRankInt()) return a.getRankInt() < b.getRankInt();
-        return static_cast<int>(a.getSuit()) < static_cast<int>(b.getSuit());
-    });
+    const auto& legal = legalMoves(levelRank);
+    std::vector<std::vector<Card>> plays;
+    plays.reserve(legal.size());
+    for (const Play& play : legal) plays.emplace_back(play.begin(), play.end());
+    return plays;
+}
 
-    for (const auto& c : hand) {
-        if (isWild(c)) {
-            wildCards.push_back(c);
-            continue;
-        }
-        int r = c.getRankInt();
-        rankGroups[r].push_back(c);
-        logGroups[logValue(c)].push_back(c);
-        if (c.getSuit() != Suit::None) {
-            suitGroups[c.getSuit()][c.getRankInt()].push_back(c);
-        }
-    }
-
-    std::set<std::string> seen;
-    auto keyOf = [](const std::vector<Card>& cards) {
-        std::vector<Card> sorted = cards;
-        std::sort(sorted.begin(), sorted.end(), [](const Card& a, const Card& b){
-            if (a.getRankInt() != b.getRankInt()) return a.getRankInt() < b.getRankInt();
-            return static_cast<int>(a.getSuit()) < static_cast<int>(b.getSuit());
-        });
-        std::string key;
-        for (const auto& c : sorted) key += c.toString() + "|";
-        return key;
-    };
-
-    auto addIfValid = [&](const std::vector<Card>& cards) {
-        if (cards.empty()) return;
-        if (evaluateHandType(cards, levelRank) == HandType::Invalid) return;
-        std::string key = keyOf(cards);
-        if (seen.insert(key).second) valid.push_back(cards);
-    };
-
-    auto choose = [](const std::vector<Card>& src, int k) {
-        std::vector<std::vector<Card>> res;
-        if (k == 0) { res.push_back({}); return res; }
-        if (k > static_cast<int>(src.size())) return res;
-        std::vector<int> idx(k);
-        std::iota(idx.begin(), idx.end(), 0);
-        while (true) {
-            std::vector<Card> pick;
-            for (int i : idx) pick.push_back(src[i]);
-            res.push_back(pick);
-            int pos = k - 1;
-            while (pos >= 0 && idx[pos] == static_cast<int>(src.size()) - k + pos) pos--;
-            if (pos < 0) break;
-            idx[pos]++;
-            for (int j = pos + 1; j < k; ++j) idx[j] = idx[j - 1] + 1;
-        }
-        return res;
-    };
-
-    // 1) 基础牌型
-    for (const auto& [rank, cards] : rankGroups) {
-        int sz = static_cast<int>(cards.size());
-        for (int take = 1; take <= std::min(3, sz); ++take) {
-            for (const auto& subset : choose(cards, take)) addIfValid(subset);
-        }
-        for (int need = 1; need <= 3; ++need) {
-            int maxWild = std::min(need, static_cast<int>(wildCards.size()));
-            for (int wildUse = 1; wildUse <= maxWild; ++wildUse) {
-                int solidNeed = need - wildUse;
-                if (solidNeed < 0 || solidNeed > sz) continue;
-                for (const auto& subset : choose(cards, solidNeed)) {
-                    std::vector<Card> combo = subset;
-                    combo.insert(combo.end(), wildCards.begin(), wildCards.begin() + wildUse);
-                    addIfValid(combo);
-                }
-            }
-        }
-    }
-    for (int need = 1; need <= std::min(3, static_cast<int>(wildCards.size())); ++need) {
-        addIfValid(std::vector<Card>(wildCards.begin(), wildCards.begin() + need));
+void AIPlayer::describePlays(const std::vector<Play>& plays, size_t from, int levelRank, MoveColumns& out) const {
+    // 整批候选一次识别，不再逐手构造 HandMatcher；缓冲区按线程复用（每个分片线程一份）
+    thread_local HandBatch batch;
+    batch.clear();
+    for (size_t i = from; i < plays.size(); ++i) batch.push(plays[i], levelRank);
+    batch.classify();
+    for (size_t i = from; i < plays.size(); ++i) {
+        const size_t lane = i - from;
+        out.push(batch.info(lane), static_cast<int>(plays[i].size()), batch.wildCount(lane), static_cast<uint32_t>(rng_()));
     }
+}
 
-    // 2) 炸弹
-    int wildTotal = static_cast<int>(wildCards.size());
-    for (const auto& [rank, cards] : rankGroups) {
-        int sz = static_cast<int>(cards.size());
-        for (int total = 4; total <= sz + wildTotal; ++total) {
-            int minSolids = std::max(1, total - wildTotal);
-            int maxSolids = std::min(total, sz);
-            for (int solidsTake = minSolids; solidsTake <= maxSolids; ++solidsTake) {
-                int wildNeed = total - solidsTake;
-                for (const auto& subset : choose(cards, solidsTake)) {
-                    std::vector<Card> combo = subset;
-                    if (wildNeed > 0) combo.insert(combo.end(), wildCards.begin(), wildCards.begin() + wildNeed);
-                    addIfValid(combo);
-                }
-            }
-        }
-    }
+std::vector<Card> AIPlayer::decideToMove(const std::vector<Card>& lastCards, int levelRank) {
+    Play chosen;
+    if (!decideToMove(lastCards, levelRank, chosen)) return {};
+    return {chosen.begin(), chosen.end()};
+}
 
-    // 3) 天王炸
-    auto jokerCount = [&](Rank r) {
-        auto it = rankGroups.find(static_cast<int>(r));
-        return (it == rankGroups.end()) ? 0 : static_cast<int>(it->second.size());
-    };
-    if (jokerCount(Rank::S) >= 2 && jokerCount(Rank::B) >= 2) {
-        std::vector<Card> combo;
-        combo.insert(combo.end(), rankGroups.at(static_cast<int>(Rank::S)).begin(), rankGroups.at(static_cast<int>(Rank::S)).begin() + 2);
-        combo.insert(combo.end(), rankGroups.at(static_cast<int>(Rank::B)).begin(), rankGroups.at(static_cast<int>(Rank::B)).begin() + 2);
-        addIfValid(combo);
-    }
+bool AIPlayer::decideToMove(const std::vector<Card>& lastCards, int levelRank, Play& chosen) {
+    const auto deadline = thinkBudget_.count() > 0 ? SteadyClock::now() + thinkBudget_ : SteadyClock::time_point::min();
+    return decideToMove(lastCards, levelRank, chosen, deadline);
+}
 
-    // 4) 三带二
-    for (const auto& [tripRank, tripCards] : rankGroups) {
-        for (const auto& [pairRank, pairCards] : rankGroups) {
-            for (int wildTrip = 0; wildTrip <= wildTotal; ++wildTrip) {
-                for (int wildPair = 0; wildPair + wildTrip <= wildTotal; ++wildPair) {
-                    int needTrip = 3 - wildTrip, needPair = 2 - wildPair;
-                    if (needTrip < 0 || needPair < 0) continue;
-                    if (needTrip > (int)tripCards.size() || needPair > (int)pairCards.size()) continue;
-                    if (needTrip + needPair + wildTrip + wildPair != 5) continue;
-                    for (const auto& tSubset : choose(tripCards, needTrip)) {
-                        for (const auto& pSubset : choose(pairCards, needPair)) {
-                            std::vector<Card> combo = tSubset;
-                            combo.insert(combo.end(), pSubset.begin(), pSubset.end());
-                            combo.insert(combo.end(), wildCards.begin(), wildCards.begin() + wildTrip + wildPair);
-                            addIfValid(combo);
-                        }
-                    }
-                }
-            }
+bool AIPlayer::decideToMove(const std::vector<Card>& lastCards, int levelRank, Play& chosen,
+                            std::chrono::steady_clock::time_point deadline) {
+    chosen.clear();
+    const PlayInfo base = lastCards.empty() ? PlayInfo{} : HandBatch::classifyOne(lastCards, levelRank);
+    const int baseCards = static_cast<int>(lastCards.size());
+
+    // 别人回合里预想过这个局面就直接取用；这次决策之后手牌就变了，预想的结果一并作废
+    if (ponderCount_ > 0) {
+        const DecisionCache::Key key = DecisionCache::makeKey(handCards, base, baseCards, levelRank);
+        const size_t count = ponderCount_;
+        ponderCount_ = 0;
+        ponderNext_ = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!(pondered_[i].key == key)) continue;
+            chosen = pondered_[i].chosen;
+            ++thinkStats_.ponderHits;
+            return !chosen.empty();
         }
     }
+    return decide(base, baseCards, levelRank, chosen, deadline);
+}
 
-    // 5) 三连对
-    std::vector<int> logKeys;
-    for (const auto& kv : logGroups) logKeys.push_back(kv.first);
-    std::sort(logKeys.begin(), logKeys.end());
-    for (size_t i = 0; i + 2 < logKeys.size(); ++i) {
-        int a = logKeys[i], b = logKeys[i + 1], c = logKeys[i + 2];
-        if (b != a + 1 || c != b + 1) continue;
-        const auto& g1 = logGroups[a];
-        const auto& g2 = logGroups[b];
-        const auto& g3 = logGroups[c];
-
-        auto tryCombo = [&](int w1, int w2, int w3, int usedWild) {
-            if (usedWild > wildTotal) return;
-            if (g1.size() < (2-w1) || g2.size() < (2-w2) || g3.size() < (2-w3)) return;
-            for (const auto& p1 : choose(g1, 2-w1))
-                for (const auto& p2 : choose(g2, 2-w2))
-                    for (const auto& p3 : choose(g3, 2-w3)) {
-                        std::vector<Card> c = p1;
-                        c.insert(c.end(), p2.begin(), p2.end());
-                        c.insert(c.end(), p3.begin(), p3.end());
-                        if (usedWild > 0) c.insert(c.end(), wildCards.begin(), wildCards.begin() + usedWild);
-                        addIfValid(c);
-                    }
-        };
-        tryCombo(0,0,0,0); // 0 wild
-        tryCombo(1,0,0,1); tryCombo(0,1,0,1); tryCombo(0,0,1,1); // 1 wild
-    }
-
-    // 6) 钢板
-    for (size_t i = 0; i + 1 < logKeys.size(); ++i) {
-        int a = logKeys[i], b = logKeys[i + 1];
-        if (b != a + 1) continue;
-        const auto& g1 = logGroups[a];
-        const auto& g2 = logGroups[b];
-
-        auto tryCombo = [&](int w1, int w2, int usedWild) {
-            if (usedWild > wildTotal) return;
-            if (g1.size() < (3-w1) || g2.size() < (3-w2)) return;
-            for (const auto& p1 : choose(g1, 3-w1))
-                for (const auto& p2 : choose(g2, 3-w2)) {
-                    std::vector<Card> c = p1;
-                    c.insert(c.end(), p2.begin(), p2.end());
-                    if (usedWild > 0) c.insert(c.end(), wildCards.begin(), wildCards.begin() + usedWild);
-                    addIfValid(c);
-                }
-        };
-        tryCombo(0,0,0);
-        tryCombo(1,0,1); tryCombo(0,1,1);
+bool AIPlayer::ponder(const std::vector<Card>& lastCards, int levelRank, std::chrono::steady_clock::time_point deadline) {
+    if (handCards.empty()) return false;
+    const PlayInfo base = lastCards.empty() ? PlayInfo{} : HandBatch::classifyOne(lastCards, levelRank);
+    const int baseCards = static_cast<int>(lastCards.size());
+    const DecisionCache::Key key = DecisionCache::makeKey(handCards, base, baseCards, levelRank);
+    for (size_t i = 0; i < ponderCount_; ++i) {
+        if (pondered_[i].key == key) return true;
     }
+    if (SteadyClock::now() >= deadline) return false;
+
+    // 与真轮到时同样决策，只是时限用别人回合的空闲时间
+    const uint64_t timeouts = thinkStats_.timeouts;
+    Play chosen;
+    decide(base, baseCards, levelRank, chosen, deadline);
+    if (thinkStats_.timeouts != timeouts) return false;
+
+    PonderedMove& slot = pondered_[ponderNext_];
+    ponderNext_ = (ponderNext_ + 1) % kPonderSlots;
+    ponderCount_ = std::min(ponderCount_ + 1, kPonderSlots);
+    slot.key = key;
+    slot.chosen = chosen;
+    ++thinkStats_.pondered;
+    return true;
+}
 
-    // 7) 同花顺
-    for (const auto& [suit, rankMap] : suitGroups) {
-        auto findRankCard = [&](int r) -> const Card* {
-            auto it = rankMap.find(r);
-            if (it != rankMap.end() && !it->second.empty()) return &it->second.front();
-            if (r == 2) { // Fix Rank 2 issue
-                auto it15 = rankMap.find(15);
-                if (it15 != rankMap.end() && !it15->second.empty()) return &it15->second.front();
-            }
-            return nullptr;
-        };
-        auto checkSeq = [&](const std::vector<int>& targetRanks) {
-            std::vector<Card> seq;
-            int missing = 0;
-            for (int r : targetRanks) {
-                if (const Card* card = findRankCard(r)) seq.push_back(*card);
-                else missing++;
-            }
-            if (missing <= wildTotal) {
-                seq.insert(seq.end(), wildCards.begin(), wildCards.begin() + missing);
-                addIfValid(seq);
-            }
-        };
-
-        for (int start = 2; start <= 10; ++start) {
-            std::vector<int> tr; for(int i=0; i<5; ++i) tr.push_back(start+i);
-            checkSeq(tr);
-        }
-        checkSeq({14, 2, 3, 4, 5}); // A2345
+bool AIPlayer::decide(const PlayInfo& base, int baseCards, int levelRank, Play& chosen,
+                      std::chrono::steady_clock::time_point deadline) {
+    chosen.clear();
+    const bool search = deadline != SteadyClock::time_point::min() && SteadyClock::now() < deadline;
+
+    // 不搜索时结果只取决于手牌与局面：同样的手牌、上家牌型与级牌算过的话，直接在缓存的并列最优里随机挑
+    const bool useCache = cache_ && !search;
+    DecisionCache::Key key;
+    if (useCache) {
+        key = DecisionCache::makeKey(handCards, base, baseCards, levelRank);
+        if (cache_->lookup(key, static_cast<uint32_t>(rng_()), chosen)) return !chosen.empty();
     }
 
-    return valid;
+    const auto& possible = legalMoves(levelRank);
+    if (possible.empty()) return false;
+
+    // 每手候选只分析一次，打分规则与批量决策（MoveBatcher）相同：
+    // 首出随机挑一手非炸弹；跟牌挑能压过上家的最小一手，同档次少用万能牌，再相同时随机。
+    // 特征列与分数缓冲区按线程复用，上家的牌也不经 HandMatcher，整个决策不再分配内存
+    thread_local MoveColumns columns;
+    thread_local std::vector<int64_t> scores;
+    columns.clear();
+    describePlays(possible, 0, levelRank, columns);
+    scores.resize(possible.size());
+    scoreMoves(columns, 0, possible.size(), base, baseCards, scores.data());
+    if (useCache) cache_->insert(key, possible, scores.data());
+
+    size_t best = pickBestMove(scores.data(), possible.size());
+    if (best >= possible.size()) return false;
+    if (search) best = searchBestMove(possible, scores.data(), best, baseCards == 0, levelRank, deadline);
+    chosen = possible[best];
+    return true;
 }
 
-std::vector<Card> AIPlayer::decideToMove(const std::vector<Card>& lastCards, int levelRank) {
-    auto possible = generatePossiblePlays(levelRank);
-    if (possible.empty()) return {};
-
-    std::shuffle(possible.begin(), possible.end(), rng_);
-
-    if (lastCards.empty()) {
-        std::vector<int> nonbomb_idxs;
-        for (int i = 0; i < (int)possible.size(); ++i) {
-            if (evaluateHandType(possible[i], levelRank) != HandType::Bomb) nonbomb_idxs.push_back(i);
+size_t AIPlayer::searchBestMove(const std::vector<Play>& possible, const int64_t* scores, size_t best, bool leading,
+                                int levelRank, std::chrono::steady_clock::time_point deadline) {
+    ++thinkStats_.searches;
+    // 只在与启发式选择同档次的候选里搜：首出时同为非炸弹（或同为炸弹），跟牌时牌型档次相同，
+    // 分数余下的位只是主值、张数与随机次序，搜索按“出完剩余手牌还要几手”重新排序，同手数时保持启发式次序
+    const int classShift = leading ? 40 : 48;
+    thread_local std::vector<size_t> order;
+    order.clear();
+    for (size_t i = 0; i < possible.size(); ++i) {
+        if (scores[i] != kRejectedMove && (scores[i] >> classShift) == (scores[best] >> classShift)) order.push_back(i);
+    }
+    const size_t width = std::min(order.size(), kSearchWidth);
+    std::partial_sort(order.begin(), order.begin() + width, order.end(),
+                      [scores](size_t a, size_t b) { return scores[a] < scores[b]; });
+
+    // 时间到时返回目前最好的一手；一手都没估完就是启发式结果
+    thread_local Remainder rest;
+    rest.start(handCards, moveIndex_);
+    size_t chosen = best;
+    int chosenHands = INT_MAX;
+    for (size_t k = 0; k < width; ++k) {
+        rest.remove(possible[order[k]]);
+        const int hands = handsToFinish(rest, levelRank, deadline);
+        rest.restore(handCards);
+        if (hands < 0) {
+            ++thinkStats_.timeouts;
+            break;
         }
-        if (!nonbomb_idxs.empty()) {
-            std::uniform_int_distribution<int> dist(0, (int)nonbomb_idxs.size()-1);
-            return possible[nonbomb_idxs[dist(rng_)]];
+        ++thinkStats_.evaluated;
+        if (hands < chosenHands) {
+            chosenHands = hands;
+            chosen = order[k];
         }
-        std::uniform_int_distribution<int> dist(0, (int)possible.size()-1);
-        return possible[dist(rng_)];
-    }
-
-    std::vector<std::vector<Card>> beating;
-    for (auto &cand : possible) {
-        if (canBeat(cand, lastCards, levelRank)) beating.push_back(cand);
     }
-    if (beating.empty()) return {};
-
-    auto rankForType = [](HandType t)->int {
-        switch (t) {
-        case HandType::Single: return 1;
-        case HandType::Pair:   return 2;
-        case HandType::Trips: return 3;
-        case HandType::Bomb:   return 4;
-        case HandType::StraightFlush: return 5;
-        case HandType::TianWang: return 6;
-        default: return 0;
-        }
-    };
-
-    std::sort(beating.begin(), beating.end(), [&](const std::vector<Card>& a, const std::vector<Card>& b){
-        HandType ta = evaluateHandType(a, levelRank);
-        HandType tb = evaluateHandType(b, levelRank);
-        int rta = rankForType(ta);
-        int rtb = rankForType(tb);
-        if (rta != rtb) return rta < rtb;
-        int ra = primaryRank(a, levelRank);
-        int rb = primaryRank(b, levelRank);
-        if (ra != rb) return ra < rb;
-        if (a.size() != b.size()) return a.size() < b.size();
-        std::string sa, sb;
-        for (auto &c : a) sa += c.toString() + "|";
-        for (auto &c : b) sb += c.toString() + "|";
-        return sa < sb;
-    });
-
-    return beating.front();
+    if (chosen != best) ++thinkStats_.improved;
+    return chosen;
 }
 
 void AIPlayer::aiPlay(const std::vector<Card>& lastPlay, int levelRank) {
@@ -2,12 +2,18 @@
 #define AIPLAYER_H
 
 #include <QObject>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <vector>
 #include <random>
 #include "player.h"
 #include "card.h"
+#include "decisionCache.h"
 #include "handmatcher.h"
 
+struct MoveColumns;
+
 class AIPlayer : public QObject, public Player {
     Q_OBJECT
 public:
@@ -17,11 +23,42 @@ public:
     // 方法1：判断牌型（使用 HandMatcher）
     HandType evaluateHandType(const std::vector<Card>& cards, int levelRank) const;
 
-    // 方法2：生成当前手牌的所有可能出牌（仅保留 HandMatcher 认定的合法牌型）
+    // 方法2：生成当前手牌的所有可能出牌（仅保留 HandMatcher 认定的合法牌型；即 legalMoves 的副本）
     std::vector<std::vector<Card>> generatePossiblePlays(int levelRank) const;
 
     // 方法3：根据上家牌选择出牌（空表示过）
     std::vector<Card> decideToMove(const std::vector<Card>& lastCards, int levelRank);
+    // 同上，选中的牌写进 chosen，返回 false 表示过；思考时限为 0 时稳定后整个决策不分配内存
+    bool decideToMove(const std::vector<Card>& lastCards, int levelRank, Play& chosen);
+    // 随时可停的决策：先按启发式打分选出一手，再在 deadline 之前搜索同档次的候选
+    // （估计出完剩余手牌还要几手），到时返回目前最好的一手；deadline 已过时就是启发式结果
+    bool decideToMove(const std::vector<Card>& lastCards, int levelRank, Play& chosen,
+                      std::chrono::steady_clock::time_point deadline);
+
+    // 每步决策的计算时限，不含 thinkDelayMs_ 的模拟延迟；0（默认）表示只用启发式，不搜索
+    void setThinkBudget(std::chrono::microseconds budget) { thinkBudget_ = budget; }
+    std::chrono::microseconds thinkBudget() const { return thinkBudget_; }
+
+    // 别人的回合里预想下一手：对 lastCards（空为首出）这个局面在 deadline 前做完一次带搜索的决策并记下，
+    // 之后真轮到自己、手牌与局面都对得上时 decideToMove 直接取用；返回这个局面是否已经想好。
+    // 没在时限内搜完的不记；自己出过一次牌（手牌变了）后预想的结果全部作废
+    bool ponder(const std::vector<Card>& lastCards, int levelRank, std::chrono::steady_clock::time_point deadline);
+
+    struct ThinkStats {
+        uint64_t searches = 0;  // 进入搜索的决策
+        uint64_t timeouts = 0;  // 到截止时刻还没搜完的决策
+        uint64_t evaluated = 0; // 搜索估计完的候选
+        uint64_t improved = 0;  // 搜索换掉了启发式选择的决策
+        uint64_t pondered = 0;  // 预想完的局面
+        uint64_t ponderHits = 0; // 直接取用预想结果的决策
+    };
+    const ThinkStats& thinkStats() const { return thinkStats_; }
+
+    // 可选的共享决策缓存（不归本 AI 所有）；nullptr 表示每次都完整决策
+    void setDecisionCache(DecisionCache* cache) { cache_ = cache; }
+
+    // 把 plays[from..] 逐手分析一次写进特征列（含本 AI 的随机次序），供 scoreMoves 打分
+    void describePlays(const std::vector<Play>& plays, size_t from, int levelRank, MoveColumns& out) const;
 
 public slots:
     void aiPlay(const std::vector<Card>& lastPlay, int levelRank);
@@ -38,8 +75,27 @@ private:
     // 辅助：判断 candidate 能否压制 base（上家）
     bool canBeat(const std::vector<Card>& candidate, const std::vector<Card>& base, int levelRank) const;
 
-    // 用于随机选择
-    mutable std::mt19937 rng_;
+    // decideToMove 去掉预想结果之后的部分：启发式打分，deadline 未到时再搜索
+    bool decide(const PlayInfo& base, int baseCards, int levelRank, Play& chosen,
+                std::chrono::steady_clock::time_point deadline);
+    // 启发式选出 best 后，在 deadline 前搜索与它同档次的候选，返回最终选中的下标
+    size_t searchBestMove(const std::vector<Play>& possible, const int64_t* scores, size_t best, bool leading,
+                          int levelRank, std::chrono::steady_clock::time_point deadline);
+
+    // 用于随机选择：只在候选里挑一个，线性同余足够，状态只有一个字（服务器上每桌四个 AI）
+    mutable std::minstd_rand rng_;
+    DecisionCache* cache_ = nullptr;
+    std::chrono::microseconds thinkBudget_{0};
+    ThinkStats thinkStats_;
+
+    struct PonderedMove {
+        DecisionCache::Key key;
+        Play chosen; // 空表示过
+    };
+    static constexpr size_t kPonderSlots = 4;
+    std::array<PonderedMove, kPonderSlots> pondered_;
+    size_t ponderCount_ = 0; // pondered_ 前几项有效
+    size_t ponderNext_ = 0;  // 下一次写入的位置（轮转）
     int thinkDelayMs_ = 300; // 模拟思考延迟（毫秒），可调整或设为 0
 };
 
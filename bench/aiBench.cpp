@@ -0,0 +1,503 @@
+// aiBench.cpp
+// AI 决策吞吐基准：随机发牌构造一批“轮到 AI 出牌”的局面（约三分之一首出，其余跟随机一手上家牌），
+// 先逐个同步调用 AIPlayer::decideToMove，再用 MoveBatcher 按不同批大小整批决策，
+// 对比每秒决策数、每次决策的全局堆分配次数以及每批处理耗时（即批内请求除排队外还要多等的时间）；
+// 再把全部候选分别用 HandMatcher 逐手识别和 HandBatch 批量识别，对比每手耗时；
+// 再把每手牌随机出到底，对比每次出牌后合法出牌索引增量刷新与整手重建的耗时；
+// 最后让四个 AI 自己对打若干局，对比不用与共用决策缓存时的每秒决策数和命中率，
+// 以及不同思考时限下每步决策耗时的分布（时限只约束搜索，启发式结果总是先就位），
+// 和别的座位出牌前先让其余 AI 预想（pondering）时，真轮到时的决策耗时与命中率；
+// 末尾量对手手牌采样（HandSampler）在开局与打了几轮之后的建表耗时和每秒采样数，
+// 并在一个小局面上把每家每张牌的采样频率与穷举所有一致发法得到的精确值对比，检查是否均匀。
+//
+// 用法：aiBench [--scenarios N] [--seed S]
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "AIPlayer.h"
+#include "benchStats.h"
+#include "deck.h"
+#include "decisionArena.h"
+#include "decisionCache.h"
+#include "handBatch.h"
+#include "handSampler.h"
+#include "moveBatcher.h"
+
+// 全局堆分配计数：替换 operator new，统计各段的分配次数
+static std::atomic<uint64_t> gAllocations{0};
+
+void* operator new(size_t bytes) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Scenario {
+    AIPlayer* ai;
+    std::vector<Card> lastCards;
+    int levelRank;
+};
+
+double secondsSince(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+uint64_t allocations() {
+    return gAllocations.load(std::memory_order_relaxed);
+}
+
+struct SelfPlay {
+    uint64_t decisions = 0;
+    double seconds = 0;
+    std::vector<double> decisionUs;
+    AIPlayer::ThinkStats think;
+};
+
+// 四个 AI 按座位轮流出牌，其余三家都过后由最后出牌的人首出，有人出完即结束一局
+// ponder 大于 0 时，每个座位决策前其余座位先各自预想（同 Judge::ponderOthers），只计真正决策的耗时
+SelfPlay selfPlay(unsigned seed, int games, DecisionCache* cache,
+                  std::chrono::microseconds budget = std::chrono::microseconds(0),
+                  std::chrono::microseconds ponder = std::chrono::microseconds(0)) {
+    std::mt19937 rng(seed);
+    Deck deck;
+    deck.seed(seed);
+    std::vector<std::unique_ptr<AIPlayer>> seats;
+    for (int i = 0; i < 4; ++i) {
+        seats.push_back(std::make_unique<AIPlayer>(i, "bench"));
+        seats.back()->setDecisionCache(cache);
+        seats.back()->setThinkBudget(budget);
+    }
+    SelfPlay result;
+    Play chosen;
+    std::vector<Card> last;
+    const std::vector<Card> lead;
+    const auto begin = Clock::now();
+    for (int g = 0; g < games; ++g) {
+        const int levelRank = 2 + static_cast<int>(rng() % 13);
+        deck.buildDeck();
+        deck.shuffleDeck();
+        auto hands = deck.dealRoundRobin(4);
+        for (int i = 0; i < 4; ++i) seats[i]->setHand(hands[i]);
+        last.clear();
+        int seat = 0, lastSeat = 0;
+        for (;;) {
+            if (seat == lastSeat) last.clear();
+            AIPlayer& ai = *seats[seat];
+            if (ponder.count() > 0) {
+                const auto deadline = Clock::now() + ponder;
+                for (int other = 0; other < 4; ++other) {
+                    if (other == seat || seats[other]->getCardCount() == 0) continue;
+                    seats[other]->ponder(other == lastSeat ? lead : last, levelRank, deadline);
+                    seats[other]->ponder(lead, levelRank, deadline);
+                }
+            }
+            ++result.decisions;
+            const auto decisionBegin = Clock::now();
+            const bool played = ai.decideToMove(last, levelRank, chosen);
+            result.decisionUs.push_back(secondsSince(decisionBegin) * 1e6);
+            if (played) {
+                last.assign(chosen.begin(), chosen.end());
+                ai.playCards(last);
+                lastSeat = seat;
+                if (ai.getCardCount() == 0) break;
+            } else if (last.empty()) {
+                break; // 首出却没有牌可出，不会发生
+            }
+            seat = (seat + 1) % 4;
+        }
+    }
+    result.seconds = secondsSince(begin);
+    for (const auto& seat : seats) {
+        const AIPlayer::ThinkStats& s = seat->thinkStats();
+        result.think.searches += s.searches;
+        result.think.timeouts += s.timeouts;
+        result.think.evaluated += s.evaluated;
+        result.think.improved += s.improved;
+        result.think.pondered += s.pondered;
+        result.think.ponderHits += s.ponderHits;
+    }
+    return result;
+}
+
+struct Uniformity {
+    int unseen = 0;
+    double exactDeals = 0;
+    double samplerDeals = 0;
+    double maxZ = 0;
+    int marginals = 0;
+};
+
+// 采样均匀性：只留 10 张看不到的牌（座位 1 再加一张亮出的进贡牌，座位 2 限制某个点数的张数），
+// 穷举 3^10 种分法得到每家每张牌张数的精确期望与方差，与 samples 次采样的平均值比较，返回最大偏差的 z 值
+Uniformity samplerUniformity(std::mt19937& rng, Deck& deck, int samples) {
+    const int levelRank = 2 + static_cast<int>(rng() % 13);
+    const LevelOrder& order = levelOrder(levelRank);
+    const auto valueOf = [&order](const Card& c) { return order.isWild(c) ? HandSampler::kWildValue : order.logOf(c); };
+    deck.buildDeck();
+    deck.shuffleDeck();
+    auto hands = deck.dealRoundRobin(4);
+
+    const std::array<int, 4> keep = {0, 4, 4, 3};
+    std::vector<Card> played;
+    for (int s = 1; s < 4; ++s) played.insert(played.end(), hands[s].begin() + keep[s], hands[s].end());
+    const Card tribute = hands[1][0];
+    const int limitedValue = valueOf(hands[3][0]);
+    int limit = 0;
+    for (int i = 0; i < keep[2]; ++i) limit += valueOf(hands[2][i]) == limitedValue;
+
+    HandSampler sampler;
+    sampler.reset(0, hands[0], levelRank);
+    sampler.cardsPlayed(played);
+    for (int s = 1; s < 4; ++s) sampler.setHandCount(s, keep[s]);
+    sampler.cardKnown(1, tribute);
+    sampler.limitValue(2, limitedValue, limit);
+    Uniformity result;
+    if (!sampler.prepare()) return result;
+    result.samplerDeals = sampler.consistentDeals();
+
+    // 看不到的实物牌（进贡牌已知在座位 1），逐张枚举归属
+    std::vector<Card> unseen(hands[1].begin() + 1, hands[1].begin() + keep[1]);
+    for (int s = 2; s < 4; ++s) unseen.insert(unseen.end(), hands[s].begin(), hands[s].begin() + keep[s]);
+    result.unseen = static_cast<int>(unseen.size());
+    std::array<std::array<double, Card::kIdCount>, 4> mean{}, square{};
+    int combos = 1;
+    for (size_t i = 0; i < unseen.size(); ++i) combos *= 3;
+    for (int code = 0; code < combos; ++code) {
+        std::array<std::array<int, Card::kIdCount>, 4> held{};
+        std::array<int, 4> count{};
+        held[1][tribute.toId()] = 1;
+        count[1] = 1;
+        int limited = 0;
+        for (int i = 0, rest = code; i < static_cast<int>(unseen.size()); ++i, rest /= 3) {
+            const int seat = 1 + rest % 3;
+            ++held[seat][unseen[i].toId()];
+            ++count[seat];
+            limited += seat == 2 && valueOf(unseen[i]) == limitedValue;
+        }
+        if (count[1] != keep[1] || count[2] != keep[2] || count[3] != keep[3] || limited > limit) continue;
+        result.exactDeals += 1;
+        for (int s = 1; s < 4; ++s) {
+            for (int id = 0; id < Card::kIdCount; ++id) {
+                mean[s][id] += held[s][id];
+                square[s][id] += held[s][id] * held[s][id];
+            }
+        }
+    }
+
+    std::array<std::array<double, Card::kIdCount>, 4> sampled{};
+    std::mt19937_64 sampleRng(rng());
+    HandSampler::Deal deal;
+    for (int i = 0; i < samples; ++i) {
+        sampler.sample(sampleRng, deal);
+        for (int s = 1; s < 4; ++s) {
+            for (const Card& c : deal.hand(s)) sampled[s][c.toId()] += 1;
+        }
+    }
+    for (int s = 1; s < 4; ++s) {
+        for (int id = 0; id < Card::kIdCount; ++id) {
+            const double expected = mean[s][id] / result.exactDeals;
+            const double variance = square[s][id] / result.exactDeals - expected * expected;
+            const double observed = sampled[s][id] / samples;
+            if (variance <= 1e-12) {
+                // 必然（或必不）在这家：采样必须一模一样
+                if (std::abs(observed - expected) > 1e-12) result.maxZ = 1e9;
+                continue;
+            }
+            ++result.marginals;
+            result.maxZ = std::max(result.maxZ, std::abs(observed - expected) / std::sqrt(variance / samples));
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("aiBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Inline vs batched AI decision throughput");
+    parser.addHelpOption();
+    QCommandLineOption scenariosOpt("scenarios", "Number of decision positions.", "N", "2000");
+    QCommandLineOption seedOpt("seed", "Deal seed.", "S", "2024");
+    parser.addOption(scenariosOpt);
+    parser.addOption(seedOpt);
+    parser.process(app);
+
+    const int count = std::max(1, parser.value(scenariosOpt).toInt());
+    const unsigned seed = parser.value(seedOpt).toUInt();
+
+    qInstallMessageHandler([](QtMsgType, const QMessageLogContext&, const QString&) {});
+
+    // 每个局面一个独立的 AI（相当于一张牌桌上轮到的那个座位），上家牌取自另一手随机牌的候选
+    std::mt19937 rng(seed);
+    Deck deck;
+    deck.seed(seed);
+    std::vector<std::unique_ptr<AIPlayer>> bots;
+    std::vector<Scenario> scenarios;
+    for (int i = 0; i < count; ++i) {
+        const int levelRank = 2 + static_cast<int>(rng() % 13);
+        deck.buildDeck();
+        deck.shuffleDeck();
+        auto hands = deck.dealRoundRobin(4);
+        bots.push_back(std::make_unique<AIPlayer>(0, "bench"));
+        bots.back()->setHand(hands[0]);
+        Scenario scenario{bots.back().get(), {}, levelRank};
+        if (rng() % 3 != 0) {
+            AIPlayer other(1, "bench");
+            other.setHand(hands[1]);
+            auto plays = other.generatePossiblePlays(levelRank);
+            if (!plays.empty()) scenario.lastCards = plays[rng() % plays.size()];
+        }
+        scenarios.push_back(std::move(scenario));
+    }
+
+    std::printf("aiBench: %d positions\n", count);
+    std::printf("%-14s %14s %12s %12s\n", "mode", "decisions/s", "passes", "allocs/dec");
+
+    // 1. 逐个同步决策：第一遍顺带建好各手牌的合法出牌索引，第二遍是索引就绪后的稳定状态
+    Play chosen;
+    for (const char* name : {"inline cold", "inline"}) {
+        int passes = 0;
+        const uint64_t allocBegin = allocations();
+        const auto begin = Clock::now();
+        for (const Scenario& s : scenarios) {
+            if (!s.ai->decideToMove(s.lastCards, s.levelRank, chosen)) ++passes;
+        }
+        const double seconds = secondsSince(begin);
+        std::printf("%-14s %14.0f %12d %12.2f\n", name, count / seconds, passes,
+                    static_cast<double>(allocations() - allocBegin) / count);
+    }
+
+    // 2. 按批决策：每凑满 batch 个请求处理一次
+    std::vector<double> flushUs;
+    for (size_t batch : {size_t{1}, size_t{8}, size_t{64}, size_t{256}}) {
+        MoveBatcher batcher(batch);
+        int passes = 0;
+        std::vector<double> perBatch;
+        const uint64_t allocBegin = allocations();
+        const auto begin = Clock::now();
+        for (const Scenario& s : scenarios) {
+            const bool full = batcher.submit(0, s.ai, s.lastCards, s.levelRank, [&passes](std::vector<Card> chosen) {
+                if (chosen.empty()) ++passes;
+            });
+            if (full) {
+                const auto flushBegin = Clock::now();
+                batcher.flush();
+                perBatch.push_back(secondsSince(flushBegin) * 1e6);
+            }
+        }
+        batcher.flush();
+        const double seconds = secondsSince(begin);
+        char name[32];
+        std::snprintf(name, sizeof(name), "batch %zu", batch);
+        std::printf("%-14s %14.0f %12d %12.2f\n", name, count / seconds, passes,
+                    static_cast<double>(allocations() - allocBegin) / count);
+        if (batch == 64) flushUs = std::move(perBatch);
+    }
+
+    std::printf("\n");
+    printSummaryHeader("us per flush, batch 64");
+    printSummaryRow("flush", summarizeSamples(flushUs));
+
+    // 3. 牌型识别：每个局面的全部候选，逐手 HandMatcher 与 HandBatch 整批识别（同 describePlays）
+    std::vector<std::vector<std::vector<Card>>> candidates;
+    size_t hands = 0;
+    for (const Scenario& s : scenarios) {
+        candidates.push_back(s.ai->generatePossiblePlays(s.levelRank));
+        hands += candidates.back().size();
+    }
+    int64_t matcherSum = 0;
+    const auto matcherBegin = Clock::now();
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        for (const auto& play : candidates[i]) {
+            matcherSum += static_cast<int>(HandMatcher(play, scenarios[i].levelRank).analyze().type);
+        }
+    }
+    const double matcherNs = secondsSince(matcherBegin) * 1e9 / static_cast<double>(hands);
+
+    HandBatch batch;
+    int64_t batchSum = 0;
+    double classifySeconds = 0;
+    const auto batchBegin = Clock::now();
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        batch.clear();
+        for (const auto& play : candidates[i]) batch.push(play, scenarios[i].levelRank);
+        const auto classifyBegin = Clock::now();
+        batch.classify();
+        classifySeconds += secondsSince(classifyBegin);
+        for (size_t j = 0; j < batch.count(); ++j) batchSum += batch.types()[j];
+    }
+    const double batchNs = secondsSince(batchBegin) * 1e9 / static_cast<double>(hands);
+
+    std::printf("\nclassify %zu candidates (%s): HandMatcher %.0f ns/hand, HandBatch %.0f ns/hand (kernel %.0f)%s\n",
+                hands, HandBatch::implementation(), matcherNs, batchNs, classifySeconds * 1e9 / static_cast<double>(hands),
+                matcherSum == batchSum ? "" : "  MISMATCH");
+
+    // 4. 合法出牌索引：随机出到手牌为空，每出一手量一次增量刷新加首出决策，同一手牌另起一个 Player 量整手重建
+    std::vector<double> refreshUs, rebuildUs;
+    Player scratch(1, "bench");
+    uint64_t regeneratedBefore = 0, regeneratedAfter = 0, decisionAllocs = 0;
+    const std::vector<Card> lead;
+    for (const Scenario& s : scenarios) {
+        regeneratedBefore += s.ai->moveIndex().stats().regenerated;
+        while (s.ai->getCardCount() > 0) {
+            const auto& moves = s.ai->legalMoves(s.levelRank);
+            if (moves.empty()) break;
+            const Play& play = moves[rng() % moves.size()];
+            s.ai->playCards(std::vector<Card>(play.begin(), play.end()));
+            const uint64_t allocBegin = allocations();
+            auto begin = Clock::now();
+            s.ai->legalMoves(s.levelRank);
+            refreshUs.push_back(secondsSince(begin) * 1e6);
+            s.ai->decideToMove(lead, s.levelRank, chosen);
+            decisionAllocs += allocations() - allocBegin;
+
+            scratch.setHand(s.ai->getHandCopy());
+            begin = Clock::now();
+            scratch.legalMoves(s.levelRank);
+            rebuildUs.push_back(secondsSince(begin) * 1e6);
+        }
+        regeneratedAfter += s.ai->moveIndex().stats().regenerated;
+    }
+    const DecisionArena::Stats& arena = DecisionArena::threadStats();
+    std::printf("\nmove index: %zu updates, %.1f candidates regenerated per update (full rebuild %.1f), "
+                "%.2f allocs per refresh + decision, arena peak %zu KiB, overflows %llu\n",
+                refreshUs.size(), static_cast<double>(regeneratedAfter - regeneratedBefore) / static_cast<double>(refreshUs.size()),
+                static_cast<double>(scratch.moveIndex().stats().regenerated) / static_cast<double>(rebuildUs.size()),
+                static_cast<double>(decisionAllocs) / static_cast<double>(refreshUs.size()), arena.peakBytes / 1024,
+                static_cast<unsigned long long>(arena.overflows));
+    printSummaryHeader("us per hand update");
+    printSummaryRow("refresh", summarizeSamples(refreshUs));
+    printSummaryRow("rebuild", summarizeSamples(rebuildUs));
+
+    // 5. 决策缓存：同样的牌局各打一遍，一遍每次完整决策，一遍四个座位共用一个缓存
+    const int games = std::max(1, count / 10);
+    const SelfPlay plain = selfPlay(seed, games, nullptr);
+    DecisionCache cache(1 << 16);
+    const SelfPlay cached = selfPlay(seed, games, &cache);
+    const DecisionCache::Stats cacheStats = cache.stats();
+    std::printf("\nself-play %d games: no cache %.0f decisions/s, cache %.0f decisions/s, "
+                "hit rate %.1f%% (%llu lookups, %llu skipped, %llu evictions)\n",
+                games, static_cast<double>(plain.decisions) / plain.seconds,
+                static_cast<double>(cached.decisions) / cached.seconds, cacheStats.hitRate() * 100.0,
+                static_cast<unsigned long long>(cacheStats.lookups), static_cast<unsigned long long>(cacheStats.skipped),
+                static_cast<unsigned long long>(cacheStats.evictions));
+
+    // 6. 思考时限：同样的牌局按不同时限各打一遍，看每步耗时的尾部是否被时限压住
+    std::printf("\n%-14s %14s %10s %10s %12s\n", "think budget", "decisions/s", "timeouts", "improved", "evals/search");
+    std::vector<std::pair<std::string, SelfPlay>> budgets;
+    for (int us : {0, 50, 200, 1000}) {
+        SelfPlay run = selfPlay(seed, games, nullptr, std::chrono::microseconds(us));
+        std::printf("%-14s %14.0f %10llu %10llu %12.1f\n", (std::to_string(us) + " us").c_str(),
+                    static_cast<double>(run.decisions) / run.seconds, static_cast<unsigned long long>(run.think.timeouts),
+                    static_cast<unsigned long long>(run.think.improved),
+                    run.think.searches > 0 ? static_cast<double>(run.think.evaluated) / run.think.searches : 0.0);
+        budgets.emplace_back(std::to_string(us) + " us", std::move(run));
+    }
+    // 7. 预想：思考时限 1000 us，别的座位出牌前其余 AI 各自最多预想 5 ms
+    SelfPlay pondering = selfPlay(seed, games, nullptr, std::chrono::microseconds(1000), std::chrono::microseconds(5000));
+    std::printf("\npondering: %llu positions pondered, %.1f%% of decisions answered from pondering\n",
+                static_cast<unsigned long long>(pondering.think.pondered),
+                100.0 * static_cast<double>(pondering.think.ponderHits) / static_cast<double>(pondering.decisions));
+    budgets.emplace_back("1000 us+ponder", std::move(pondering));
+
+    printSummaryHeader("us per decision");
+    for (const auto& [name, run] : budgets) printSummaryRow(name.c_str(), summarizeSamples(run.decisionUs));
+
+    // 8. 对手手牌采样：座位 0 的视角，开局与各家随机出过 4 手后各量一次。约束取自真实牌局：
+    //    座位 1 有一张亮出的进贡牌，座位 2 的 A 不超过它实际的张数，保证一定有一致的发法
+    std::printf("\n%-14s %10s %12s %14s %12s\n", "sampler", "unseen", "prepare us", "samples/s", "violations");
+    for (int rounds : {0, 4}) {
+        const int levelRank = 2 + static_cast<int>(rng() % 13);
+        deck.buildDeck();
+        deck.shuffleDeck();
+        auto hands = deck.dealRoundRobin(4);
+        std::vector<std::unique_ptr<AIPlayer>> seats;
+        for (int i = 0; i < 4; ++i) {
+            seats.push_back(std::make_unique<AIPlayer>(i, "bench"));
+            seats.back()->setHand(hands[i]);
+        }
+        std::vector<Card> played;
+        for (int r = 0; r < rounds; ++r) {
+            for (auto& seat : seats) {
+                const auto& moves = seat->legalMoves(levelRank);
+                if (moves.empty()) continue; // 这家已经出完
+                const Play& play = moves[rng() % moves.size()];
+                const std::vector<Card> cards(play.begin(), play.end());
+                played.insert(played.end(), cards.begin(), cards.end());
+                seat->playCards(cards);
+            }
+        }
+        // 随机出牌可能让座位 1 出完，这时没有亮出的进贡牌
+        const bool hasTribute = seats[1]->getCardCount() > 0;
+        const Card tribute = hasTribute ? seats[1]->getHand().front() : Card();
+        int aces = 0;
+        for (const Card& c : seats[2]->getHand()) aces += levelOrder(levelRank).logOf(c) == 14 && !levelOrder(levelRank).isWild(c);
+
+        HandSampler sampler;
+        const auto prepareBegin = Clock::now();
+        sampler.reset(0, seats[0]->getHand(), levelRank);
+        sampler.cardsPlayed(played);
+        for (int i = 1; i < 4; ++i) sampler.setHandCount(i, static_cast<int>(seats[i]->getCardCount()));
+        if (hasTribute) sampler.cardKnown(1, tribute);
+        sampler.limitValue(2, 14, aces);
+        const bool ok = sampler.prepare();
+        const double prepareUs = secondsSince(prepareBegin) * 1e6;
+        if (!ok) {
+            std::printf("%-14s prepare failed\n", rounds == 0 ? "deal" : "mid-hand");
+            continue;
+        }
+
+        std::mt19937_64 sampleRng(seed);
+        HandSampler::Deal deal;
+        const int samples = 200000;
+        const auto sampleBegin = Clock::now();
+        for (int i = 0; i < samples; ++i) sampler.sample(sampleRng, deal);
+        const double sampleSeconds = secondsSince(sampleBegin);
+
+        // 逐个核对张数、进贡牌和 A 的上限
+        int violations = 0;
+        for (int i = 0; i < 10000; ++i) {
+            sampler.sample(sampleRng, deal);
+            int sampledAces = 0;
+            for (const Card& c : deal.hand(2)) sampledAces += levelOrder(levelRank).logOf(c) == 14 && !levelOrder(levelRank).isWild(c);
+            const auto seat1 = deal.hand(1);
+            bool bad = sampledAces > aces || (hasTribute && std::find(seat1.begin(), seat1.end(), tribute) == seat1.end());
+            for (int s = 0; s < 4; ++s) bad = bad || deal.count[s] != seats[s]->getCardCount();
+            violations += bad;
+        }
+        std::printf("%-14s %10d %12.1f %14.0f %12d\n", rounds == 0 ? "deal" : "mid-hand",
+                    static_cast<int>(108 - seats[0]->getCardCount() - played.size()), prepareUs,
+                    samples / sampleSeconds, violations);
+    }
+
+    // 9. 采样均匀性：小局面上与穷举的精确边缘分布对比，z 值超过 5 视为不均匀
+    const int uniformSamples = 400000;
+    const Uniformity uniform = samplerUniformity(rng, deck, uniformSamples);
+    const bool uniformOk = uniform.exactDeals > 0 && uniform.exactDeals == uniform.samplerDeals && uniform.maxZ < 5.0;
+    std::printf("\nsampler uniformity: %d unseen, %.0f consistent deals (sampler counts %.0f), "
+                "%d marginals over %d samples, max |z| %.2f %s\n",
+                uniform.unseen, uniform.exactDeals, uniform.samplerDeals, uniform.marginals, uniformSamples,
+                uniform.maxZ, uniformOk ? "OK" : "NONUNIFORM");
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// 基准测试用的简单分布统计（单位由调用者决定，通常为微秒）
+struct SampleSummary {
+    size_t count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+};
+
+inline SampleSummary summarizeSamples(std::vector<double> samples) {
+    SampleSummary s;
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double q) {
+        size_t idx = static_cast<size_t>(q * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[std::min(idx, samples.size() - 1)];
+    };
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    s.count = samples.size();
+    s.mean = sum / static_cast<double>(samples.size());
+    s.p50 = pct(0.50);
+    s.p90 = pct(0.90);
+    s.p99 = pct(0.99);
+    s.p999 = pct(0.999);
+    s.max = samples.back();
+    return s;
+}
+
+inline void printSummaryHeader(const char* unit) {
+    std::printf("%-22s %8s %10s %10s %10s %10s %10s %10s   (%s)\n",
+                "metric", "count", "mean", "p50", "p90", "p99", "p999", "max", unit);
+}
+
+inline void printSummaryRow(const char* name, const SampleSummary& s) {
+    std::printf("%-22s %8zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                name, s.count, s.mean, s.p50, s.p90, s.p99, s.p999, s.max);
+}
+
+#endif // BENCHSTATS_H
@@ -0,0 +1,407 @@
+// loadGen.cpp
+// 多牌桌服务器压测：在本机起成千上万个模拟客户端，每个客户端在本地用 AIPlayer 决策，
+// 通过二进制协议入座、出牌、进贡还贡，打完整的多局比赛（含升级），
+// 统计出牌吞吐以及“发出动作 -> 收到反映该动作的 Delta”的确认延迟分布。
+//
+// 用法：loadGen [--clients N] [--threads T] [--duration S] [--port P | --unix PATH] [--first-table K]
+// 服务器需要至少 first-table + clients/4 张牌桌，例如：tableServer --tables 2500 --delay-scale 0
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "benchStats.h"
+#include "AIPlayer.h"
+#include "judge.h"
+#include "server/protocol.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Endpoint {
+    uint16_t port = 0;
+    std::string unixPath;
+};
+
+struct SimClient {
+    int fd = -1;
+    int table = 0;
+    int seat = 0;
+    std::string in;
+    std::string out;
+    bool watchingOut = false; // epoll 里是否登记了 EPOLLOUT（只在 out 非空时登记）
+    std::unique_ptr<AIPlayer> ai;
+
+    // 客户端视角的牌桌状态，全部由服务器帧重建
+    std::vector<Card> hand;
+    std::array<std::vector<Card>, 4> tablePlays;
+    int levelRank = 2;
+    bool snapshotPending = false; // 入座补发的 Delta 不代表新出牌
+
+    bool awaitingAck = false;
+    Clock::time_point sentAt;
+};
+
+struct WorkerStats {
+    std::vector<double> ackUs;
+    long long moves = 0;
+    long long rejected = 0;
+    long long tributes = 0;
+    long long timeouts = 0;
+    long long games = 0;
+    long long matches = 0;
+    int connectFailures = 0;
+};
+
+int connectEndpoint(const Endpoint& ep) {
+    int fd = -1;
+    if (!ep.unixPath.empty()) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, ep.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+    } else {
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(ep.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+void removeCards(std::vector<Card>& hand, const std::vector<Card>& played) {
+    for (const auto& c : played) {
+        auto it = std::find(hand.begin(), hand.end(), c);
+        if (it != hand.end()) hand.erase(it);
+    }
+}
+
+// 与 Judge 的 AI 相同的进贡/还贡选牌规则
+Card chooseTributeCard(const std::vector<Card>& hand, int level, bool isReturn) {
+    std::vector<Card> sorted = hand;
+    std::sort(sorted.begin(), sorted.end(), [level](const Card& a, const Card& b) {
+        return isCardSmaller(a, b, level);
+    });
+    if (isReturn) {
+        for (const auto& c : sorted) {
+            if (c.getRankInt() != level && c.getRank() != Rank::S && c.getRank() != Rank::B) return c;
+        }
+        return sorted.front();
+    }
+    for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
+        if (!(it->getSuit() == Suit::Hearts && it->getRankInt() == level)) return *it;
+    }
+    return sorted.back();
+}
+
+class LoadWorker {
+public:
+    LoadWorker(const Endpoint& ep, int firstClient, int clientCount, int firstTable)
+        : endpoint_(ep), firstClient_(firstClient), clientCount_(clientCount), firstTable_(firstTable) {}
+
+    void run(Clock::time_point deadline, const std::atomic<bool>& stop) {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        clients_.resize(static_cast<size_t>(clientCount_));
+        for (int i = 0; i < clientCount_; ++i) {
+            SimClient& c = clients_[i];
+            const int global = firstClient_ + i;
+            c.table = firstTable_ + global / 4;
+            c.seat = global % 4;
+            c.ai = std::make_unique<AIPlayer>(c.seat, "load");
+            c.fd = connectEndpoint(endpoint_);
+            if (c.fd < 0) {
+                ++stats.connectFailures;
+                continue;
+            }
+            proto::FrameWriter(c.out, proto::MsgType::Hello).u8(proto::kVersion);
+            proto::FrameWriter(c.out, proto::MsgType::Join).u32(static_cast<uint32_t>(c.table)).u8(c.seat);
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(epollFd_, EPOLL_CTL_ADD, c.fd, &ev);
+            flush(c);
+        }
+
+        epoll_event events[256];
+        while (!stop && Clock::now() < deadline) {
+            const int n = epoll_wait(epollFd_, events, 256, 100);
+            for (int i = 0; i < n; ++i) {
+                SimClient& c = clients_[events[i].data.u32];
+                if (c.fd < 0) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    disconnect(c);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) readFrom(c);
+                if (c.fd >= 0) flush(c);
+            }
+        }
+        for (auto& c : clients_) {
+            if (c.fd >= 0) ::close(c.fd);
+        }
+        ::close(epollFd_);
+    }
+
+    WorkerStats stats;
+
+private:
+    void disconnect(SimClient& c) {
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, c.fd, nullptr);
+        ::close(c.fd);
+        c.fd = -1;
+    }
+
+    void flush(SimClient& c) {
+        while (!c.out.empty()) {
+            const ssize_t n = ::send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                c.out.erase(0, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            disconnect(c);
+            return;
+        }
+        // 水平触发下一直登记 EPOLLOUT 会让 epoll_wait 立即返回、空转占满一个核：只在有积压时登记
+        const bool want = !c.out.empty();
+        if (want == c.watchingOut) return;
+        epoll_event ev{};
+        ev.events = want ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(&c - clients_.data());
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, c.fd, &ev);
+        c.watchingOut = want;
+    }
+
+    void readFrom(SimClient& c) {
+        char buf[8192];
+        for (;;) {
+            const ssize_t n = ::read(c.fd, buf, sizeof(buf));
+            if (n > 0) {
+                c.in.append(buf, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                disconnect(c);
+                return;
+            }
+            break;
+        }
+        size_t pos = 0;
+        proto::FrameView frame;
+        for (;;) {
+            const size_t used = proto::peekFrame(c.in.data() + pos, c.in.size() - pos, frame);
+            if (used == 0) break;
+            handleFrame(c, frame);
+            pos += used;
+        }
+        c.in.erase(0, pos);
+    }
+
+    void handleFrame(SimClient& c, const proto::FrameView& f) {
+        using proto::MsgType;
+        switch (f.type) {
+        case MsgType::Seat:
+            c.snapshotPending = true;
+            break;
+        case MsgType::Level:
+            if (f.size >= 1) c.levelRank = f.payload[0];
+            break;
+        case MsgType::Hand:
+            proto::readCards(f.payload, f.size, c.hand);
+            break;
+        case MsgType::Delta:
+            handleDelta(c, f);
+            break;
+        case MsgType::TributeAsk:
+            if (!c.hand.empty() && f.size >= 1) {
+                const Card card = chooseTributeCard(c.hand, c.levelRank, f.payload[0] != 0);
+                proto::FrameWriter(c.out, MsgType::Tribute).u8(card.toId());
+                ++stats.tributes;
+            }
+            break;
+        case MsgType::GameEnd:
+            if (c.seat == 0) ++stats.games;
+            break;
+        case MsgType::MatchEnd:
+            if (c.seat == 0) {
+                ++stats.games;
+                ++stats.matches;
+            }
+            break;
+        case MsgType::Timeout:
+            ++stats.timeouts;
+            break;
+        case MsgType::Error:
+            ++stats.rejected;
+            if (c.awaitingAck) {
+                c.awaitingAck = false;
+                // 与 Judge::playAICards 的容错一致：出牌被拒且桌上有牌时改为过
+                const bool invalidPlay = f.size >= 1 && f.payload[0] == static_cast<uint8_t>(proto::ErrorCode::InvalidPlay);
+                if (invalidPlay && !leadFor(c).empty()) sendMove(c, {});
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void handleDelta(SimClient& c, const proto::FrameView& f) {
+        if (f.size < 8) return;
+        const uint8_t* p = f.payload;
+        const int currentTurn = p[1];
+        const unsigned playSeats = p[7];
+        size_t pos = 8;
+        for (int seat = 0; seat < 4; ++seat) {
+            if (!(playSeats & (1u << seat))) continue;
+            if (pos + 3 > f.size) return;
+            const size_t n = p[pos + 2];
+            if (pos + 3 + n > f.size) return;
+            proto::readCards(p + pos + 3, n, c.tablePlays[seat]);
+            pos += 3 + n;
+
+            if (seat == c.seat && !c.snapshotPending) {
+                removeCards(c.hand, c.tablePlays[seat]);
+                if (c.awaitingAck) {
+                    c.awaitingAck = false;
+                    ++stats.moves;
+                    stats.ackUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - c.sentAt).count());
+                }
+            }
+        }
+        c.snapshotPending = false;
+
+        if (currentTurn == c.seat && !c.awaitingAck && !c.hand.empty()) {
+            c.ai->setHand(c.hand);
+            sendMove(c, c.ai->decideToMove(leadFor(c), c.levelRank));
+        }
+    }
+
+    // 桌面上需要压的牌：从自己往前数第一个有出牌的座位（过牌会清空该座位的桌面）
+    const std::vector<Card>& leadFor(const SimClient& c) const {
+        for (int step = 1; step < 4; ++step) {
+            const auto& play = c.tablePlays[(c.seat + 4 - step) % 4];
+            if (!play.empty()) return play;
+        }
+        return c.tablePlays[c.seat]; // 为空或轮回自己，视为首出
+    }
+
+    void sendMove(SimClient& c, const std::vector<Card>& cards) {
+        if (cards.empty()) proto::writeEmpty(c.out, proto::MsgType::Pass);
+        else proto::FrameWriter(c.out, proto::MsgType::Play).cards(cards);
+        c.awaitingAck = true;
+        c.sentAt = Clock::now();
+    }
+
+    Endpoint endpoint_;
+    int firstClient_;
+    int clientCount_;
+    int firstTable_;
+    int epollFd_ = -1;
+    std::vector<SimClient> clients_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("loadGen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic client load generator for tableServer");
+    parser.addHelpOption();
+    QCommandLineOption clientsOpt("clients", "Number of simulated clients (4 per table).", "N", "4000");
+    QCommandLineOption threadsOpt("threads", "Client worker threads.", "T", "4");
+    QCommandLineOption durationOpt("duration", "Run time in seconds.", "S", "30");
+    QCommandLineOption portOpt("port", "Server TCP port on 127.0.0.1.", "P", "47100");
+    QCommandLineOption unixOpt("unix", "Connect through this Unix domain socket instead of TCP.", "PATH");
+    QCommandLineOption firstTableOpt("first-table", "First table id to occupy.", "K", "0");
+    parser.addOption(clientsOpt);
+    parser.addOption(threadsOpt);
+    parser.addOption(durationOpt);
+    parser.addOption(portOpt);
+    parser.addOption(unixOpt);
+    parser.addOption(firstTableOpt);
+    parser.process(app);
+
+    // AI 决策日志会淹没测量结果，这里全部关闭
+    qInstallMessageHandler([](QtMsgType, const QMessageLogContext&, const QString&) {});
+
+    const int clients = std::max(4, parser.value(clientsOpt).toInt() / 4 * 4);
+    const int threads = std::clamp(parser.value(threadsOpt).toInt(), 1, clients / 4);
+    const double duration = std::max(1.0, parser.value(durationOpt).toDouble());
+    const int firstTable = std::max(0, parser.value(firstTableOpt).toInt());
+    Endpoint ep;
+    ep.port = static_cast<uint16_t>(parser.value(portOpt).toUInt());
+    if (parser.isSet(unixOpt)) ep.unixPath = parser.value(unixOpt).toStdString();
+
+    // 按整桌切分给各线程，同一桌的四个客户端在同一线程里
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    const int tables = clients / 4;
+    for (int t = 0; t < threads; ++t) {
+        const int beginTable = tables * t / threads;
+        const int endTable = tables * (t + 1) / threads;
+        workers.push_back(std::make_unique<LoadWorker>(ep, beginTable * 4, (endTable - beginTable) * 4, firstTable));
+    }
+
+    std::atomic<bool> stop{false};
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::milliseconds(static_cast<long long>(duration * 1000));
+    std::vector<std::thread> pool;
+    for (auto& w : workers) {
+        LoadWorker* worker = w.get();
+        pool.emplace_back([worker, deadline, &stop]() { worker->run(deadline, stop); });
+    }
+    for (auto& t : pool) t.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WorkerStats total;
+    for (auto& w : workers) {
+        auto& s = w->stats;
+        total.ackUs.insert(total.ackUs.end(), s.ackUs.begin(), s.ackUs.end());
+        total.moves += s.moves;
+        total.rejected += s.rejected;
+        total.tributes += s.tributes;
+        total.timeouts += s.timeouts;
+        total.games += s.games;
+        total.matches += s.matches;
+        total.connectFailures += s.connectFailures;
+    }
+
+    std::printf("loadGen: %d clients on %d tables, %d threads, %.1fs, %d connect failures\n",
+                clients, tables, threads, elapsed, total.connectFailures);
+    std::printf("moves acked %lld (%.0f/s), games %lld (%.1f/s), matches %lld, tributes %lld, rejected %lld, timeouts %lld\n",
+                total.moves, total.moves / elapsed, total.games, total.games / elapsed,
+                total.matches, total.tributes, total.rejected, total.timeouts);
+    printSummaryHeader("us");
+    printSummaryRow("move ack", summarizeSamples(total.ackUs));
+    return 0;
+}
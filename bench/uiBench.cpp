@@ -0,0 +1,177 @@
+// uiBench.cpp
+// 离屏渲染基准：在 offscreen 平台上运行 MainWindow，回放一局录制好的对局，
+// 统计每一步的引擎耗时、合并后的状态增量触发的 UI 刷新耗时、随后处理积压事件的耗时，
+// 以及其中每个 Paint 事件单独的绘制耗时分布。
+//
+// 用法：uiBench [--games N] [--seed S]
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <cstdio>
+#include <vector>
+#include "benchStats.h"
+#include "deck.h"
+#include "gameManager.h"
+#include "judge.h"
+#include "mainwindow.h"
+
+namespace {
+
+struct RecordedStep {
+    int seat;
+    std::vector<Card> cards; // 空表示过
+};
+
+struct RecordedGame {
+    std::vector<std::vector<Card>> hands;
+    std::vector<RecordedStep> steps;
+};
+
+// 在事件分发入口逐个计时 Paint 事件：notify 返回时该控件的 paintEvent 已经画完，
+// 这样绘制耗时不会混进同一批积压事件里的布局、UpdateRequest 等其它处理
+class PaintTimingApp : public QApplication {
+public:
+    using QApplication::QApplication;
+    int paints = 0;                // 当前这一步的 Paint 事件数量
+    std::vector<double> paintUs;   // 每个 Paint 事件的耗时
+    bool notify(QObject* receiver, QEvent* event) override {
+        if (event->type() != QEvent::Paint) return QApplication::notify(receiver, event);
+        QElapsedTimer timer;
+        timer.start();
+        const bool handled = QApplication::notify(receiver, event);
+        paintUs.push_back(timer.nsecsElapsed() / 1000.0);
+        ++paints;
+        return handled;
+    }
+};
+
+// 用四个 AI 无界面地打完一局，记录初始手牌与每一步出牌
+RecordedGame recordGame(unsigned seed) {
+    RecordedGame game;
+
+    Deck deck;
+    deck.seed(seed);
+    deck.buildDeck();
+    deck.shuffleDeck();
+    game.hands = deck.dealRoundRobin(4);
+
+    Judge judge;
+    std::vector<AIPlayer*> bots;
+    std::vector<Player*> players;
+    for (int i = 0; i < 4; ++i) {
+        bots.push_back(new AIPlayer(i, "bench", &judge));
+        bots.back()->setHand(game.hands[i]);
+        players.push_back(bots.back());
+    }
+    judge.setPlayers(players);
+    judge.resetForNewHand();
+    judge.setCurrentTurn(0); // 不进贡，直接开打
+
+    bool finished = false;
+    QObject::connect(&judge, &Judge::gameFinished, [&finished]() { finished = true; });
+    QObject::connect(&judge, &Judge::matchFinished, [&finished](int) { finished = true; });
+
+    // 不进入事件循环，Judge 内部为 AI 安排的定时器不会触发，由这里逐步驱动
+    const int level = judge.getCurrentLevelRank();
+    for (int guard = 0; !finished && guard < 4000; ++guard) {
+        int seat = judge.getCurrentTurn();
+        std::vector<Card> chosen = bots[seat]->decideToMove(judge.getLastCards(), level);
+        game.steps.push_back({seat, chosen});
+        judge.playAICards(seat, chosen);
+    }
+    return game;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    PaintTimingApp app(argc, argv);
+    QApplication::setApplicationName("uiBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offscreen MainWindow rendering benchmark");
+    parser.addHelpOption();
+    QCommandLineOption gamesOpt("games", "Number of recorded games to replay.", "N", "5");
+    QCommandLineOption seedOpt("seed", "Deck shuffle seed of the first game.", "S", "2024");
+    parser.addOption(gamesOpt);
+    parser.addOption(seedOpt);
+    parser.process(app);
+
+    const int games = std::max(1, parser.value(gamesOpt).toInt());
+    const unsigned seed = parser.value(seedOpt).toUInt();
+
+    // 引擎日志会淹没测量结果，这里全部关闭
+    qInstallMessageHandler([](QtMsgType, const QMessageLogContext&, const QString&) {});
+
+    MainWindow w;
+    w.resize(1280, 800);
+    w.show();
+    QCoreApplication::sendPostedEvents();
+
+    GameManager* gm = w.findChild<GameManager*>();
+    if (!gm) {
+        std::fprintf(stderr, "uiBench: MainWindow has no GameManager\n");
+        return 1;
+    }
+    Judge* judge = gm->getJudge();
+    std::vector<Player*> seats = {gm->getHumanPlayer(), gm->getAIPlayer(1), gm->getAIPlayer(2), gm->getAIPlayer(3)};
+
+    // 结算弹窗是模态的，离屏回放时断开
+    QObject::disconnect(judge, &Judge::gameFinished, &w, nullptr);
+    QObject::disconnect(judge, &Judge::matchFinished, &w, nullptr);
+
+    app.paintUs.clear(); // 只统计回放期间的绘制
+    std::vector<double> engineUs;
+    std::vector<double> updateUs;
+    std::vector<double> flushUs;
+    std::vector<double> paintsPerStep;
+    size_t totalSteps = 0;
+    QElapsedTimer clock;
+
+    for (int g = 0; g < games; ++g) {
+        RecordedGame game = recordGame(seed + static_cast<unsigned>(g));
+
+        for (int i = 0; i < 4; ++i) seats[i]->setHand(game.hands[i]);
+        judge->resetForNewHand();
+        judge->setCurrentTurn(0);
+        QCoreApplication::sendPostedEvents();
+
+        for (const auto& step : game.steps) {
+            if (judge->getCurrentTurn() != step.seat) {
+                std::fprintf(stderr, "uiBench: replay diverged at game %d\n", g);
+                break;
+            }
+
+            // 1. 引擎变更（UI 通知只是被合并记录下来）
+            clock.start();
+            judge->playAICards(step.seat, step.cards);
+            engineUs.push_back(clock.nsecsElapsed() / 1000.0);
+
+            // 2. 发出合并后的 stateChanged，MainWindow 按区域刷新模型与标签
+            clock.start();
+            judge->flushStateDelta();
+            updateUs.push_back(clock.nsecsElapsed() / 1000.0);
+
+            // 3. 处理积压的 UpdateRequest，即实际发生的绘制（只投递事件，不触发 Judge 的定时器）；
+            //    其中每个 Paint 事件的耗时由 PaintTimingApp 单独记录
+            app.paints = 0;
+            clock.start();
+            QCoreApplication::sendPostedEvents();
+            flushUs.push_back(clock.nsecsElapsed() / 1000.0);
+            paintsPerStep.push_back(app.paints);
+            ++totalSteps;
+        }
+    }
+
+    std::printf("uiBench: %d game(s), %zu replayed steps, window %dx%d, platform %s\n",
+                games, totalSteps, w.width(), w.height(), qPrintable(QApplication::platformName()));
+    printSummaryHeader("us; paint events per step for the last row");
+    printSummaryRow("engine", summarizeSamples(engineUs));
+    printSummaryRow("update (stateChanged)", summarizeSamples(updateUs));
+    printSummaryRow("flush (posted events)", summarizeSamples(flushUs));
+    printSummaryRow("paint (per event)", summarizeSamples(app.paintUs));
+    printSummaryRow("paint events/step", summarizeSamples(paintsPerStep));
+    return 0;
+}
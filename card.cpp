@@ -62,6 +62,13 @@ std::string Card::toString() const {
     return getSuitString() + getRankString();
 }
 
+Card Card::fromId(int id) noexcept {
+    if (id == 52) return Card(Rank::S, Suit::None);
+    if (id == 53) return Card(Rank::B, Suit::None);
+    if (id < 0 || id >= 52) return Card();
+    return Card(static_cast<Rank>(static_cast<int>(Rank::Three) + id % 13), static_cast<Suit>(id / 13));
+}
+
 bool Card::operator<(const Card& other) const noexcept {
     // 掼蛋/斗地主排序：先比点数，点数相同比花色
     if (getRankInt() != other.getRankInt())
@@ -31,6 +31,11 @@ public:
     int getRankInt() const noexcept;
     std::string toString() const;
 
+    // 紧凑编号：花色(0..3) * 13 + 点数序号(3..2 -> 0..12)，小王 52，大王 53
+    static constexpr int kIdCount = 54;
+    int toId() const noexcept;
+    static Card fromId(int id) noexcept;
+
     bool operator<(const Card& other) const noexcept;
     bool operator==(const Card& other) const noexcept;
 
@@ -39,4 +44,13 @@ private:
     Suit suit;
 };
 
+// 出牌分析里按牌查表（LevelOrder 等）的热点路径，放在头文件里内联
+inline int Card::toId() const noexcept {
+    if (rank == Rank::S) return 52;
+    if (rank == Rank::B) return 53;
+    int suitIdx = static_cast<int>(suit);
+    if (suitIdx < 0 || suitIdx > 3) suitIdx = 0;
+    return suitIdx * 13 + (static_cast<int>(rank) - static_cast<int>(Rank::Three));
+}
+
 #endif // CARD_H
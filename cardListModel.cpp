@@ -0,0 +1,130 @@
+#include "cardListModel.h"
+#include <algorithm>
+
+CardListModel::CardListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int CardListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return static_cast<int>(m_ids.size());
+}
+
+QVariant CardListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_ids.size())) return {};
+    const int row = index.row();
+    switch (role) {
+    case CardIdRole:
+        return m_ids[row];
+    case Qt::UserRole:
+        return static_cast<bool>(m_selected[row]);
+    default:
+        return {};
+    }
+}
+
+Qt::ItemFlags CardListModel::flags(const QModelIndex& index) const {
+    if (!index.isValid()) return Qt::NoItemFlags;
+    if (m_ids[index.row()] == kPassCardId) return Qt::NoItemFlags; // 不可选中
+    return Qt::ItemIsEnabled;
+}
+
+void CardListModel::setCards(const std::vector<Card>& cards) {
+    m_scratch.clear();
+    m_scratch.reserve(cards.size());
+    for (const auto& c : cards) m_scratch.push_back(c.toId());
+    applyIds(m_scratch);
+}
+
+void CardListModel::setPassMarker() {
+    m_scratch.assign(1, kPassCardId);
+    applyIds(m_scratch);
+}
+
+void CardListModel::clear() {
+    m_scratch.clear();
+    applyIds(m_scratch);
+}
+
+void CardListModel::applyIds(const std::vector<int>& ids) {
+    // 新旧列表按同一规则排序（手牌出牌只删、摸牌/进贡只插），按顺序合并即可得到实际的删除/插入位置。
+    // 两副牌时同一编号可能出现两次，所以用“剩余个数之差”判断某张牌是多出来的还是缺少的：
+    // surplus > 0 表示旧列表里还有多余的这张牌（应删除），< 0 表示新列表里多出来（应插入）。
+    m_surplus.assign(Card::kIdCount + 1, 0);
+    for (int id : m_ids) ++m_surplus[id];
+    for (int id : ids) --m_surplus[id];
+
+    const int newCount = static_cast<int>(ids.size());
+    int row = 0;
+    int j = 0;
+    while (row < static_cast<int>(m_ids.size()) || j < newCount) {
+        const int oldCount = static_cast<int>(m_ids.size());
+        if (row < oldCount && j < newCount && m_ids[row] == ids[j]) {
+            ++row;
+            ++j;
+            continue;
+        }
+
+        // 1. 旧列表中多余的连续若干张：一次 beginRemoveRows
+        int end = row;
+        while (end < oldCount && m_surplus[m_ids[end]] > 0 && (j == newCount || m_ids[end] != ids[j])) {
+            --m_surplus[m_ids[end]];
+            ++end;
+        }
+        if (end > row) {
+            beginRemoveRows(QModelIndex(), row, end - 1);
+            m_ids.erase(m_ids.begin() + row, m_ids.begin() + end);
+            m_selected.erase(m_selected.begin() + row, m_selected.begin() + end);
+            endRemoveRows();
+            continue;
+        }
+
+        // 2. 新列表中多出的连续若干张：在当前位置一次 beginInsertRows
+        end = j;
+        while (end < newCount && m_surplus[ids[end]] < 0 && (row == oldCount || ids[end] != m_ids[row])) {
+            ++m_surplus[ids[end]];
+            ++end;
+        }
+        if (end > j) {
+            beginInsertRows(QModelIndex(), row, row + (end - j) - 1);
+            m_ids.insert(m_ids.begin() + row, ids.begin() + j, ids.begin() + end);
+            m_selected.insert(m_selected.begin() + row, end - j, false);
+            endInsertRows();
+            row += end - j;
+            j = end;
+            continue;
+        }
+
+        // 3. 两边都有但顺序不同（例如级牌变化后重新排序）：原地替换，合并成一次 dataChanged
+        const int first = row;
+        while (row < oldCount && j < newCount && m_ids[row] != ids[j]
+               && m_surplus[m_ids[row]] <= 0 && m_surplus[ids[j]] >= 0) {
+            --m_surplus[m_ids[row]];
+            ++m_surplus[ids[j]];
+            m_ids[row] = ids[j];
+            ++row;
+            ++j;
+        }
+        emit dataChanged(index(first), index(row - 1), {CardIdRole});
+    }
+}
+
+void CardListModel::setSelected(int row, bool selected) {
+    if (row < 0 || row >= static_cast<int>(m_selected.size())) return;
+    if (m_selected[row] == selected) return;
+    m_selected[row] = selected;
+    const QModelIndex idx = index(row);
+    emit dataChanged(idx, idx, {Qt::UserRole});
+}
+
+bool CardListModel::isSelected(int row) const {
+    if (row < 0 || row >= static_cast<int>(m_selected.size())) return false;
+    return m_selected[row];
+}
+
+void CardListModel::clearSelection() {
+    for (int i = 0; i < static_cast<int>(m_selected.size()); ++i) {
+        setSelected(i, false);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CARDLISTMODEL_H
+#define CARDLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <vector>
+#include "card.h"
+
+// 列表项数据角色：Qt::UserRole 保存“是否选中”，CardIdRole 保存 Card::toId() 的紧凑编号
+enum CardItemRole {
+    CardIdRole = Qt::UserRole + 1
+};
+// 桌面上“不要”提示项使用的特殊编号
+constexpr int kPassCardId = Card::kIdCount;
+
+// 手牌/桌面出牌区共用的模型：只保存卡牌编号与选中状态。
+// 刷新时按顺序合并新旧编号，在实际位置发出行删除/插入，只有顺序变化的行发出 dataChanged，
+// 视图据此只重绘对应卡牌（出掉中间几张牌时，其后的牌只是上移，不会整手重绘）。
+class CardListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit CardListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    // 用引擎手牌刷新（保留下来的牌沿用原选中状态，新插入的牌未选中）
+    void setCards(const std::vector<Card>& cards);
+    // 显示“不要”
+    void setPassMarker();
+    void clear();
+
+    // 选中上浮：只通知该行的 Qt::UserRole 变化
+    void setSelected(int row, bool selected);
+    bool isSelected(int row) const;
+    void clearSelection();
+
+private:
+    void applyIds(const std::vector<int>& ids);
+
+    std::vector<int> m_ids;
+    std::vector<bool> m_selected;
+    std::vector<int> m_scratch;   // 复用的编号缓冲，避免每次刷新分配
+    std::vector<int> m_surplus;   // 合并时每个编号“旧列表剩余数 - 新列表剩余数”
+};
+
+#endif // CARDLISTMODEL_H
@@ -0,0 +1,31 @@
+#ifndef CARDSIGNATURE_H
+#define CARDSIGNATURE_H
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include "card.h"
+
+// 一组牌的张数签名：每个 Card::toId 占 2 位（两副牌同一张最多 2 张），与牌的次序无关，
+// 可以直接比较、排序和哈希。用于候选去重（MoveIndex）和按手牌查决策缓存（DecisionCache）。
+struct CardSignature {
+    uint64_t lo = 0; // id 0..31
+    uint64_t hi = 0; // id 32..53
+
+    void add(const Card& c) {
+        const int id = c.toId();
+        if (id < 32) lo += uint64_t{1} << (2 * id);
+        else hi += uint64_t{1} << (2 * (id - 32));
+    }
+
+    template <typename Cards>
+    static CardSignature of(const Cards& cards) {
+        CardSignature s;
+        for (const Card& c : cards) s.add(c);
+        return s;
+    }
+
+    auto operator<=>(const CardSignature&) const = default;
+};
+
+#endif // CARDSIGNATURE_H
@@ -0,0 +1,51 @@
+#include "decisionArena.h"
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// 每个线程一块缓冲区，第一次用到时分配，线程结束时释放
+struct Slab {
+    std::unique_ptr<std::byte[]> buffer;
+    size_t top = 0;
+    DecisionArena::Stats stats;
+};
+
+thread_local Slab slab;
+
+bool inSlab(const void* p) {
+    const std::byte* b = static_cast<const std::byte*>(p);
+    return slab.buffer && b >= slab.buffer.get() && b < slab.buffer.get() + DecisionArena::kBytes;
+}
+
+} // namespace
+
+DecisionArena::DecisionArena() {
+    if (!slab.buffer) slab.buffer = std::make_unique<std::byte[]>(kBytes);
+    mark_ = slab.top;
+    ++slab.stats.scopes;
+}
+
+DecisionArena::~DecisionArena() {
+    slab.top = mark_;
+}
+
+const DecisionArena::Stats& DecisionArena::threadStats() {
+    return slab.stats;
+}
+
+void* DecisionArena::do_allocate(size_t bytes, size_t alignment) {
+    const size_t start = (slab.top + alignment - 1) & ~(alignment - 1);
+    if (start + bytes <= kBytes) {
+        slab.top = start + bytes;
+        slab.stats.peakBytes = std::max(slab.stats.peakBytes, slab.top);
+        return slab.buffer.get() + start;
+    }
+    ++slab.stats.overflows;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void DecisionArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    // 缓冲区里的不单独释放，等 arena 析构一起退回
+    if (!inSlab(p)) std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
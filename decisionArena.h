@@ -0,0 +1,36 @@
+#ifndef DECISIONARENA_H
+#define DECISIONARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// 一次决策内的临时内存：从本线程的一整块缓冲区里顺序切分，不逐个释放，对象析构时把这段整体退回。
+// 配合 std::pmr 容器用（容器声明在 arena 之后，先于它析构），期间不走全局堆；
+// 用量超出缓冲区时才向全局堆要，计入 overflows。可以嵌套，但内层存在期间不要再从外层分配。
+class DecisionArena final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kBytes = size_t{2} << 20;
+
+    DecisionArena();
+    ~DecisionArena() override;
+    DecisionArena(const DecisionArena&) = delete;
+    DecisionArena& operator=(const DecisionArena&) = delete;
+
+    struct Stats {
+        uint64_t scopes = 0;    // 用过的 arena 个数
+        uint64_t overflows = 0; // 缓冲区不够、改向全局堆要的次数
+        size_t peakBytes = 0;   // 缓冲区最高用量
+    };
+    // 本线程的统计
+    static const Stats& threadStats();
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    size_t mark_; // 构造时缓冲区的用量，析构时退回到这里
+};
+
+#endif // DECISIONARENA_H
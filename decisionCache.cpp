@@ -0,0 +1,110 @@
+#include "decisionCache.h"
+#include <algorithm>
+#include <bit>
+#include "moveBatcher.h"
+
+namespace {
+
+uint32_t clampBits(int value, int bits) {
+    return static_cast<uint32_t>(std::clamp(value, 0, (1 << bits) - 1));
+}
+
+} // namespace
+
+DecisionCache::Key DecisionCache::makeKey(std::span<const Card> hand, const PlayInfo& base, int baseCards, int levelRank) {
+    Key key;
+    key.hand = CardSignature::of(hand);
+    // 牌型 4 位 | 主值 5 位 | 张数 5 位 | 实际张数 5 位 | 级牌 4 位；首出时前四项都是 0
+    key.situation = clampBits(static_cast<int>(base.type), 4)
+                  | clampBits(base.primaryRank, 5) << 4
+                  | clampBits(base.size, 5) << 9
+                  | clampBits(baseCards, 5) << 14
+                  | clampBits(levelRank, 4) << 19;
+    return key;
+}
+
+DecisionCache::DecisionCache(size_t capacity) {
+    setCount_ = std::bit_ceil(std::max<size_t>(1, (capacity + kWays - 1) / kWays));
+    sets_ = std::make_unique<Set[]>(setCount_);
+}
+
+DecisionCache::~DecisionCache() = default;
+
+size_t DecisionCache::setIndex(const Key& key) const {
+    // 乘法散列的低位只取决于输入的低位，最后再混一遍（splitmix64 的收尾）
+    uint64_t h = key.hand.lo * 0x9E3779B97F4A7C15ull;
+    h ^= (key.hand.hi + (static_cast<uint64_t>(key.situation) << 40)) * 0xC2B2AE3D27D4EB4Full;
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return static_cast<size_t>(h) & (setCount_ - 1);
+}
+
+bool DecisionCache::lookup(const Key& key, uint32_t random, Play& chosen) {
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+    const size_t index = setIndex(key);
+    std::lock_guard<std::mutex> guard(lockFor(index));
+    Set& set = sets_[index];
+    for (Entry& entry : set.ways) {
+        if (entry.stamp == 0 || !(entry.key == key)) continue;
+        entry.stamp = ++set.tick;
+        chosen.clear();
+        if (entry.choiceCount > 0) {
+            const PackedPlay& play = entry.choices[random % entry.choiceCount];
+            for (int i = 0; i < play.count; ++i) chosen.push_back(Card::fromId(play.ids[i]));
+        }
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void DecisionCache::insert(const Key& key, std::span<const Play> plays, const int64_t* scores) {
+    // 并列最优：去掉低位的随机次序后与最小分数相同；全部不能出时什么都不记，即“过”
+    const int64_t best = plays.empty() ? kRejectedMove : *std::min_element(scores, scores + plays.size());
+    size_t ties = 0;
+    if (best != kRejectedMove) {
+        for (size_t i = 0; i < plays.size(); ++i) ties += (scores[i] >> kScoreNoiseBits) == (best >> kScoreNoiseBits);
+    }
+    if (ties > kMaxChoices) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const size_t index = setIndex(key);
+    std::lock_guard<std::mutex> guard(lockFor(index));
+    Set& set = sets_[index];
+    // 已有同键条目（别的线程刚插入）时覆盖它，否则取空槽或最久未用的
+    Entry* slot = &set.ways[0];
+    for (Entry& entry : set.ways) {
+        if (entry.stamp != 0 && entry.key == key) {
+            slot = &entry;
+            break;
+        }
+        if (entry.stamp < slot->stamp) slot = &entry;
+    }
+    if (slot->stamp != 0 && !(slot->key == key)) evictions_.fetch_add(1, std::memory_order_relaxed);
+
+    slot->key = key;
+    slot->stamp = ++set.tick;
+    slot->choiceCount = 0;
+    for (size_t i = 0; ties > 0 && i < plays.size(); ++i) {
+        if ((scores[i] >> kScoreNoiseBits) != (best >> kScoreNoiseBits)) continue;
+        PackedPlay& packed = slot->choices[slot->choiceCount++];
+        packed.count = static_cast<uint8_t>(std::min(plays[i].size(), kMaxPlayCards));
+        for (int c = 0; c < packed.count; ++c) packed.ids[c] = static_cast<uint8_t>(plays[i][c].toId());
+    }
+    inserts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+DecisionCache::Stats DecisionCache::stats() const {
+    Stats s;
+    s.lookups = lookups_.load(std::memory_order_relaxed);
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.inserts = inserts_.load(std::memory_order_relaxed);
+    s.evictions = evictions_.load(std::memory_order_relaxed);
+    s.skipped = skipped_.load(std::memory_order_relaxed);
+    return s;
+}
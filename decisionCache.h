@@ -0,0 +1,87 @@
+#ifndef DECISIONCACHE_H
+#define DECISIONCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include "cardSignature.h"
+#include "handmatcher.h"
+#include "moveIndex.h"
+
+// AI 决策缓存。手牌相同（按张数签名）、上家牌型与级牌相同时，候选集合和打分排序完全一样，
+// 不同的只是并列最优之间的随机次序；缓存记下并列最优的那几手（没有能出的就记“过”），
+// 命中时直接在其中随机挑一手，省掉候选识别和打分，选牌的分布与不用缓存时相同。
+// 组相联：键哈希到一组 kWays 个槽位，组内淘汰最久未用的（LRU），容量在构造时定死；
+// 各组按条带加锁，服务器的所有分片线程共用一个。
+class DecisionCache {
+public:
+    static constexpr size_t kWays = 8;
+    static constexpr size_t kMaxChoices = 32; // 并列最优多于这么多手（如大手牌首出）时不缓存
+
+    struct Key {
+        CardSignature hand;
+        uint32_t situation = 0; // 上家牌型、主值、张数、实际张数与级牌，见 makeKey
+
+        bool operator==(const Key&) const = default;
+    };
+    // base/baseCards 为上家牌的分析结果与张数，首出时 baseCards 为 0
+    static Key makeKey(std::span<const Card> hand, const PlayInfo& base, int baseCards, int levelRank);
+
+    struct Stats {
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+        uint64_t inserts = 0;
+        uint64_t evictions = 0; // 插入时挤掉了别的条目
+        uint64_t skipped = 0;   // 并列最优太多没有缓存
+
+        double hitRate() const { return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0; }
+    };
+
+    // capacity 为大致条目数，组数取不小于 capacity / kWays 的 2 的幂
+    explicit DecisionCache(size_t capacity);
+    ~DecisionCache();
+    DecisionCache(const DecisionCache&) = delete;
+    DecisionCache& operator=(const DecisionCache&) = delete;
+
+    // 命中时用 random 在并列最优里挑一手写进 chosen（缓存的是“过”时 chosen 为空），返回 true
+    bool lookup(const Key& key, uint32_t random, Play& chosen);
+    // scores[i] 是 plays[i] 的分数（scoreMoves 的结果），记下其中并列最优的几手
+    void insert(const Key& key, std::span<const Play> plays, const int64_t* scores);
+
+    Stats stats() const;
+    size_t capacity() const { return setCount_ * kWays; }
+
+private:
+    struct PackedPlay {
+        uint8_t count = 0;
+        uint8_t ids[kMaxPlayCards] = {};
+    };
+    struct Entry {
+        Key key;
+        uint64_t stamp = 0; // 最近一次使用时组内的时钟，0 表示空槽
+        uint8_t choiceCount = 0;
+        PackedPlay choices[kMaxChoices];
+    };
+    struct Set {
+        uint64_t tick = 0;
+        Entry ways[kWays];
+    };
+    static constexpr size_t kStripes = 64;
+
+    size_t setIndex(const Key& key) const;
+    std::mutex& lockFor(size_t set) { return locks_[set & (kStripes - 1)]; }
+
+    size_t setCount_;
+    std::unique_ptr<Set[]> sets_;
+    std::mutex locks_[kStripes];
+    std::atomic<uint64_t> lookups_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> inserts_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+#endif // DECISIONCACHE_H
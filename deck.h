@@ -21,6 +21,9 @@ public:
     // 取得当前底牌（调试/显示用）
     const std::vector<Card>& cards() const noexcept { return cards_; }
 
+    // 固定洗牌种子（基准测试/复现对局用）
+    void seed(unsigned int s) { rng_.seed(s); }
+
     // 清空牌堆
     void clear() noexcept { cards_.clear(); }
 
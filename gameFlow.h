@@ -0,0 +1,20 @@
+#ifndef GAMEFLOW_H
+#define GAMEFLOW_H
+
+#include <coroutine>
+#include <exception>
+
+// 游戏流程协程（C++20）：进贡/还贡这类“发起请求 -> 等待若干玩家选牌 -> 延时 -> 下一步”的流程
+// 写成一个顺序执行的协程，等待点上挂起，由选牌提交或调度器到时恢复。
+// 协程创建后立即执行到第一个等待点，结束时自行销毁帧；由谁恢复、何时销毁由持有句柄的一方（Judge）负责。
+struct FlowTask {
+    struct promise_type {
+        FlowTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+#endif // GAMEFLOW_H
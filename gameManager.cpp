@@ -15,6 +15,8 @@ void GameManager::setPlayers() {
     players_ = {humanPlayer, aiPlayer1, aiPlayer2, aiPlayer3};
 
     judge_->setPlayers(players_);
+    // 人类玩家思考时三个 AI 先把下一手想好：切成每份几毫秒的空闲任务，夹在界面事件之间执行
+    judge_->setPonderBudgetMs(20);
 }
 HumanPlayer* GameManager::getHumanPlayer(){
     return humanPlayer;
@@ -50,6 +52,7 @@ void GameManager::startNextRound() {
         players_[i]->setHand(hands[i]);
         emit playerDealt(i);
     }
+    judge_->notifyHandsDealt();
 
     emit gameStarted();
     judge_->startTributePhase();
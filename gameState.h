@@ -0,0 +1,110 @@
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "card.h"
+
+// 一手牌的流程状态。进贡细节（谁给谁、是否已选牌）仍在 tributeList 里，这里只描述“现在处于哪一步”
+enum class TableState : uint8_t {
+    Dealt,               // 已发牌，尚未决定是否进贡
+    DoubleTributeSelect, // 双贡比牌：两名进贡者同时选牌
+    Tribute,             // 进贡
+    ReturnTribute,       // 还贡
+    Playing,             // 正常打牌
+    HandOver             // 本局已结算，等待下一局发牌
+};
+constexpr int kTableStateCount = 6;
+
+// 推动流程的内部事件
+enum class TableEvent : uint8_t {
+    NewHand,               // 重新发牌（任何状态都可以回到 Dealt）
+    BeginTribute,          // 单贡，或双贡比牌结束后的进贡
+    BeginDoubleTribute,
+    TributesGiven,         // 进贡的牌已移动，转入还贡
+    BeginPlay,             // 进贡结束/抗贡/首局，开始打牌
+    HandFinished           // 只剩一人有牌，本局结算
+};
+constexpr int kTableEventCount = 6;
+
+// 来自座位的外部动作（人类、AI 定时器、远程客户端、超时托管）
+enum class SeatAction : uint8_t {
+    Play,
+    Pass,
+    Tribute,
+    Timeout
+};
+
+// 排队等待处理的座位事件：按到达顺序逐个校验、应用
+struct SeatEvent {
+    SeatAction action = SeatAction::Pass;
+    int seat = -1;
+    std::vector<Card> cards; // Play：要出的牌；Tribute：cards[0] 为进贡/还贡的牌
+    uint32_t tag = 0;        // 投递方自用（例如超时编号），Judge 不解释
+};
+
+namespace tablefsm {
+
+constexpr uint8_t kInvalid = 0xFF;
+constexpr uint8_t to(TableState state) { return static_cast<uint8_t>(state); }
+constexpr uint8_t bit(SeatAction action) { return static_cast<uint8_t>(1u << static_cast<int>(action)); }
+
+using Row = std::array<uint8_t, kTableEventCount>;
+// NewHand 在任何状态下都回到 Dealt
+constexpr Row row(uint8_t beginTribute, uint8_t beginDouble, uint8_t given, uint8_t beginPlay, uint8_t finished) {
+    return Row{to(TableState::Dealt), beginTribute, beginDouble, given, beginPlay, finished};
+}
+
+// 转移表，列顺序同 TableEvent：NewHand, BeginTribute, BeginDoubleTribute, TributesGiven, BeginPlay, HandFinished
+constexpr std::array<Row, kTableStateCount> kTransitions{{
+    /* Dealt */               row(to(TableState::Tribute), to(TableState::DoubleTributeSelect), kInvalid, to(TableState::Playing), kInvalid),
+    /* DoubleTributeSelect */ row(to(TableState::Tribute), kInvalid, kInvalid, to(TableState::Playing), kInvalid),
+    /* Tribute */             row(kInvalid, kInvalid, to(TableState::ReturnTribute), to(TableState::Playing), kInvalid),
+    /* ReturnTribute */       row(kInvalid, kInvalid, kInvalid, to(TableState::Playing), kInvalid),
+    /* Playing */             row(kInvalid, kInvalid, kInvalid, kInvalid, to(TableState::HandOver)),
+    /* HandOver */            row(kInvalid, kInvalid, kInvalid, kInvalid, kInvalid),
+}};
+
+// 每个状态下允许的座位动作（按 SeatAction 位组合）
+constexpr uint8_t kTributeActions = bit(SeatAction::Tribute) | bit(SeatAction::Timeout);
+constexpr uint8_t kPlayActions = bit(SeatAction::Play) | bit(SeatAction::Pass) | bit(SeatAction::Timeout);
+constexpr std::array<uint8_t, kTableStateCount> kSeatActions{{
+    /* Dealt */               0,
+    /* DoubleTributeSelect */ kTributeActions,
+    /* Tribute */             kTributeActions,
+    /* ReturnTribute */       kTributeActions,
+    /* Playing */             kPlayActions,
+    /* HandOver */            0,
+}};
+
+} // namespace tablefsm
+
+// 表驱动的状态机：转移和动作许可都是编译期生成的查表，分派只有一次数组下标，
+// 不合法的事件/动作在这里直接被拒绝，不再依赖散落各处的标志位判断
+class TableStateMachine {
+public:
+    TableState state() const { return state_; }
+
+    // 按转移表推进，返回 false 表示该事件在当前状态下不合法（状态不变）
+    bool fire(TableEvent event) {
+        const uint8_t next = tablefsm::kTransitions[static_cast<int>(state_)][static_cast<int>(event)];
+        if (next == tablefsm::kInvalid) return false;
+        state_ = static_cast<TableState>(next);
+        return true;
+    }
+    bool canFire(TableEvent event) const {
+        return tablefsm::kTransitions[static_cast<int>(state_)][static_cast<int>(event)] != tablefsm::kInvalid;
+    }
+    bool allows(SeatAction action) const {
+        return (tablefsm::kSeatActions[static_cast<int>(state_)] >> static_cast<int>(action)) & 1u;
+    }
+
+    // 仅供检查点恢复与调试：直接跳到某个状态
+    void reset(TableState state) { state_ = state; }
+
+private:
+    TableState state_ = TableState::Dealt;
+};
+
+#endif // GAMESTATE_H
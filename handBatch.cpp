@@ -0,0 +1,135 @@
+#include "handBatch.h"
+#include <cstring>
+#include "levelOrder.h"
+
+// x86-64 上的 GCC：同一份内核再按 8 x u32 向量、AVX2 指令集编译一份，运行时按 CPU 选用
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define HANDBATCH_AVX2 1
+#endif
+
+namespace {
+
+using Block = HandBatch::Block;
+constexpr int kLanes = HandBatch::kLanes;
+
+// 标量内核：一个分量就是一手牌
+namespace scalar {
+
+using Lane = uint32_t;
+inline Lane laneGt(Lane a, Lane b) { return a > b ? ~0u : 0u; }
+inline Lane laneEq(Lane a, Lane b) { return a == b ? ~0u : 0u; }
+inline Lane laneLoad(const uint32_t* row, int lane) { return row[lane]; }
+inline void laneStore(int32_t* out, int lane, Lane v) { out[lane] = static_cast<int32_t>(v); }
+
+#include "handBatchLanes.h"
+
+void classifyBlocks(const Block* blocks, size_t n, int32_t* type, int32_t* primary, int32_t* size) {
+    for (size_t i = 0; i < n; ++i) {
+        for (int lane = 0; lane < kLanes; ++lane) {
+            classifyLanes(blocks[i], lane, type + i * kLanes, primary + i * kLanes, size + i * kLanes);
+        }
+    }
+}
+
+} // namespace scalar
+
+#ifdef HANDBATCH_AVX2
+#pragma GCC push_options
+#pragma GCC target("avx2")
+// AVX2 内核：一个分量是一整块的 8 手牌，本段内的函数都按 AVX2 编译
+namespace avx2 {
+
+typedef uint32_t Lane __attribute__((vector_size(32)));
+inline Lane laneGt(Lane a, Lane b) { return (Lane)(a > b); }
+inline Lane laneEq(Lane a, Lane b) { return (Lane)(a == b); }
+inline Lane laneLoad(const uint32_t* row, int) {
+    Lane v;
+    std::memcpy(&v, row, sizeof(v));
+    return v;
+}
+inline void laneStore(int32_t* out, int, Lane v) { std::memcpy(out, &v, sizeof(v)); }
+
+#include "handBatchLanes.h"
+
+void classifyBlocks(const Block* blocks, size_t n, int32_t* type, int32_t* primary, int32_t* size) {
+    for (size_t i = 0; i < n; ++i) {
+        classifyLanes(blocks[i], 0, type + i * kLanes, primary + i * kLanes, size + i * kLanes);
+    }
+}
+
+} // namespace avx2
+#pragma GCC pop_options
+
+// 可能在其他全局构造之前求值，先显式初始化 CPU 特性信息
+const bool kHasAvx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+#endif
+
+// 把一手牌写进块的第 lane 个分量
+void fillLane(Block& block, int lane, std::span<const Card> cards, int levelRank) {
+    const LevelOrder& order = levelOrder(levelRank);
+    for (const Card& c : cards) {
+        const int id = c.toId();
+        if (order.isWild(id)) {
+            ++block.wild[lane];
+            continue;
+        }
+        ++block.counts[order.logValue[id]][lane];
+        if (id < 52) block.suits[lane] |= 1u << (id / 13);
+    }
+    block.total[lane] = static_cast<uint32_t>(cards.size());
+    block.level[lane] = (levelRank >= 2 && levelRank <= kMaxLevelRank) ? static_cast<uint32_t>(levelRank) : 0u;
+}
+
+} // namespace
+
+void HandBatch::clear() {
+    blocks_.clear();
+    count_ = 0;
+}
+
+void HandBatch::reserve(size_t hands) {
+    blocks_.reserve((hands + kLanes - 1) / kLanes);
+}
+
+size_t HandBatch::push(std::span<const Card> cards, int levelRank) {
+    const size_t index = count_++;
+    if (index % kLanes == 0) blocks_.emplace_back();
+    fillLane(blocks_.back(), static_cast<int>(index % kLanes), cards, levelRank);
+    return index;
+}
+
+void HandBatch::classify() {
+    const size_t padded = blocks_.size() * kLanes;
+    type_.resize(padded);
+    primary_.resize(padded);
+    size_.resize(padded);
+    if (blocks_.empty()) return;
+#ifdef HANDBATCH_AVX2
+    if (kHasAvx2) {
+        avx2::classifyBlocks(blocks_.data(), blocks_.size(), type_.data(), primary_.data(), size_.data());
+        return;
+    }
+#endif
+    scalar::classifyBlocks(blocks_.data(), blocks_.size(), type_.data(), primary_.data(), size_.data());
+}
+
+PlayInfo HandBatch::classifyOne(std::span<const Card> cards, int levelRank) {
+    Block block{};
+    fillLane(block, 0, cards, levelRank);
+    int32_t type[kLanes], primary[kLanes], size[kLanes];
+    scalar::classifyLanes(block, 0, type, primary, size);
+    const HandType t = static_cast<HandType>(type[0]);
+    return {t, primary[0], size[0], t == HandType::StraightFlush};
+}
+
+PlayInfo HandBatch::info(size_t i) const {
+    const HandType type = static_cast<HandType>(type_[i]);
+    return {type, primary_[i], size_[i], type == HandType::StraightFlush};
+}
+
+const char* HandBatch::implementation() {
+#ifdef HANDBATCH_AVX2
+    if (kHasAvx2) return "avx2";
+#endif
+    return "scalar";
+}
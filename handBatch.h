@@ -0,0 +1,58 @@
+#ifndef HANDBATCH_H
+#define HANDBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "card.h"
+#include "handmatcher.h"
+
+// 批量牌型识别：候选出牌按结构数组存放（每 8 手一块，块内按逻辑值一行一行放张数），
+// 结果与 HandMatcher::analyze 逐手一致。识别内核（handBatchLanes.h）全部是逐分量的掩码运算：
+// CPU 支持 AVX2 时一次识别整块 8 手，否则同一份内核逐手标量执行。
+// AIPlayer::describePlays 用它给整批候选写特征列。
+class HandBatch {
+public:
+    static constexpr int kLanes = 8;
+    static constexpr int kValues = 21; // 逻辑值 0..20，实际用到 2..20（见 LevelOrder::logValue）
+
+    void clear();
+    size_t count() const { return count_; }
+    void reserve(size_t hands);
+
+    // 追加一手牌，返回其下标
+    size_t push(std::span<const Card> cards, int levelRank);
+    // 识别已追加的全部候选
+    void classify();
+
+    // classify 之后按下标取结果
+    PlayInfo info(size_t i) const;
+    int wildCount(size_t i) const { return blocks_[i / kLanes].wild[i % kLanes]; }
+    const int32_t* types() const { return type_.data(); }
+    const int32_t* primaries() const { return primary_.data(); }
+    const int32_t* sizes() const { return size_.data(); }
+
+    // 只识别一手（如上家的牌）：块放在栈上走标量内核，不分配内存
+    static PlayInfo classifyOne(std::span<const Card> cards, int levelRank);
+
+    // 当前进程实际使用的实现："avx2" / "scalar"
+    static const char* implementation();
+
+    struct alignas(32) Block {
+        uint32_t counts[kValues][kLanes]; // 固定牌每个逻辑值的张数
+        uint32_t wild[kLanes];            // 万能牌张数
+        uint32_t total[kLanes];           // 总张数
+        uint32_t level[kLanes];           // 级牌点数（不在 2..14 时记 0）
+        uint32_t suits[kLanes];           // 固定牌（不含大小王）出现过的花色位
+    };
+
+private:
+    std::vector<Block> blocks_;
+    std::vector<int32_t> type_;
+    std::vector<int32_t> primary_;
+    std::vector<int32_t> size_;
+    size_t count_ = 0;
+};
+
+#endif // HANDBATCH_H
@@ -0,0 +1,138 @@
+// handBatchLanes.h
+// HandBatch 的识别内核。没有 include guard：handBatch.cpp 在不同命名空间里按两种分量类型各包含一次，
+// 包含前需定义
+//   Lane                               分量类型（uint32_t 为一手牌；8 x uint32_t 向量为 8 手牌）
+//   Lane laneGt(Lane, Lane) / laneEq   逐分量比较，结果为全 1 / 全 0
+//   Lane laneLoad(const uint32_t* row, int lane) / void laneStore(int32_t* out, int lane, Lane)
+// 以及 Block（HandBatch::Block）。判定规则与 HandMatcher::analyze 一致。
+
+inline Lane splat(uint32_t v) { return Lane{} + v; }
+inline Lane gtMask(Lane a, uint32_t b) { return laneGt(a, splat(b)); }
+inline Lane eqMask(Lane a, uint32_t b) { return laneEq(a, splat(b)); }
+inline Lane select(Lane mask, Lane a, Lane b) { return (mask & a) | (~mask & b); }
+
+// 与 WindowCounter 相同的位切片计数，每个分量各自计数
+struct LaneCounter {
+    Lane b0{}, b1{}, b2{};
+
+    void add(Lane m) {
+        const Lane carry0 = b0 & m;
+        b0 ^= m;
+        const Lane carry1 = b1 & carry0;
+        b1 ^= carry0;
+        b2 |= carry1;
+    }
+    // 计数不超过各分量的 limit（0..4，更大视为不限）
+    Lane atMost(Lane limit) const {
+        Lane ok = ~Lane{};
+        for (int n = 4; n >= 0; --n) {
+            const Lane bits[3] = {b0, b1, b2};
+            Lane less{}, equal = ~Lane{};
+            for (int i = 2; i >= 0; --i) {
+                if ((n >> i) & 1) {
+                    less |= equal & ~bits[i];
+                    equal &= bits[i];
+                } else {
+                    equal &= ~bits[i];
+                }
+            }
+            ok = select(eqMask(limit, static_cast<uint32_t>(n)), less | equal, ok);
+        }
+        return ok;
+    }
+};
+
+// 连续元组的最低可行起点（0 表示没有），width/len 同 tupleWindows
+inline Lane lowestTupleStart(const Lane atLeast[4], int width, int len, Lane wild) {
+    LaneCounter holes;
+    for (int k = 0; k < len; ++k) {
+        for (int j = 0; j < width; ++j) holes.add(~atLeast[j] >> k);
+    }
+    const Lane ok = holes.atMost(wild) & splat(((1u << (22 - len)) - 1) & ~3u);
+    Lane start{};
+    for (int s = 20; s >= 2; --s) start = select(gtMask((ok >> s) & splat(1), 0u), splat(s), start);
+    return start;
+}
+
+// 先按逻辑值一行行累计出现、至少 2/3/4 张的位掩码与种类数，再用与 straightWindows / tupleWindows
+// 相同的位切片计数找顺子和连续元组窗口，最后按 analyze 的优先级从低到高覆盖写结果
+inline void classifyLanes(const Block& b, int lane, int32_t* outType, int32_t* outPrimary, int32_t* outSize) {
+    const Lane zero{};
+    const Lane wild = laneLoad(b.wild, lane);
+    const Lane total = laneLoad(b.total, lane);
+    const Lane level = laneLoad(b.level, lane);
+    const Lane suits = laneLoad(b.suits, lane);
+
+    Lane atLeast[4] = {};
+    Lane distinct{}, top{}, low = splat(0xFF), trip{}, dup{}, seqMask{};
+    for (int v = 2; v < HandBatch::kValues; ++v) {
+        const Lane cv = laneLoad(b.counts[v], lane);
+        const Lane present = gtMask(cv, 0u);
+        const Lane bit = splat(1u << v);
+        for (int k = 0; k < 4; ++k) atLeast[k] |= gtMask(cv, static_cast<uint32_t>(k)) & bit;
+        distinct += present & splat(1);
+        top = select(present, splat(v), top);
+        low = select(present & eqMask(low, 0xFFu), splat(v), low);
+        trip = select(eqMask(cv, 3u), splat(v), trip);
+        if (v <= 14 || v == 18) dup |= gtMask(cv, 1u);
+        if (v <= 14) seqMask |= present & splat(straightBit(v));
+    }
+    // 非红桃的级牌在顺子里按本来的点数算
+    const Lane levelCards = gtMask(laneLoad(b.counts[18], lane), 0u);
+    const Lane levelShift = select(gtMask(level, 1u), level - splat(1), zero);
+    const Lane levelBit = select(eqMask(level, 14u), splat(straightBit(14)), splat(1) << levelShift);
+    seqMask |= levelCards & levelBit;
+
+    const Lane smallJokers = laneLoad(b.counts[19], lane);
+    const Lane bigJokers = laneLoad(b.counts[20], lane);
+    const Lane noJokers = eqMask(smallJokers + bigJokers, 0u);
+    const Lane hasSolids = gtMask(total - wild, 0u);
+    const Lane five = eqMask(total, 5u);
+
+    // 顺子：顶张 = 最高可行窗口 + 5
+    LaneCounter straightHoles;
+    for (int k = 0; k < 5; ++k) straightHoles.add(~seqMask >> k);
+    const Lane straightOk = straightHoles.atMost(wild) & splat(0x3FFu);
+    Lane straightTop{};
+    for (int i = 0; i < 10; ++i) straightTop = select(gtMask((straightOk >> i) & splat(1), 0u), splat(i + 5), straightTop);
+    const Lane straightShape = five & noJokers & hasSolids & ~dup & gtMask(straightOk, 0u);
+
+    Lane type{}, primary{};
+    auto apply = [&](Lane when, HandType t, Lane value) {
+        type = select(when, splat(static_cast<uint32_t>(t)), type);
+        primary = select(when, value, primary);
+    };
+
+    // 单、对、三：只能有一种点数，全是万能牌时按 A 算；三种牌型编号依次相邻
+    const Lane basics = gtMask(total, 0u) & ~gtMask(total, 3u) & ~gtMask(distinct, 1u);
+    apply(basics, HandType::Single, select(eqMask(distinct, 0u), splat(14), top));
+    type = select(basics, type + total - splat(1), type);
+
+    apply(straightShape, HandType::Straight, straightTop);
+
+    const Lane tripsWithPair = five & eqMask(distinct, 2u)
+                             & ((eqMask(wild, 0u) & gtMask(trip, 0u))
+                                | (eqMask(wild, 1u) & eqMask(top - low, 1u))
+                                | eqMask(wild, 2u));
+    apply(tripsWithPair, HandType::TripsWithPair, select(eqMask(wild, 0u), trip, top));
+
+    // 三连对、钢板：6 张且最多 1 张万能牌
+    const Lane tupleBase = eqMask(total, 6u) & ~gtMask(wild, 1u);
+    const Lane pairsStart = lowestTupleStart(atLeast, 2, 3, wild);
+    const Lane steelStart = lowestTupleStart(atLeast, 3, 2, wild);
+    apply(tupleBase & eqMask(atLeast[2], 0u) & gtMask(pairsStart, 0u), HandType::TriplePairs, pairsStart + splat(2));
+    apply(tupleBase & eqMask(atLeast[3], 0u) & gtMask(steelStart, 0u), HandType::SteelPlate, steelStart + splat(1));
+
+    const Lane bomb = gtMask(total, 3u) & hasSolids & noJokers & eqMask(distinct, 1u);
+    apply(bomb, HandType::Bomb, top);
+
+    const Lane singleSuit = gtMask(suits, 0u) & eqMask(suits & (suits - splat(1)), 0u);
+    apply(straightShape & singleSuit, HandType::StraightFlush, straightTop);
+
+    const Lane tianWang = eqMask(total, 4u) & eqMask(wild, 0u) & eqMask(smallJokers, 2u) & eqMask(bigJokers, 2u);
+    apply(tianWang, HandType::TianWang, splat(20));
+
+    laneStore(outType, lane, type);
+    laneStore(outPrimary, lane, primary);
+    laneStore(outSize, lane, select(gtMask(type, 0u), total, zero));
+}
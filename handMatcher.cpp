@@ -2,6 +2,7 @@
 #include <set>
 #include <cmath>
 #include <algorithm>
+#include <bit>
 
 // ==========================================
 // 构造与初始化
@@ -11,11 +12,18 @@ HandMatcher::HandMatcher(const std::vector<Card>& cards, int lvlRank)
     , wildCount(0)
     , levelRank(lvlRank)
     , totalCount(static_cast<int>(cards.size()))
+    , order(levelOrder(lvlRank))
 {
     solids.reserve(cards.size());
+    withLevelRank(lvlRank, [&](auto level) { splitCards<decltype(level)::value>(cards); });
+}
 
+// 按级牌实例化：级牌表在编译期确定，拆分与排序的循环里只剩查表
+template <int Level>
+void HandMatcher::splitCards(const std::vector<Card>& cards) {
+    constexpr const LevelOrder& table = kLevelOrders[Level];
     for (const auto& c : cards) {
-        if (isWild(c)) {
+        if (table.isWild(c.toId())) {
             wildCount++;
         } else {
             solids.push_back(c);
@@ -23,8 +31,8 @@ HandMatcher::HandMatcher(const std::vector<Card>& cards, int lvlRank)
     }
 
     // 预排序固定牌（按逻辑大小），方便后续处理
-    std::sort(solids.begin(), solids.end(), [this](const Card& a, const Card& b) {
-        return getLogValue(a) < getLogValue(b);
+    std::sort(solids.begin(), solids.end(), [](const Card& a, const Card& b) {
+        return kLevelOrders[Level].logValue[a.toId()] < kLevelOrders[Level].logValue[b.toId()];
     });
 }
 
@@ -66,6 +74,9 @@ PlayInfo HandMatcher::analyze() {
     case 5:
         info = matchTripsWithPair(); // 三带二
         if (info.type != HandType::Invalid) return info;
+
+        info = matchStraight(); // 顺子
+        if (info.type != HandType::Invalid) return info;
         break;
     case 3:
     case 2:
@@ -156,34 +167,28 @@ PlayInfo HandMatcher::matchStraightFlush() {
 
     return {};
 }
+
+// 4. 顺子 (5张连续，花色不限；同花的已在前面识别为同花顺)
+PlayInfo HandMatcher::matchStraight() {
+    if (totalCount != 5) return {};
+
+    int top = checkStraightRank();
+    if (top > 0) {
+        return {HandType::Straight, top, 5};
+    }
+    return {};
+}
+
 PlayInfo HandMatcher::matchSteelPlate() {
     if (totalCount != 6) return {};
     if (wildCount >= 2) return {};
-    std::map<int, int> counts = getLogCounts();
-
-    if (counts.size() != 2) return {};
-    auto it = counts.begin();
-    int lowRank = it->first;
-    int highRank = (++it)->first;
-    if (highRank != lowRank + 1) return {};
-
-    if (counts[lowRank] > 3 || counts[highRank] > 3) return {};
-    return {HandType::SteelPlate, highRank, 6};
+    return matchConsecutiveTuples(2, 3, HandType::SteelPlate);
 }
 
 PlayInfo HandMatcher::matchTriplePairs() {
     if (totalCount != 6) return {};
     if (wildCount >= 2) return {};
-    std::map<int, int> counts = getLogCounts();
-    if (counts.size() != 3) return {};
-    auto it = counts.begin();
-    int r1 = it->first;
-    int r2 = (++it)->first;
-    int r3 = (++it)->first;
-
-    if (r2 != r1 + 1 || r3 != r2 + 1) return {};
-    if (counts[r1] > 2 || counts[r2] > 2 || counts[r3] > 2) return {};
-    return {HandType::TriplePairs, r3, 6};
+    return matchConsecutiveTuples(3, 2, HandType::TriplePairs);
 }
 
 
@@ -269,23 +274,15 @@ PlayInfo HandMatcher::matchBasics() {
 // ==========================================
 
 int HandMatcher::getLogValue(const Card& c) const {
-    if (c.getRank() == Rank::B) return 20;
-    if (c.getRank() == Rank::S) return 19;
-
-    int r = c.getRankInt(); // 假设: 3=3 ... A=14, 2=15
-    if (r == levelRank) return 18; // 级牌
-    if (r == 15) return 2;         // 2 (若非级牌)
-    return r;
+    return order.logOf(c); // 2..A 为 2..14，级牌 18，小王 19，大王 20
 }
 
 int HandMatcher::getSeqValue(const Card& c) const {
-    int r = c.getRankInt();
-    if (r == 15) return 2; // 还原2
-    return r;
+    return order.seqOf(c);
 }
 
 bool HandMatcher::isWild(const Card& c) const {
-    return (c.getSuit() == Suit::Hearts && c.getRankInt() == levelRank);
+    return order.isWild(c);
 }
 
 std::map<int, int> HandMatcher::getLogCounts() const {
@@ -294,108 +291,43 @@ std::map<int, int> HandMatcher::getLogCounts() const {
     return m;
 }
 
-// 通用连续元组逻辑 (用于钢板/连对)
-PlayInfo HandMatcher::matchConsecutiveTuples(int tupleCount, int tupleSize, HandType type) {
-    std::map<int, int> counts = getLogCounts();
-
-    for (int start = 2; start <= 14 - tupleCount + 1; ++start) {
-
-        bool possible = true;
-        int wildUsed = 0;
-        int cardsCovered = 0;
-
-        for (int i = 0; i < tupleCount; ++i) {
-            int cur = start + i;
-            int c = counts[cur];
-            if (c > tupleSize) { possible = false; break; } // 单张点数过多
-
-            wildUsed += (tupleSize - c);
-            cardsCovered += c;
-        }
+void HandMatcher::getLogAtLeastMasks(uint32_t atLeast[5]) const {
+    int counts[21] = {};
+    for (const auto& c : solids) counts[getLogValue(c)]++;
+    fillAtLeastMasks(counts, atLeast);
+}
 
-        if (!possible) continue;
-        if (wildCount < wildUsed) continue;
-        if (cardsCovered + wildCount != totalCount) continue;
-        return {type, start + tupleCount - 1, totalCount};
-    }
-    return {};
+// 通用连续元组逻辑 (用于钢板/连对)：在 tupleWindows 给出的窗口里找能装下全部固定牌的那个
+PlayInfo HandMatcher::matchConsecutiveTuples(int tupleCount, int tupleSize, HandType type) {
+    uint32_t atLeast[5];
+    getLogAtLeastMasks(atLeast);
+    if (atLeast[tupleSize + 1] != 0) return {}; // 单个点数张数过多
+
+    // 缺口不超过万能牌数，说明窗口内已有的固定牌不少于 tupleCount*tupleSize - wildCount 张；
+    // 总数恰好等于 tupleCount*tupleSize 时，固定牌就全部落在这个窗口里，最多只有一个这样的窗口
+    if (tupleCount * tupleSize != totalCount) return {};
+    const uint32_t windows = tupleWindows(atLeast, tupleSize, tupleCount, wildCount);
+    if (windows == 0) return {};
+    const int start = std::countr_zero(windows);
+    return {type, start + tupleCount - 1, totalCount};
 }
 
-// 检查顺子序列 (核心算法修改版)
+// 检查顺子序列：固定牌写进点数掩码，再用 straightWindows 一次求出所有能补齐的窗口
 int HandMatcher::checkStraightRank() const {
     if (solids.empty()) return 0; // 无固定牌无法判定顺子
-    std::vector<int> seqs;
+    uint32_t mask = 0;
     for (const auto& c : solids) {
         int v = getSeqValue(c);
         if (v >= 16) return 0;
-        seqs.push_back(v);
-    }
-    std::sort(seqs.begin(), seqs.end());
-    bool hasA = std::find(seqs.begin(), seqs.end(), 14) != seqs.end();
-
-    std::vector<int> uniq = seqs;
-    auto last = std::unique(uniq.begin(), uniq.end());
-    if (last != uniq.end()) return 0;
-    auto calcResult = [&](int maxV, int missing) -> int {
-        // 情况 A: 连续 (没有缺牌)
-        if (missing == 0) {
-            // 返回 solids 最大的主值加上尽可能多的红桃级牌数
-            // 但不能超过 A (14)
-            int result = maxV + wildCount;
-            return (result > 14) ? 14 : result;
-        }
-
-        // 情况 B: 中间差了一张牌 (missing == 1)
-        if (missing == 1) {
-            if (wildCount == 1) return maxV;     // 补齐中间，最大值仍是 maxV
-            if (wildCount == 2) {
-                // 补齐中间消耗1张，剩1张加在尾部
-                int result = maxV + 1;
-                return (result > 14) ? 14 : result;
-            }
-        }
-
-        // 情况 C: 中间差了两张牌 (missing == 2)
-        if (missing == 2) {
-            if (wildCount == 2) return maxV;     // 补齐中间，最大值仍是 maxV
-        }
-
-        return 0; // 其他情况无法构成顺子
-    };
-
-    // --- 策略 1: 特殊同花顺 A2345 (A当作1) ---
-    if (hasA) {
-        std::vector<int> lowSeqs = seqs;
-        // 将 A(14) 变为 1，并重新排序
-        for(int& x : lowSeqs) if(x == 14) x = 1;
-        std::sort(lowSeqs.begin(), lowSeqs.end());
-
-        // 只有当最大值不超过 5 时才可能是 A2345
-        if (lowSeqs.back() <= 5) {
-            int minV = lowSeqs.front();
-            int maxV = lowSeqs.back();
-            int count = lowSeqs.size();
-            // 计算跨度缺失: (5 - 1 + 1) - 3 = 2
-            int missing = (maxV - minV + 1) - count;
-
-            // 调用通用逻辑，如果计算成功，强制返回 5 (A2345的主值)
-            if (calcResult(maxV, missing) > 0) return 5;
-        }
+        const uint32_t bit = straightBit(v);
+        if (mask & bit) return 0; // 顺子不能有重复点数
+        mask |= bit;
     }
 
-    // --- 策略 2: 普通同花顺 (A当作14) ---
-    int minV = seqs.front();
-    int maxV = seqs.back();
-    int count = seqs.size();
-
-    // 计算中间缺了几张
-    // 例如: 3,4,6. Max=6, Min=3. Count=3. (6-3+1)-3 = 1. 缺1张(5)
-    int missing = (maxV - minV + 1) - count;
-
-    int res = calcResult(maxV, missing);
-
-    // A 只能出现在顺子的首尾（A2345 或 10JQKA），否则视为无效
-    if (hasA && res != 5 && res != 14) return 0;
-
-    return res;
+    // 总数为 5 时，缺口不超过万能牌数的窗口必然包含全部固定牌；
+    // A 只能出现在首尾（A2345 或 10JQKA），由 A 的两个位置自然保证。
+    // 多个窗口都可行时取顶张最大的（万能牌尽量往上补）
+    const uint32_t windows = straightWindows(mask, wildCount);
+    if (windows == 0) return 0;
+    return 4 + static_cast<int>(std::bit_width(windows));
 }
@@ -0,0 +1,330 @@
+// handSampler.cpp
+#include "handSampler.h"
+#include <algorithm>
+#include "levelOrder.h"
+
+namespace {
+
+constexpr int kGroupCards = HandSampler::kGroupCards;
+
+// 组内分法数：n 张不同的牌分成 k0、k1、n-k0-k1 张三份，即多项式系数 n!/(k0!k1!k2!)
+struct Multinomials {
+    double ways[kGroupCards + 1][kGroupCards + 1][kGroupCards + 1] = {};
+
+    Multinomials() {
+        double choose[kGroupCards + 1][kGroupCards + 1] = {};
+        for (int n = 0; n <= kGroupCards; ++n) {
+            choose[n][0] = 1.0;
+            for (int k = 1; k <= n; ++k) choose[n][k] = choose[n - 1][k - 1] + (k < n ? choose[n - 1][k] : 0.0);
+        }
+        for (int n = 0; n <= kGroupCards; ++n) {
+            for (int k0 = 0; k0 <= n; ++k0) {
+                for (int k1 = 0; k0 + k1 <= n; ++k1) ways[n][k0][k1] = choose[n][k0] * choose[n - k0][k1];
+            }
+        }
+    }
+};
+
+const Multinomials& multinomials() {
+    static const Multinomials table;
+    return table;
+}
+
+// 组内 n 张不同的牌分给三家、各拿 k0、k1、n-k0-k1 张的全部分法，每种分法每张牌 2 位记下归给第几家。
+// 同一 (n, k0, k1) 的分法连续存放，个数就是多项式系数；采样时一个随机数直接挑一种，不再逐张洗牌
+struct SplitCodes {
+    std::vector<uint16_t> codes;
+    uint16_t begin[kGroupCards + 1][kGroupCards + 1][kGroupCards + 1] = {};
+
+    SplitCodes() {
+        for (int n = 0; n <= kGroupCards; ++n) {
+            int total = 1;
+            for (int i = 0; i < n; ++i) total *= 3;
+            std::vector<std::vector<uint16_t>> buckets((kGroupCards + 1) * (kGroupCards + 1));
+            for (int digits = 0; digits < total; ++digits) {
+                uint16_t code = 0;
+                int k[3] = {};
+                for (int i = 0, rest = digits; i < n; ++i, rest /= 3) {
+                    code |= static_cast<uint16_t>(rest % 3) << (2 * i);
+                    ++k[rest % 3];
+                }
+                buckets[k[0] * (kGroupCards + 1) + k[1]].push_back(code);
+            }
+            for (int k0 = 0; k0 <= n; ++k0) {
+                for (int k1 = 0; k0 + k1 <= n; ++k1) {
+                    const auto& bucket = buckets[k0 * (kGroupCards + 1) + k1];
+                    begin[n][k0][k1] = static_cast<uint16_t>(codes.size());
+                    codes.insert(codes.end(), bucket.begin(), bucket.end());
+                }
+            }
+        }
+    }
+};
+
+const SplitCodes& splitCodes() {
+    static const SplitCodes table;
+    return table;
+}
+
+// 逻辑值到组号：2..A 为 0..12，非红桃级牌 13，小王 14，大王 15，万能牌 16；其余为 -1
+int groupOfValue(int value) {
+    if (value >= 2 && value <= 14) return value - 2;
+    if (value >= 18 && value <= HandSampler::kWildValue) return value - 5;
+    return -1;
+}
+
+int valueOfGroup(int group) {
+    return group <= 12 ? group + 2 : group + 5;
+}
+
+// 一次采样要几十个随机数：从调用方的发生器取一个种子，其余用 splitmix64 序列（每个数一次乘法、几次移位）
+struct SplitMix {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+// id 到牌的表，采样时不逐张调用 Card::fromId
+struct CardTable {
+    Card cards[Card::kIdCount];
+
+    CardTable() {
+        for (int id = 0; id < Card::kIdCount; ++id) cards[id] = Card::fromId(id);
+    }
+};
+
+const CardTable& cardTable() {
+    static const CardTable table;
+    return table;
+}
+
+} // namespace
+
+int HandSampler::groupOf(const Card& card) const {
+    const LevelOrder& order = levelOrder(levelRank_);
+    const int id = card.toId();
+    return order.isWild(id) ? kGroups - 1 : groupOfValue(order.logValue[id]);
+}
+
+bool HandSampler::takeFromPool(const Card& card) {
+    const int group = groupOf(card);
+    if (group < 0) return false;
+    const uint8_t id = static_cast<uint8_t>(card.toId());
+    auto& ids = pool_[group];
+    uint8_t& size = poolSize_[group];
+    for (int i = 0; i < size; ++i) {
+        if (ids[i] != id) continue;
+        ids[i] = ids[--size];
+        return true;
+    }
+    return false; // 这张牌已经没有看不到的了（两副牌各两张）
+}
+
+void HandSampler::reset(int self, const std::vector<Card>& own, int levelRank) {
+    self_ = self;
+    levelRank_ = levelRank;
+    consistent_ = true;
+    ready_ = false;
+    own_ = own;
+    for (int seat = 0, h = 0; seat < kSeats; ++seat) {
+        if (seat != self) hidden_[h++] = seat;
+    }
+    handCount_.fill(0);
+    handCount_[self] = static_cast<int>(own.size());
+    for (auto& known : known_) known.clear();
+    for (auto& caps : cap_) caps.fill(kGroupCards);
+
+    // 两副牌每个 id 各两张，先全部放进看不到的牌，再去掉自己的手牌
+    poolSize_.fill(0);
+    for (int id = 0; id < Card::kIdCount; ++id) {
+        const int group = groupOf(Card::fromId(id));
+        for (int copy = 0; copy < 2; ++copy) pool_[group][poolSize_[group]++] = static_cast<uint8_t>(id);
+    }
+    if (own.size() > static_cast<size_t>(kMaxHand)) consistent_ = false;
+    for (const Card& card : own) consistent_ = takeFromPool(card) && consistent_;
+}
+
+void HandSampler::cardsPlayed(std::span<const Card> cards) {
+    ready_ = false;
+    for (const Card& card : cards) consistent_ = takeFromPool(card) && consistent_;
+}
+
+void HandSampler::setHandCount(int seat, int count) {
+    if (seat < 0 || seat >= kSeats || seat == self_) return;
+    ready_ = false;
+    handCount_[seat] = count;
+}
+
+void HandSampler::cardKnown(int seat, const Card& card) {
+    if (seat < 0 || seat >= kSeats || seat == self_) return;
+    ready_ = false;
+    consistent_ = takeFromPool(card) && consistent_;
+    known_[seat].push_back(card);
+}
+
+void HandSampler::limitValue(int seat, int logValue, int maxCards) {
+    const int group = groupOfValue(logValue);
+    if (seat < 0 || seat >= kSeats || seat == self_ || group < 0) return;
+    ready_ = false;
+    cap_[seat][group] = std::min(cap_[seat][group], std::max(maxCards, 0));
+}
+
+void HandSampler::passedOn(int seat, const PlayInfo& play) {
+    int cards = 0;
+    if (play.type == HandType::Single) cards = 1;
+    else if (play.type == HandType::Pair) cards = 2;
+    else if (play.type == HandType::Trips) cards = 3;
+    if (cards == 0) return;
+    for (int group = 0; group < kGroups - 1; ++group) {
+        const int value = valueOfGroup(group);
+        if (value > play.primaryRank) limitValue(seat, value, cards - 1);
+    }
+}
+
+bool HandSampler::prepare() {
+    ready_ = false;
+    if (!consistent_) return false;
+
+    for (int h = 0; h < 3; ++h) {
+        const int seat = hidden_[h];
+        // sample() 把已知牌和抽到的牌一起写进 Deal::cards[seat]，总数就是 handCount，不能超过容量
+        if (handCount_[seat] < 0 || handCount_[seat] > kMaxHand) return false;
+        need_[h] = handCount_[seat] - static_cast<int>(known_[seat].size());
+        if (need_[h] < 0) return false;
+        // 已知在手里的牌也占该组的上限
+        std::array<int, kGroups> knownIn{};
+        for (const Card& card : known_[seat]) ++knownIn[groupOf(card)];
+        for (int g = 0; g < kGroups; ++g) {
+            const int room = cap_[seat][g] - knownIn[g];
+            if (room < 0) return false;
+            room_[h][g] = static_cast<uint8_t>(std::min(room, kGroupCards));
+        }
+    }
+    remaining_[kGroups] = 0;
+    for (int g = kGroups - 1; g >= 0; --g) remaining_[g] = remaining_[g + 1] + poolSize_[g];
+    if (need_[0] + need_[1] + need_[2] != remaining_[0]) return false;
+
+    // 第 g 组、前两家还差 a、b 张时，本组每种可行分法（前两家各拿 k0、k1 张）及其权重
+    // “本组这样分的分法数 × 之后一致发法数”，DP 与建采样表按同样的次序枚举
+    const Multinomials& table = multinomials();
+    const auto forEachSplit = [&](int g, int a, int b, auto&& visit) {
+        const int n = poolSize_[g];
+        const int c = remaining_[g] - a - b;
+        for (int k0 = 0; k0 <= std::min({n, a, static_cast<int>(room_[0][g])}); ++k0) {
+            for (int k1 = 0; k1 <= std::min({n - k0, b, static_cast<int>(room_[1][g])}); ++k1) {
+                const int k2 = n - k0 - k1;
+                if (k2 > room_[2][g] || k2 > c) continue;
+                const double w = table.ways[n][k0][k1] * ways_[g + 1][a - k0][b - k1];
+                if (w > 0.0) visit(k0, k1, w);
+            }
+        }
+    };
+
+    // ways_[g][a][b]：第 g 组起，前两家还差 a、b 张（第三家差的就是剩下的）时一致发法的总数
+    ways_.resize(kGroups + 1);
+    for (auto& layer : ways_) {
+        for (auto& row : layer) row.fill(0.0);
+    }
+    // 前 g 组一共只有 dealt 张牌，从起点出发走到第 g 组时前两家还差的张数不会少于 need - dealt，
+    // 更少的状态采样时走不到，不用算
+    ways_[kGroups][0][0] = 1.0;
+    for (int g = kGroups - 1; g >= 0; --g) {
+        const int dealt = remaining_[0] - remaining_[g];
+        for (int a = std::max(0, need_[0] - dealt); a <= std::min(need_[0], remaining_[g]); ++a) {
+            for (int b = std::max({0, need_[1] - dealt, need_[0] + need_[1] - dealt - a});
+                 b <= std::min(need_[1], remaining_[g] - a); ++b) {
+                double sum = 0.0;
+                forEachSplit(g, a, b, [&sum](int, int, double w) { sum += w; });
+                ways_[g][a][b] = sum;
+            }
+        }
+    }
+    ready_ = ways_[0][need_[0]][need_[1]] > 0.0;
+    if (!ready_) return false;
+
+    // 从起点正向走一遍，只给采样时可能走到的状态建累积概率表（整张 DP 表的状态大半走不到）；
+    // 空组只有一种分法，a、b 不变，不用建表。一个状态最多 kMaxSplits 种分法，每个状态前先留够位置，
+    // 循环里直接按下标写，不逐项 push_back
+    constexpr size_t kMaxSplits = (kGroupCards + 1) * (kGroupCards + 2) / 2;
+    size_t used = 0;
+    choiceRange_.assign(static_cast<size_t>(kGroups) * (need_[0] + 1) * (need_[1] + 1), ChoiceRange{});
+    std::array<std::array<bool, kMaxHand + 1>, kMaxHand + 1> reach{}, next{};
+    reach[need_[0]][need_[1]] = true;
+    for (int g = 0; g < kGroups; ++g) {
+        if (poolSize_[g] == 0) continue;
+        for (auto& row : next) row.fill(false);
+        for (int a = 0; a <= need_[0]; ++a) {
+            for (int b = 0; b <= need_[1]; ++b) {
+                if (!reach[a][b]) continue;
+                if (choiceThreshold_.size() < used + kMaxSplits) {
+                    choiceThreshold_.resize(std::max(choiceThreshold_.size() * 2, used + kMaxSplits));
+                    choiceTake_.resize(choiceThreshold_.size());
+                }
+                uint32_t* threshold = choiceThreshold_.data() + used;
+                uint8_t* take = choiceTake_.data() + used;
+                const double scale = 0x1.0p32 / ways_[g][a][b];
+                double sum = 0.0;
+                int count = 0;
+                forEachSplit(g, a, b, [&](int k0, int k1, double w) {
+                    sum += w;
+                    threshold[count] = static_cast<uint32_t>(std::min(sum * scale, 0x1.0p32 - 1.0));
+                    take[count] = static_cast<uint8_t>(k0 | (k1 << 4));
+                    ++count;
+                    next[a - k0][b - k1] = true;
+                });
+                choiceRange_[choiceIndex(g, a, b)] = {static_cast<uint32_t>(used), static_cast<uint32_t>(count)};
+                used += count;
+            }
+        }
+        reach = next;
+    }
+    return true;
+}
+
+void HandSampler::sample(std::mt19937_64& rng, Deal& out) const {
+    out.count.fill(0);
+    if (!ready_) return;
+    std::copy(own_.begin(), own_.end(), out.cards[self_].begin());
+    out.count[self_] = static_cast<uint8_t>(own_.size());
+    for (int h = 0; h < 3; ++h) {
+        const int seat = hidden_[h];
+        std::copy(known_[seat].begin(), known_[seat].end(), out.cards[seat].begin());
+        out.count[seat] = static_cast<uint8_t>(known_[seat].size());
+    }
+
+    const Multinomials& table = multinomials();
+    const SplitCodes& splits = splitCodes();
+    const CardTable& cards = cardTable();
+    SplitMix random{rng()};
+    int a = need_[0], b = need_[1];
+    for (int g = 0; g < kGroups; ++g) {
+        const int n = poolSize_[g];
+        if (n == 0) continue;
+        // 按 prepare 建好的累积概率表选本组前两家各拿几张；取整误差时落到最后一种可行分法
+        const ChoiceRange range = choiceRange_[choiceIndex(g, a, b)];
+        const uint32_t* threshold = choiceThreshold_.data() + range.begin;
+        // 一个 64 位随机数：高 32 位选各家张数，低 32 位选组内分法
+        const uint64_t bits = random.next();
+        const uint32_t target = static_cast<uint32_t>(bits >> 32);
+        uint32_t pick = 0;
+        while (pick + 1 < range.count && !(target < threshold[pick])) ++pick;
+        const int take0 = choiceTake_[range.begin + pick] & 0x0F;
+        const int take1 = choiceTake_[range.begin + pick] >> 4;
+
+        // 组内在这样分的全部分法里均匀挑一种（分法数不超过 560，乘法取高位的偏差可以忽略）
+        const uint64_t count = static_cast<uint64_t>(table.ways[n][take0][take1]);
+        const uint16_t code = splits.codes[splits.begin[n][take0][take1] + (((bits & 0xFFFFFFFFu) * count) >> 32)];
+        const auto& ids = pool_[g];
+        for (int i = 0; i < n; ++i) {
+            const int seat = hidden_[(code >> (2 * i)) & 3];
+            out.cards[seat][out.count[seat]++] = cards.cards[ids[i]];
+        }
+        a -= take0;
+        b -= take1;
+    }
+}
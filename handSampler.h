@@ -0,0 +1,93 @@
+#ifndef HANDSAMPLER_H
+#define HANDSAMPLER_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+#include "card.h"
+#include "handmatcher.h"
+
+// 不完全信息搜索用的对手手牌采样：把自己看不到的牌分给其余三家，满足各家剩余张数、已打出的牌、
+// 进贡/还贡亮出的牌（已知在谁手里）以及“某家某种点数最多几张”之类的推断。
+// 牌按逻辑值分组（2..A、非红桃级牌、小王、大王、万能牌，共 kGroups 组），prepare 时做一次计数 DP：
+// 从第 g 组起、前两家还差 a、b 张时一致发法的总数（把两副牌的 108 张都看成不同的牌，组内每种分法乘多项式系数）。
+// 采样时逐组按这个总数的比例决定各家拿几张，再在组内随机分给各家，每次都直接得到一致的发法，
+// 在所有一致发法上均匀，不做拒绝重抽。各组的比例在 prepare 时存成累积概率表，组内分法也预先列好，
+// sample 每组只查表、取一个随机数。
+// prepare 之后 sample 只读，可以多线程各用各的随机数发生器共用一个。
+class HandSampler {
+public:
+    static constexpr int kSeats = 4;
+    static constexpr int kMaxHand = 32;  // 一手牌最多 27 张，收贡后再多 1 张
+    static constexpr int kGroups = 17;
+    static constexpr int kWildValue = 21; // limitValue 里万能牌的逻辑值
+    static constexpr int kGroupCards = 8; // 一组最多 8 张（两副牌四种花色）
+
+    struct Deal {
+        std::array<std::array<Card, kMaxHand>, kSeats> cards;
+        std::array<uint8_t, kSeats> count{};
+
+        std::span<const Card> hand(int seat) const { return {cards[seat].data(), count[seat]}; }
+    };
+
+    // 以 self 的视角重新开始：own 为自己的手牌，levelRank 决定哪些是万能牌、哪些归入级牌一组
+    void reset(int self, const std::vector<Card>& own, int levelRank);
+    // 已经打出（不论谁出）的牌
+    void cardsPlayed(std::span<const Card> cards);
+    // seat 手里还剩 count 张
+    void setHandCount(int seat, int count);
+    // 已知 card 在 seat 手里（进贡/还贡亮出、之后还没打出的牌）
+    void cardKnown(int seat, const Card& card);
+    // 推断：seat 手里逻辑值为 logValue（LevelOrder::logValue，万能牌为 kWildValue）的牌最多 maxCards 张
+    void limitValue(int seat, int logValue, int maxCards);
+    // 推断：seat 对 play 选择了过。单张、对子、三张时认为它没有同样张数、点数更大的牌，
+    // 即比 play 大的每种点数都少于 play 的张数；不考虑万能牌凑数和留着不用的炸弹，只是近似
+    void passedOn(int seat, const PlayInfo& play);
+
+    // 按当前约束建表；约束互相矛盾（没有一致的发法）时返回 false，此后不能 sample
+    bool prepare();
+    // 一致发法的总数（按实物牌计），prepare 成功后有效
+    double consistentDeals() const { return ready_ ? ways_[0][need_[0]][need_[1]] : 0.0; }
+    // 采样一次：自己的座位是自己的手牌，其余三家是一种一致的发法（已知在手里的牌排在最前）
+    void sample(std::mt19937_64& rng, Deal& out) const;
+
+private:
+    int groupOf(const Card& card) const;
+    bool takeFromPool(const Card& card);
+
+    int self_ = 0;
+    int levelRank_ = 0;
+    bool consistent_ = true;
+    bool ready_ = false;
+    std::vector<Card> own_;
+    std::array<int, 3> hidden_{};                // 其余三家的座位
+    std::array<int, kSeats> handCount_{};
+    std::array<std::vector<Card>, kSeats> known_;
+    std::array<std::array<int, kGroups>, kSeats> cap_{};
+    // 看不到的牌，按组存放 id
+    std::array<std::array<uint8_t, kGroupCards>, kGroups> pool_{};
+    std::array<uint8_t, kGroups> poolSize_{};
+
+    // prepare 的结果：各家还差的张数、各家在每组最多还能拿几张，以及 DP 表
+    std::array<int, 3> need_{};
+    std::array<std::array<uint8_t, kGroups>, 3> room_{};
+    std::array<int, kGroups + 1> remaining_{};   // 第 g 组起看不到的牌总数
+    std::vector<std::array<std::array<double, kMaxHand + 1>, kMaxHand + 1>> ways_;
+
+    // 采样表：从起点出发能走到的每个 (g, a, b)，本组各种可行分法（前两家各拿几张）的累积概率，
+    // 概率为“本组这样分的分法数 × 之后一致发法数 / ways_[g][a][b]”，乘 2^32 取整后与 32 位随机数比较；
+    // take 低 4 位是前一家拿的张数，高 4 位是第二家的
+    struct ChoiceRange {
+        uint32_t begin = 0;
+        uint32_t count = 0;
+    };
+    // 按 (g, a, b) 编号，a、b 不超过各自还差的张数
+    int choiceIndex(int g, int a, int b) const { return (g * (need_[0] + 1) + a) * (need_[1] + 1) + b; }
+    std::vector<uint32_t> choiceThreshold_;
+    std::vector<uint8_t> choiceTake_;
+    std::vector<ChoiceRange> choiceRange_;
+};
+
+#endif // HANDSAMPLER_H
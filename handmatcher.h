@@ -1,10 +1,12 @@
 #ifndef HANDMATCHER_H
 #define HANDMATCHER_H
 
+#include <cstdint>
 #include <vector>
 #include <map>
 #include <algorithm>
 #include "card.h" // 确保你的项目中包含了 card.h
+#include "levelOrder.h"
 
 // 牌型定义
 enum class HandType {
@@ -15,6 +17,7 @@ enum class HandType {
     TripsWithPair,  // 三带二 (Full House)
     TriplePairs,    // 三连对 (334455)
     SteelPlate,     // 钢板 (333444)
+    Straight,       // 顺子 (5张连续，花色不限)
     Bomb,           // 炸弹 (4张及以上)
     StraightFlush,  // 同花顺 (5张同花且连续)
     TianWang        // 天王炸 (4张王)
@@ -28,6 +31,73 @@ struct PlayInfo {
     bool isStraightFlush = false; // 是否同花顺标记
 };
 
+// 顺子位运算：点数集合用 14 位掩码表示，第 v-1 位对应序列值 v（2..14），
+// A 同时占第 0 位（当 1 用，A2345）和第 13 位（10JQKA）。
+// 以 seqValue 顶张的五张窗口即第 (seqValue-5) 到 (seqValue-1) 位。
+constexpr uint32_t straightBit(int seqValue) {
+    return seqValue == 14 ? ((1u << 13) | 1u) : (1u << (seqValue - 1));
+}
+
+// 位切片计数器：每个位置独立累计被加进来的掩码次数（0..7），
+// 一次 add 相当于给 32 个窗口同时加一，比较也对所有窗口一起做。
+struct WindowCounter {
+    uint32_t b0 = 0, b1 = 0, b2 = 0;
+
+    constexpr void add(uint32_t m) {
+        const uint32_t carry0 = b0 & m;
+        b0 ^= m;
+        const uint32_t carry1 = b1 & carry0;
+        b1 ^= carry0;
+        b2 |= carry1;
+    }
+    // 计数不超过 n 的位置
+    constexpr uint32_t atMost(int n) const {
+        if (n >= 7) return ~0u;
+        if (n < 0) return 0;
+        const uint32_t bits[3] = {b0, b1, b2};
+        uint32_t less = 0, equal = ~0u;
+        for (int i = 2; i >= 0; --i) {
+            if ((n >> i) & 1) {
+                less |= equal & ~bits[i];
+                equal &= bits[i];
+            } else {
+                equal &= ~bits[i];
+            }
+        }
+        return less | equal;
+    }
+};
+
+// 返回 10 位掩码：第 i 位表示顶张为 i+5 的窗口在 rankMask 中最多缺 maxHoles 张。
+// 五个移位后的缺口掩码逐位累加，10 个窗口一次算完，没有循环查找。
+constexpr uint32_t straightWindows(uint32_t rankMask, int maxHoles) {
+    WindowCounter holes;
+    for (int k = 0; k < 5; ++k) holes.add(~rankMask >> k);
+    return holes.atMost(maxHoles) & 0x3FFu;
+}
+
+// 连续元组（三连对、钢板）位运算：atLeast[k] 的第 v 位表示逻辑值 v 至少有 k 张（k = 1..4）。
+// 返回的第 s 位表示从逻辑值 s 起 len 个连续点数、每个补足 width 张，最多需要 maxHoles 张万能牌。
+// 每个点数的缺口是 width - min(张数, width)，即 ~atLeast[1..width] 中为 1 的个数。
+constexpr uint32_t tupleWindows(const uint32_t atLeast[5], int width, int len, int maxHoles) {
+    WindowCounter holes;
+    for (int k = 0; k < len; ++k) {
+        for (int j = 1; j <= width; ++j) holes.add(~atLeast[j] >> k);
+    }
+    // 起点在 2..(20 - len + 1)：逻辑值最小为 2，最大为大王 20
+    const uint32_t starts = ((1u << (22 - len)) - 1) & ~3u;
+    return holes.atMost(maxHoles) & starts;
+}
+
+// 按每个逻辑值的张数填 atLeast[1..4]（atLeast[0] 为全 1）
+inline void fillAtLeastMasks(const int counts[21], uint32_t atLeast[5]) {
+    atLeast[0] = ~0u;
+    for (int k = 1; k < 5; ++k) atLeast[k] = 0;
+    for (int v = 0; v < 21; ++v) {
+        for (int k = 1; k <= counts[v] && k < 5; ++k) atLeast[k] |= 1u << v;
+    }
+}
+
 class HandMatcher {
 public:
     // 构造函数：传入待分析的牌和当前级牌点数
@@ -40,13 +110,19 @@ private:
     std::vector<Card> allCards; // 保存所有牌，便于做花色等整体校验
     std::vector<Card> solids;   // 固定牌（除去万能牌后的牌）
     int wildCount;            // 万能牌（红桃级牌）数量
-    int levelRank;            // 当前级牌点数（如打2，则levelRank=15）
+    int levelRank;            // 当前级牌点数（2..14）
     int totalCount;           // 牌总数
+    const LevelOrder& order;  // 按级牌选好的次序表
+
+    // 拆出万能牌并按逻辑值排序固定牌；Level 为编译期级牌，见 withLevelRank
+    template <int Level>
+    void splitCards(const std::vector<Card>& cards);
 
     // --- 内部匹配函数 ---
     PlayInfo matchTianWang();       // 天王炸
     PlayInfo matchBomb();           // 炸弹
     PlayInfo matchStraightFlush();  // 同花顺
+    PlayInfo matchStraight();       // 顺子
     PlayInfo matchSteelPlate();     // 钢板 (333444)
     PlayInfo matchTriplePairs();    // 三连对 (334455)
     PlayInfo matchTripsWithPair();  // 三带二
@@ -61,7 +137,9 @@ private:
     bool isWild(const Card& c) const;
     // 获取固定牌的逻辑值计数
     std::map<int, int> getLogCounts() const;
-    // 检查顺子逻辑（返回顺子顶张，否则返回0）
+    // 固定牌“至少 k 张”的逻辑值掩码（k = 1..4），见 tupleWindows
+    void getLogAtLeastMasks(uint32_t atLeast[5]) const;
+    // 检查顺子逻辑（返回顺子顶张，否则返回0），基于 straightWindows
     int checkStraightRank() const;
     // 通用连续元组匹配 (用于钢板、三连对)
     PlayInfo matchConsecutiveTuples(int tupleCount, int tupleSize, HandType type);
@@ -1,35 +1,15 @@
 #include "Judge.h"
-#include <QTime>
 #include <QTimer>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <set>
 #include "card.h"
+#include "levelOrder.h"
 #include "player.h"
 
-// 级牌、红桃级牌相关辅助：掼蛋顺序 2 < 3 < ... < A < 级牌 < 小王 < 大王
-static int logicalRank(const Card& c) {
-    switch (c.getRank()) {
-    case Rank::Two:   return 2;
-    case Rank::Three: return 3;
-    case Rank::Four:  return 4;
-    case Rank::Five:  return 5;
-    case Rank::Six:   return 6;
-    case Rank::Seven: return 7;
-    case Rank::Eight: return 8;
-    case Rank::Nine:  return 9;
-    case Rank::Ten:   return 10;
-    case Rank::Jack:  return 11;
-    case Rank::Queen: return 12;
-    case Rank::King:  return 13;
-    case Rank::Ace:   return 14;
-    case Rank::S:     return 15; // 小王
-    case Rank::B:     return 16; // 大王
-    default: return 0;
-    }
-}
-
 int Judge::getPlayerHandCount(int playerId) const {
     if (playerId < 0 || playerId >= static_cast<int>(players.size())) return 0;
     return static_cast<int>(players[playerId]->getCardCount());
@@ -69,10 +49,13 @@ std::vector<int> Judge::getPreviousPlacements() const {
     return previousPlacements;
 }
 void Judge::resetForNewHand() {
+    cancelFlow();
+    ++botMoveSerial;
+    machine.fire(TableEvent::NewHand);
+    eventQueue.clear();
     finishOrder.clear();
     lastCards.clear();
     lastPlayer = -1;
-    lastWasPass = false;
     if (!players.empty()) {
         playerLastPlays.assign(players.size(), {});
         playerPassedRound.assign(players.size(), false);
@@ -88,10 +71,13 @@ void Judge::setCurrentTurn(int turn) {
     }
 
     currentTurn = turn;
+    // 刚发完牌时直接指定先手，视为跳过进贡开始打牌（回放、调试）
+    if (machine.state() == TableState::Dealt) machine.fire(TableEvent::BeginPlay);
     qDebug() << "Judge::setCurrentTurn -> 当前轮到玩家:" << currentTurn;
 
     // 通知外部更新UI
     emit turnChanged();
+    markChanged(ChangeTurn);
 }
 void Judge::beginFirstTurn() {
     if (currentTurn < 0) {
@@ -103,14 +89,10 @@ void Judge::beginFirstTurn() {
 
     // 通知GameManager或UI更新轮次显示
     emit turnChanged();
+    markChanged(ChangeTurn);
 
-    // 如果是AI玩家（假设0是人类，1/2/3是AI）
-    if (currentTurn != 0) {
-        aiPlay();
-    } else {
-        // 通知UI：人类玩家可以出牌
-        emit playerTurnStart(currentTurn);
-    }
+    // AI 座位直接出牌；人类或远程座位等待操作
+    promptSeat(currentTurn, 0);
 }
 
 static bool canBeat(const std::vector<Card>& current, const std::vector<Card>& last, int levelRank) {
@@ -170,6 +152,7 @@ static bool canBeat(const std::vector<Card>& current, const std::vector<Card>& l
     case HandType::TripsWithPair:
     case HandType::TriplePairs:
     case HandType::SteelPlate:
+    case HandType::Straight:
         return currentInfo.size == lastInfo.size && currentInfo.primaryRank > lastInfo.primaryRank;
     default:
         return false;
@@ -181,18 +164,12 @@ Judge::Judge(QObject *parent)
     : QObject(parent)
     , currentTurn(0)
     , lastPlayer(-1)
-    , lastWasPass(false)
 {   playerLastPlays.assign(4, std::vector<Card>());
      playerPassedRound.assign(4, false);
-    // 初始化随机数生成器（用于 AI 出牌）
-    std::random_device rd;
-    if (rd.entropy() > 0) {
-        rng.seed(rd());
-    } else {
-        // 若 random_device 不可用，用时间种子
-        rng.seed(QTime::currentTime().msec());
-    }
+}
 
+Judge::~Judge() {
+    cancelFlow();
 }
 
 
@@ -206,16 +183,29 @@ int Judge::teammateOf(int playerId) const {
     return (playerId + 2) % static_cast<int>(players.size());
 }
 bool Judge::playHumanCard(const std::vector<Card>& playCards) {
-    if (finishOrder.size()==4) return false;
+    if (machine.state() == TableState::HandOver) return false;
     if (currentTurn != 0) {
         emit gameFinished();
         return false;
     }
+    return playSeatCards(0, playCards);
+}
+
+bool Judge::playSeatCards(int seat, const std::vector<Card>& playCards) {
+    SeatEvent event;
+    event.action = SeatAction::Play;
+    event.seat = seat;
+    event.cards = playCards;
+    return apply(event);
+}
 
-    std::vector<Card> humanHand = players[0]->getHandCopy();
+bool Judge::handlePlay(int seat, const std::vector<Card>& playCards) {
+    if (seat != currentTurn || playCards.empty()) return false;
+
+    std::vector<Card> seatHand = players[seat]->getHandCopy();
     for (const auto& card : playCards) {
-         auto it = std::find(humanHand.begin(), humanHand.end(), card);
-        if (it == humanHand.end()) {
+         auto it = std::find(seatHand.begin(), seatHand.end(), card);
+        if (it == seatHand.end()) {
             qWarning() << "出牌错误：玩家不拥有该牌" << QString::fromStdString(card.toString());
             return false;
         }
@@ -231,22 +221,24 @@ bool Judge::playHumanCard(const std::vector<Card>& playCards) {
         return false;
     }
 
-    players[0]->playCards(playCards);
+    players[seat]->playCards(playCards);
 
-    lastPlayer = 0;
+    lastPlayer = seat;
     lastCards = playCards;
-    lastWasPass = false;
-    playerLastPlays[0] = playCards;
-     playerPassedRound[0] = false;
-    emit playerHandChanged(0);
-    emit lastPlayUpdated(0);
-    int remain = players[0]->getCardCount();
+    playerLastPlays[seat] = playCards;
+     playerPassedRound[seat] = false;
+    emit playerHandChanged(seat);
+    emit lastPlayUpdated(seat);
+    markChanged(ChangeHands | ChangeLastPlay, seat);
+    int remain = players[seat]->getCardCount();
     if (remain > 0 && remain <= 10) {
-        emit playerReported(0, remain);
+        emit playerReported(seat, remain);
+        pendingDelta.reportedRemain[seat] = remain;
+        markChanged(ChangeReport, seat);
     }
 
     // 5. 检查是否获胜
-    checkVictory(0);
+    checkVictory(seat);
 
     // 6. 切换到下一轮
     nextTurn();
@@ -254,15 +246,15 @@ bool Judge::playHumanCard(const std::vector<Card>& playCards) {
 }
 void Judge::playAICards(int aiId, const std::vector<Card>& aiChosen)
 {
-    if (finishOrder.size() == 4) return;
+    if (!machine.allows(SeatAction::Play)) return;
 
     // 1. AI Pass 的处理
     if (aiChosen.empty()) {
         qInfo() << "AI" << aiId << "选择过牌";
-        lastWasPass = true;
         playerPassedRound[aiId] = true;
         playerLastPlays[aiId].clear(); // 清空上次出的牌（显示为过）
         emit lastPlayUpdated(aiId);
+        markChanged(ChangeLastPlay, aiId);
 
         nextTurn();
         return;
@@ -274,6 +266,7 @@ void Judge::playAICards(int aiId, const std::vector<Card>& aiChosen)
         playerPassedRound[aiId] = true;
         playerLastPlays[aiId].clear();
         emit lastPlayUpdated(aiId);
+        markChanged(ChangeLastPlay, aiId);
         nextTurn();
         return;
     }
@@ -286,37 +279,49 @@ void Judge::playAICards(int aiId, const std::vector<Card>& aiChosen)
     // 【重要】：有人出牌了，这才是 lastPlayer 易主的时候
     lastPlayer = aiId;
     lastCards = aiChosen;
-    lastWasPass = false;
     playerPassedRound[aiId] = false;
 
     // 更新记录和 UI
     playerLastPlays[aiId] = lastCards;
     emit lastPlayUpdated(aiId);
     emit playerHandChanged(aiId);
+    markChanged(ChangeHands | ChangeLastPlay, aiId);
     int remain = players[aiId]->getCardCount();
     if (remain > 0 && remain <= 10) {
         emit playerReported(aiId, remain);
+        pendingDelta.reportedRemain[aiId] = remain;
+        markChanged(ChangeReport, aiId);
     }
     // 4. 检查如果游戏还没结束，继续下一轮
-    if (finishOrder.size() < players.size()) {
+    if (machine.state() == TableState::Playing) {
         checkVictory(aiId);
 
         nextTurn();
     }
 }
 void Judge::humanPass() {
-    if (finishOrder.size() == 4) return;
-    if (currentTurn != 0) return;
+    passSeat(0);
+}
+
+bool Judge::passSeat(int seat) {
+    SeatEvent event;
+    event.action = SeatAction::Pass;
+    event.seat = seat;
+    return apply(event);
+}
+
+bool Judge::handlePass(int seat) {
+    if (seat != currentTurn) return false;
     // if (lastCards.empty()) {
     //     qWarning() << "当前由你出牌，不能跳过！";
     //     return; // 这里可以加个信号通知 UI 弹窗提示
     // }
 
-    qInfo() << "人类玩家选择过";
-    lastWasPass = true;
-    playerPassedRound[0] = true;
-    playerLastPlays[0].clear();
-    emit lastPlayUpdated(0);
+    qInfo() << "玩家" << seat << "选择过";
+    playerPassedRound[seat] = true;
+    playerLastPlays[seat].clear();
+    emit lastPlayUpdated(seat);
+    markChanged(ChangeLastPlay, seat);
     // 【重要修改】：不要更新 lastPlayer！
     // lastPlayer = 0;  <-- 删掉这行
 
@@ -326,6 +331,7 @@ void Judge::humanPass() {
 
     // 切换到下一轮
     nextTurn();
+    return true;
 }
 
 // 获取最后出牌的字符串描述
@@ -344,6 +350,9 @@ QString Judge::lastPlayString() const {
 // judge.cpp
 
 void Judge::nextTurn() {
+    // 本局已在出牌过程中结算，不再轮转
+    if (machine.state() != TableState::Playing) return;
+    ++botMoveSerial; // 轮次变了，还没回来的 AI 决策作废
     int next = advanceTurnIndex(currentTurn);
     if (next < 0) {
         finalizeGame();
@@ -378,43 +387,59 @@ void Judge::nextTurn() {
     }
 
     emit turnChanged();
+    markChanged(ChangeTurn);
 
-    if (currentTurn != 0) {
-        QTimer::singleShot(800, this, &Judge::aiPlay);
-    } else {
-        emit playerTurnStart(0);
-    }
+    promptSeat(currentTurn, 800);
 }
 
 // AI 玩家出牌逻辑（简单实现：优先压制，无牌可出则pass）
 void Judge::aiPlay() {
-    if (finishOrder.size()==4) return;
+    if (machine.state() != TableState::Playing) return;
+
+    // 定时器触发前该座位已被远程客户端接管，改为等待客户端操作
+    if (remoteSeats[currentTurn]) { emit playerTurnStart(currentTurn); return; }
 
     AIPlayer* ai = dynamic_cast<AIPlayer*>(players[currentTurn]);
     if (!ai) { nextTurn(); return; }
 
-    std::vector<Card> chosen = ai->decideToMove(lastCards, getCurrentLevelRank());
+    if (moveDecider) {
+        // 异步决策：结果回来时局面可能已经变了（新一局、恢复、又一次请求），按编号和轮次核对
+        const int seat = currentTurn;
+        const unsigned serial = ++botMoveSerial;
+        moveDecider->requestMove(ai, lastCards, getCurrentLevelRank(), [this, seat, serial](std::vector<Card> chosen) {
+            if (serial != botMoveSerial || machine.state() != TableState::Playing || currentTurn != seat) return;
+            if (remoteSeats[seat]) { emit playerTurnStart(seat); return; }
+            applyBotMove(seat, chosen);
+        });
+        return;
+    }
+    applyBotMove(currentTurn, ai->decideToMove(lastCards, getCurrentLevelRank()));
+}
+
+void Judge::applyBotMove(int seat, const std::vector<Card>& chosen) {
     if (chosen.empty()) {
         // pass
-         qInfo() << "AI" << currentTurn << "选择过牌";
-        lastWasPass = true;
-        playerPassedRound[currentTurn] = true;
-         playerLastPlays[currentTurn].clear();
-        emit lastPlayUpdated(currentTurn);
+         qInfo() << "AI" << seat << "选择过牌";
+        playerPassedRound[seat] = true;
+         playerLastPlays[seat].clear();
+        emit lastPlayUpdated(seat);
+        markChanged(ChangeLastPlay, seat);
     } else {
-        qInfo() << "AI" << currentTurn << "出牌:" << chosen.size() << "张";
-        players[currentTurn]->playCards(chosen);
-        checkVictory(currentTurn);
-        lastPlayer = currentTurn;
+        qInfo() << "AI" << seat << "出牌:" << chosen.size() << "张";
+        players[seat]->playCards(chosen);
+        checkVictory(seat);
+        lastPlayer = seat;
         lastCards = chosen;
-        lastWasPass = false;
-        playerPassedRound[currentTurn] = false;
-        emit playerHandChanged(currentTurn);
-        playerLastPlays[currentTurn] = chosen;
-        emit lastPlayUpdated(currentTurn);
-        int remain = players[currentTurn]->getCardCount();
+        playerPassedRound[seat] = false;
+        emit playerHandChanged(seat);
+        playerLastPlays[seat] = chosen;
+        emit lastPlayUpdated(seat);
+        markChanged(ChangeHands | ChangeLastPlay, seat);
+        int remain = players[seat]->getCardCount();
         if (remain > 0 && remain <= 10) {
-            emit playerReported(currentTurn, remain);
+            emit playerReported(seat, remain);
+            pendingDelta.reportedRemain[seat] = remain;
+            markChanged(ChangeReport, seat);
         }
 
     }
@@ -452,6 +477,7 @@ void Judge::startNewRound(int leaderId) {
     currentTurn = leaderId;
     // 通知 UI 清空桌面
     emit tableCleared();
+    markChanged(ChangeTable);
 }
 std::vector<Card> Judge::getPlayerLastPlay(int playerId) const {
     if (playerId < 0 || playerId >= static_cast<int>(playerLastPlays.size()))
@@ -465,6 +491,8 @@ void Judge::checkVictory(int playerId) {
             int place = static_cast<int>(finishOrder.size()); // 1,2,3,4
             qInfo() << "玩家" << playerId << "完成, 排名:" << place;
             emit playerFinished(playerId, place);
+            pendingDelta.finishedPlace[playerId] = place;
+            markChanged(ChangeFinish, playerId);
         }
     }
     if (!players.empty() && static_cast<int>(finishOrder.size()) == static_cast<int>(players.size()) - 1) {
@@ -473,6 +501,8 @@ void Judge::checkVictory(int playerId) {
 }
 
 void Judge::finalizeGame() {
+    // 只有打牌中才能结算，重复结算在这里被状态机拒绝
+    if (!machine.fire(TableEvent::HandFinished)) return;
     if (players.size() > finishOrder.size()) {
         for (int i = 0; i < static_cast<int>(players.size()); ++i) {
             if (std::find(finishOrder.begin(), finishOrder.end(), i) == finishOrder.end()) {
@@ -481,7 +511,6 @@ void Judge::finalizeGame() {
         }
     }
     previousPlacements = finishOrder;
-    tributePending = true;
 
     if (!finishOrder.empty()) {
         int headTeam = finishOrder.front() % 2;
@@ -493,7 +522,8 @@ void Judge::finalizeGame() {
         } else if (!finishOrder.empty() && finishOrder.back() % 2 == headTeam) {
             delta = 1;
         }
-        teamLevels[headTeam] = teamLevels[headTeam] + delta;
+        // 级别到 A 为止（整场结束），不会再往上加，检查点里的级别因此总在 2..14
+        teamLevels[headTeam] = std::min(teamLevels[headTeam] + delta, 14);
         qInfo() << "队伍" << headTeam << "升级" << delta << "级，当前级别:" << teamLevels[headTeam];
         if (teamLevels[headTeam] >= 14) {
             emit matchFinished(headTeam); // 达到A，整场比赛结束
@@ -513,6 +543,7 @@ void Judge::debugDirectWin(int playerId) {
 
     // 2. 通知 UI 更新手牌显示（变为空）
     emit playerHandChanged(playerId);
+    markChanged(ChangeHands, playerId);
 
     // 3. 触发胜利检查（这会将玩家加入 finishOrder 并触发 playerFinished 信号）
     checkVictory(playerId);
@@ -532,21 +563,9 @@ void Judge::resetGameLevels() {
     teamLevels = {2, 2}; // 双方重置为打2
 }
 bool isCardSmaller(const Card& a, const Card& b, int levelRank) {
-    auto getVal = [levelRank](const Card& c) {
-        if (c.getRank() == Rank::B) return 200; // 大王
-        if (c.getRank() == Rank::S) return 190; // 小王
-        int r = c.getRankInt();
-        if (r == levelRank) {
-            // 级牌：红桃 > 其他
-            return (c.getSuit() == Suit::Hearts) ? 180 : 170;
-        }
-        return r * 10; // 普通牌
-    };
-    int va = getVal(a);
-    int vb = getVal(b);
-    if (va != vb) return va < vb;
-    // 同点数比花色
-    return static_cast<int>(a.getSuit()) < static_cast<int>(b.getSuit());
+    // 次序键已含“级牌：红桃 > 其他”以及同点数比花色
+    const LevelOrder& order = levelOrder(levelRank);
+    return order.orderKey[a.toId()] < order.orderKey[b.toId()];
 }
 bool isDoubleWinScenario(const std::vector<int>& placements, int totalPlayers) {
     if (placements.size() != 4) return false;
@@ -558,7 +577,7 @@ bool isDoubleWinScenario(const std::vector<int>& placements, int totalPlayers) {
 }
 void Judge::debugSetLevel(int teamId, int level) {
     if (teamId >= 0 && teamId < static_cast<int>(teamLevels.size())) {
-        teamLevels[teamId] = level;
+        teamLevels[teamId] = std::clamp(level, 2, 14);
         qDebug() << "调试：已将队伍" << teamId << "等级强制设为" << level;
     }
 }
@@ -568,7 +587,9 @@ void Judge::debugSimulateGameEnd(const std::vector<int>& manualOrder) {
         return;
     }
 
-    // 1. 强制覆盖完赛顺序
+    // 1. 强制覆盖完赛顺序（无论当前处于哪个阶段，都按打牌中结算）
+    cancelFlow();
+    machine.reset(TableState::Playing);
     finishOrder = manualOrder;
 
     // 2. 清空所有玩家手牌（模拟打完了）
@@ -577,9 +598,11 @@ void Judge::debugSimulateGameEnd(const std::vector<int>& manualOrder) {
         p->clearHand();
         emit playerHandChanged(p->getID());
     }
+    markChanged(ChangeHands);
 
     // 3. 强制通知 UI 清空桌面
     emit tableCleared();
+    markChanged(ChangeTable);
 
     // 4. 调用核心结算逻辑
     // 这会计算双下/双上，更新 teamLevels，并发出 gameFinished 或 matchFinished 信号
@@ -588,10 +611,14 @@ void Judge::debugSimulateGameEnd(const std::vector<int>& manualOrder) {
     qDebug() << "调试：已强制按顺序结算 -> " << manualOrder;
 }
 void Judge::startTributePhase() {
+    cancelFlow(); // 上一局残留的流程（例如调试时强制结算）直接作废
     tributeList.clear();
     doubleTributeStaging.clear();
-    isResolvingDoubleTribute = false;
-    gamePhase = GamePhase::Tribute;
+    // 进贡只能紧接在发牌之后开始
+    if (machine.state() != TableState::Dealt) {
+        qWarning() << "Judge::startTributePhase -> 当前阶段不能开始进贡";
+        return;
+    }
 
     if (previousPlacements.size() != 4) {
         finishTributePhase();
@@ -599,7 +626,6 @@ void Judge::startTributePhase() {
     }
 
     int p1 = previousPlacements[0]; // 头游
-    int p2 = previousPlacements[1]; // 二游
     // 注意：previousPlacements是按完成顺序排的，所以back是末游
     int p3 = previousPlacements[2]; // 三游
     int p4 = previousPlacements[3]; // 末游
@@ -624,24 +650,7 @@ void Judge::startTributePhase() {
         }
 
         // 2. 进入比牌阶段（暂不确定谁给谁，先让两人选牌）
-        isResolvingDoubleTribute = true;
-
-        // 向 P3 和 P4 发起选牌请求
-        // 如果是人类，通过信号通知；如果是AI，设置定时器
-        auto requestCard = [&](int pid) {
-            if (pid == 0) {
-                emit askForTribute(pid, false); // Human
-            } else {
-                QTimer::singleShot(1000 + pid * 200, this, [this, pid]() {
-                    Card c = findLargestCardForTribute(pid);
-                    submitTribute(pid, c);
-                });
-            }
-        };
-
-        requestCard(p3);
-        requestCard(p4);
-
+        machine.fire(TableEvent::BeginDoubleTribute);
         qInfo() << "进入双贡比牌阶段，等待玩家" << p3 << "和" << p4 << "选牌";
     }
     else {
@@ -661,149 +670,163 @@ void Judge::startTributePhase() {
 
         // 2. 生成任务：末游 -> 头游
         tributeList.push_back({loser, p1, {}, true, false});
-        executeNextTributeStep(); // 开始执行
+        machine.fire(TableEvent::BeginTribute);
     }
+    tributeFlow();
 }
-void Judge::executeNextTributeStep() {
-    // 遍历任务列表，找到第一个未完成的任务
-    // 顺序：先处理所有进贡，再处理所有还贡
 
-    // PHASE 1: 进贡
-    if (gamePhase == GamePhase::Tribute) {
-        bool allDone = true;
+FlowTask Judge::tributeFlow() {
+    // 流程只依赖 Judge 的成员状态，检查点恢复后从同一个入口重新进入即可接着走
+    // 被新的一局作废时 cancelFlow() 直接销毁挂起的帧，co_await 之后不会再回到这里
+
+    // 1. 双贡比牌：两人同时选牌，都选好后决定谁进贡给谁
+    if (machine.state() == TableState::DoubleTributeSelect && previousPlacements.size() == 4) {
+        const int p3 = previousPlacements[2];
+        const int p4 = previousPlacements[3];
+        for (int pid : {p3, p4}) {
+            if (!doubleTributeStaging.count(pid)) requestTribute(pid, false, 1000 + pid * 200);
+        }
+        while (!doubleTributeStaging.count(p3) || !doubleTributeStaging.count(p4)) {
+            co_await FlowAwait{this, FlowWait::Decision};
+        }
+        resolveDoubleTributeMatch();
+    }
+
+    // 2. 进贡：逐个等待选牌，全部选好后一起移动
+    if (machine.state() == TableState::Tribute) {
         for (auto& trans : tributeList) {
-            if (trans.active && !trans.cardSelected) {
-                allDone = false;
-
-                // 请求该玩家进贡
-                if (trans.payer == 0) { // 人类
-                    emit askForTribute(trans.payer, false); // false = 进贡
-                } else {
-                    // AI 自动进贡
-                    QTimer::singleShot(800, this, [this, trans]() {
-                        // AI 选最大的牌
-                        Card c = findLargestCardForTribute(trans.payer);
-                        submitTribute(trans.payer, c);
-                    });
-                }
-                return; // 等待异步回调
+            if (!trans.active || trans.cardSelected) continue;
+            requestTribute(trans.payer, false, 800);
+            while (!trans.cardSelected) {
+                co_await FlowAwait{this, FlowWait::Decision};
             }
         }
-
-        if (allDone) {
-            // 所有进贡选牌完毕，执行移动牌并进入还贡阶段
-            for (auto& trans : tributeList) {
-                if (trans.active) {
-                    players[trans.payer]->playCards({trans.card});
-                    players[trans.receiver]->addCards({trans.card});
-                    emit tributeResult(trans.payer, trans.receiver, trans.card, false);
-                    // 重置标记以便还贡使用
-                    trans.cardSelected = false;
-                }
+        for (auto& trans : tributeList) {
+            if (trans.active) {
+                players[trans.payer]->playCards({trans.card});
+                players[trans.receiver]->addCards({trans.card});
+                emit tributeResult(trans.payer, trans.receiver, trans.card, false);
+                // 重置标记以便还贡使用
+                trans.cardSelected = false;
             }
-            emit playerHandChanged(-1); // 刷新所有人手牌
-
-            // 切换到还贡阶段
-            gamePhase = GamePhase::ReturnTribute;
-            QTimer::singleShot(1000, this, &Judge::executeNextTributeStep);
         }
+        emit playerHandChanged(-1); // 刷新所有人手牌
+        markChanged(ChangeHands);
+
+        // 切换到还贡阶段
+        machine.fire(TableEvent::TributesGiven);
+        co_await flowDelay(1000);
     }
-    // PHASE 2: 还贡
-    else if (gamePhase == GamePhase::ReturnTribute) {
-        bool allDone = true;
+
+    // 3. 还贡：方向相反，Receiver (赢家) 选牌还给 Payer (输家)
+    //    全部已选好说明牌已经移动过（检查点恢复时会走到这里），只差进入打牌阶段
+    const bool returned = std::all_of(tributeList.begin(), tributeList.end(), [](const TributeTrans& t) {
+        return !t.active || t.cardSelected;
+    });
+    if (machine.state() == TableState::ReturnTribute && !returned) {
         for (auto& trans : tributeList) {
-            if (trans.active && !trans.cardSelected) {
-                allDone = false;
-
-                // 注意：还贡方向相反，Receiver (赢家) 选牌还给 Payer (输家)
-                int returner = trans.receiver;
-
-                if (returner == 0) { // 人类
-                    emit askForTribute(returner, true); // true = 还贡
-                } else {
-                    // AI 还贡
-                    QTimer::singleShot(800, this, [this, trans, returner]() {
-                        // AI 策略：选最小的牌（非红桃级牌）
-                        // 这里简单实现：选最小的一张牌
-                        auto hand = players[returner]->getHandCopy();
-                        int level = getCurrentLevelRank();
-                        // 排序：小 -> 大
-                        std::sort(hand.begin(), hand.end(), [level](const Card& a, const Card& b){
-                            return isCardSmaller(a, b, level);
-                        });
-                        // 选第一张（最小），但尽量不要还级牌
-                        Card ret = hand.front();
-                        for(const auto& c : hand) {
-                            if (c.getRankInt() != level && c.getRank() != Rank::S && c.getRank() != Rank::B) {
-                                ret = c;
-                                break;
-                            }
-                        }
-                        submitTribute(returner, ret);
-                    });
-                }
-                return;
+            if (!trans.active || trans.cardSelected) continue;
+            requestTribute(trans.receiver, true, 800);
+            while (!trans.cardSelected) {
+                co_await FlowAwait{this, FlowWait::Decision};
             }
         }
-
-        if (allDone) {
-            // 执行还贡移动
-            for (auto& trans : tributeList) {
-                if (trans.active) {
-                    // 注意：trans.card 现在存的是还贡的牌
-                    players[trans.receiver]->playCards({trans.card}); // 赢家出牌
-                    players[trans.payer]->addCards({trans.card});     // 输家拿牌
-                    emit tributeResult(trans.receiver, trans.payer, trans.card, true);
-                }
+        for (auto& trans : tributeList) {
+            if (trans.active) {
+                // 注意：trans.card 现在存的是还贡的牌
+                players[trans.receiver]->playCards({trans.card}); // 赢家出牌
+                players[trans.payer]->addCards({trans.card});     // 输家拿牌
+                emit tributeResult(trans.receiver, trans.payer, trans.card, true);
             }
-            emit playerHandChanged(-1);
-
-            // 全部结束
-            QTimer::singleShot(1000, this, &Judge::finishTributePhase);
         }
+        emit playerHandChanged(-1);
+        markChanged(ChangeHands);
     }
+
+    // 全部结束
+    co_await flowDelay(1000);
+    finishTributePhase();
+}
+
+void Judge::requestTribute(int seat, bool isReturn, int aiDelayMs) {
+    if (!isBotSeat(seat)) {
+        emit askForTribute(seat, isReturn); // 人类或远程玩家
+        return;
+    }
+    // AI 与其他来源一样走 submitTribute，过期的选牌会被校验拒绝
+    scheduleAfter(aiDelayMs, [this, seat, isReturn]() {
+        submitTribute(seat, isReturn ? findCardForReturn(seat) : findLargestCardForTribute(seat));
+    });
+}
+
+Judge::FlowAwait Judge::flowDelay(int delayMs) {
+    // 只捕获 this 和流程编号，std::function 的小对象缓冲放得下，每一步不再分配闭包
+    const unsigned epoch = flowEpoch;
+    scheduleAfter(delayMs, [this, epoch]() {
+        if (epoch == flowEpoch && flowWait == FlowWait::Delay) resumeFlow();
+    });
+    return FlowAwait{this, FlowWait::Delay};
+}
+
+void Judge::resumeFlow() {
+    std::coroutine_handle<> handle = flowHandle;
+    flowHandle = {};
+    flowWait = FlowWait::None;
+    if (handle) handle.resume();
+}
+
+void Judge::cancelFlow() {
+    ++flowEpoch;
+    // 挂起中的协程帧不会再被恢复，直接销毁
+    if (flowHandle) flowHandle.destroy();
+    flowHandle = {};
+    flowWait = FlowWait::None;
 }
 
 bool Judge::submitTribute(int playerId, const Card& card) {
-    if (gamePhase != GamePhase::Tribute && gamePhase != GamePhase::ReturnTribute) return false;
+    SeatEvent event;
+    event.action = SeatAction::Tribute;
+    event.seat = playerId;
+    event.cards = {card};
+    return apply(event);
+}
+
+bool Judge::handleTribute(int playerId, const Card& card) {
+    const auto hand = players[playerId]->getHandCopy();
+    if (std::find(hand.begin(), hand.end(), card) == hand.end()) return false;
 
     // --- 双贡比牌阶段特殊处理 ---
-    if (isResolvingDoubleTribute) {
+    if (machine.state() == TableState::DoubleTributeSelect) {
+        int p3 = previousPlacements[2];
+        int p4 = previousPlacements[3];
+        if ((playerId != p3 && playerId != p4) || doubleTributeStaging.count(playerId)) return false;
+
         // 验证牌是否最大（规则同单贡）
         Card maxCard = findLargestCardForTribute(playerId);
         // 注意：这里需要严格比较，包括花色大小
         // 如果玩家选的不是最大的，拒绝（除非有多个同样大的）
-        // 这里为了简化，假设校验逻辑与之前一致...
         if (isCardSmaller(card, maxCard, getCurrentLevelRank())) {
             qWarning() << "进贡违规：双贡也必须进贡最大的牌";
             return false;
         }
 
-        // 暂存
+        // 暂存，两人都选好后由流程比牌
         doubleTributeStaging[playerId] = card;
         qInfo() << "玩家" << playerId << "双贡选牌：" << QString::fromStdString(card.toString());
-
-        // 检查是否两人都选好了
-        int p3 = previousPlacements[2];
-        int p4 = previousPlacements[3];
-
-        if (doubleTributeStaging.count(p3) && doubleTributeStaging.count(p4)) {
-            resolveDoubleTributeMatch();
-        }
+        if (flowWait == FlowWait::Decision) resumeFlow();
         return true;
     }
 
-    if (gamePhase == GamePhase::Playing) return false;
-
     // 找到属于该玩家的当前任务
     for (auto& trans : tributeList) {
         if (!trans.active || trans.cardSelected) continue;
 
-        int targetPlayer = (gamePhase == GamePhase::Tribute) ? trans.payer : trans.receiver;
+        const bool isTribute = (machine.state() == TableState::Tribute);
+        int targetPlayer = isTribute ? trans.payer : trans.receiver;
 
         if (targetPlayer == playerId) {
             // 验证规则
-            if (gamePhase == GamePhase::Tribute) {
+            if (isTribute) {
                 // 进贡规则：必须是除红桃级牌外最大的牌
                 Card maxCard = findLargestCardForTribute(playerId);
                 // 允许花色不同（如果有多个同样大的），但点数和等级必须一致
@@ -814,17 +837,14 @@ bool Judge::submitTribute(int playerId, const Card& card) {
                 }
                 // 特殊：红桃级牌不能进贡（findLargestCardForTribute 已经过滤了）
             }
-            else {
-                // 还贡规则：通常不限制，可以是任意牌
-                // 但不能是空
-            }
+            // 还贡规则：通常不限制，可以是任意牌
 
             trans.card = card;
             trans.cardSelected = true;
-            qInfo() << "玩家" << playerId << (gamePhase==GamePhase::Tribute?"进贡":"还贡") << QString::fromStdString(card.toString());
+            qInfo() << "玩家" << playerId << (isTribute?"进贡":"还贡") << QString::fromStdString(card.toString());
 
-            // 继续下一步
-            executeNextTributeStep();
+            // 流程正在等选牌时立即继续；还在等待阶段切换的延时则到时再看
+            if (flowWait == FlowWait::Decision) resumeFlow();
             return true;
         }
     }
@@ -832,7 +852,7 @@ bool Judge::submitTribute(int playerId, const Card& card) {
 }
 
 void Judge::finishTributePhase() {
-    gamePhase = GamePhase::Playing;
+    if (!machine.fire(TableEvent::BeginPlay)) return;
 
     // 进贡结束后，无论是否发生进贡，均由上一局头游先手
     int leader = previousPlacements.empty() ? 0 : previousPlacements[0];
@@ -840,11 +860,7 @@ void Judge::finishTributePhase() {
     startNewRound(leader);
 
     // 触发第一轮
-    if (leader != 0) {
-        QTimer::singleShot(800, this, &Judge::aiPlay);
-    } else {
-        emit playerTurnStart(0);
-    }
+    promptSeat(leader, 800);
 }
 
 Card Judge::findLargestCardForTribute(int playerId) const {
@@ -867,9 +883,104 @@ Card Judge::findLargestCardForTribute(int playerId) const {
 
     return candidates[0];
 }
+Card Judge::findCardForReturn(int playerId) const {
+    // AI 策略：选最小的牌（非红桃级牌）
+    // 这里简单实现：选最小的一张牌
+    auto hand = players[playerId]->getHandCopy();
+    int level = getCurrentLevelRank();
+    // 排序：小 -> 大
+    std::sort(hand.begin(), hand.end(), [level](const Card& a, const Card& b){
+        return isCardSmaller(a, b, level);
+    });
+    // 选第一张（最小），但尽量不要还级牌
+    Card ret = hand.front();
+    for(const auto& c : hand) {
+        if (c.getRankInt() != level && c.getRank() != Rank::S && c.getRank() != Rank::B) {
+            ret = c;
+            break;
+        }
+    }
+    return ret;
+}
+
+bool Judge::actForSeat(int seat) {
+    SeatEvent event;
+    event.action = SeatAction::Timeout;
+    event.seat = seat;
+    return apply(event);
+}
+
+bool Judge::handleTimeout(int seat) {
+    if (machine.state() == TableState::Playing) {
+        if (seat != currentTurn) return false;
+        AIPlayer* ai = dynamic_cast<AIPlayer*>(players[seat]);
+        std::vector<Card> chosen;
+        if (ai) chosen = ai->decideToMove(lastCards, getCurrentLevelRank());
+        qInfo() << "玩家" << seat << "超时，自动代打";
+        return chosen.empty() ? handlePass(seat) : handlePlay(seat, chosen);
+    }
+
+    // 进贡/还贡阶段：与 AI 相同的选牌规则；没轮到该座位选牌时会被拒绝
+    if (players[seat]->getCardCount() == 0) return false;
+    const bool isReturn = (machine.state() == TableState::ReturnTribute);
+    return handleTribute(seat, isReturn ? findCardForReturn(seat) : findLargestCardForTribute(seat));
+}
+
+GamePhase Judge::getGamePhase() const {
+    switch (machine.state()) {
+    case TableState::DoubleTributeSelect:
+    case TableState::Tribute:
+        return GamePhase::Tribute;
+    case TableState::ReturnTribute:
+        return GamePhase::ReturnTribute;
+    default:
+        return GamePhase::Playing;
+    }
+}
+
+void Judge::post(SeatEvent event) {
+    eventQueue.push_back(std::move(event));
+}
+
+int Judge::processEvents(const std::function<void(const SeatEvent&, bool)>& onResult) {
+    // 先整体取出：应用过程中新投递的事件留到下一批，保证本批按到达顺序处理
+    std::vector<SeatEvent> batch;
+    batch.swap(eventQueue);
+    int accepted = 0;
+    for (const auto& event : batch) {
+        const bool ok = apply(event);
+        if (ok) ++accepted;
+        if (onResult) onResult(event, ok);
+    }
+    // 把容量还给队列，稳定状态下投递不再分配
+    if (eventQueue.empty()) {
+        batch.clear();
+        eventQueue.swap(batch);
+    }
+    return accepted;
+}
+
+bool Judge::apply(const SeatEvent& event) {
+    if (event.seat < 0 || event.seat >= static_cast<int>(players.size())) return false;
+    // 当前状态不接受这类动作时查表即拒绝
+    if (!machine.allows(event.action)) return false;
+
+    switch (event.action) {
+    case SeatAction::Play:
+        return handlePlay(event.seat, event.cards);
+    case SeatAction::Pass:
+        return handlePass(event.seat);
+    case SeatAction::Tribute:
+        return !event.cards.empty() && handleTribute(event.seat, event.cards.front());
+    case SeatAction::Timeout:
+        return handleTimeout(event.seat);
+    }
+    return false;
+}
+
 // 核心：双贡比大小，分配进贡对象
 void Judge::resolveDoubleTributeMatch() {
-    isResolvingDoubleTribute = false; // 结束比牌阶段
+    machine.fire(TableEvent::BeginTribute); // 结束比牌阶段
 
     int p1 = previousPlacements[0]; // 头游
     int p2 = previousPlacements[1]; // 二游
@@ -914,8 +1025,279 @@ void Judge::resolveDoubleTributeMatch() {
     tributeList.push_back({smallPayer, p2, smallCard, true, true});
 
 EXECUTE:
-    // 任务已经生成，并且牌已经选好了 (cardSelected = true)
-    // 我们可以直接调用 executeNextTributeStep 来执行“移动牌”和“进入还贡”
+    // 任务已经生成，并且牌已经选好了 (cardSelected = true)，由流程接着“移动牌”和“进入还贡”
     qInfo() << "双贡分配完成：大牌进头游，小牌进二游";
-    executeNextTributeStep();
+}
+
+void Judge::notifyHandsDealt() {
+    markChanged(ChangeHands | ChangeTable | ChangeTurn);
+}
+
+void Judge::markChanged(unsigned flags, int seat) {
+    const unsigned seatBits = (seat < 0) ? 0xFu : (1u << seat);
+    pendingDelta.changed |= flags;
+    if (flags & ChangeHands) pendingDelta.handSeats |= seatBits;
+    if (flags & ChangeLastPlay) pendingDelta.playSeats |= seatBits;
+    if (flags & ChangeReport) pendingDelta.reportSeats |= seatBits;
+    if (flags & ChangeFinish) pendingDelta.finishSeats |= seatBits;
+    if (flags & ChangeTable) pendingDelta.playSeats |= 0xFu;
+
+    // 同一事件循环内的多次变化合并为一次通知
+    if (!deltaFlushScheduled) {
+        deltaFlushScheduled = true;
+        scheduleAfter(0, [this]() { flushStateDelta(); });
+    }
+}
+
+void Judge::flushStateDelta() {
+    deltaFlushScheduled = false;
+    if (pendingDelta.changed == ChangeNone) return;
+
+    StateDelta delta = pendingDelta;
+    pendingDelta = StateDelta{};
+    delta.currentTurn = currentTurn;
+    for (int i = 0; i < static_cast<int>(delta.handCounts.size()); ++i) {
+        delta.handCounts[i] = getPlayerHandCount(i);
+    }
+    emit stateChanged(delta);
+}
+
+void Judge::scheduleAfter(int delayMs, std::function<void()> task) {
+    // 服务器上由所在桌的调度器统一驱动；界面程序沿用 Qt 定时器
+    if (scheduler) {
+        scheduler->schedule(delayMs, std::move(task));
+        return;
+    }
+    QTimer::singleShot(delayMs, this, std::move(task));
+}
+
+void Judge::scheduleIdle(TurnScheduler::IdleTask task) {
+    if (scheduler) {
+        scheduler->scheduleIdle(std::move(task));
+        return;
+    }
+    // 界面线程：放在已排队的事件之后，每个任务只占一小片时间
+    QTimer::singleShot(0, this, [task = std::move(task)]() { task(std::chrono::steady_clock::time_point::max()); });
+}
+
+bool Judge::isBotSeat(int seat) const {
+    if (seat < 0 || seat >= static_cast<int>(players.size())) return false;
+    return !remoteSeats[seat] && dynamic_cast<AIPlayer*>(players[seat]) != nullptr;
+}
+
+void Judge::promptSeat(int seat, int aiDelayMs) {
+    // 预想交给空闲任务，不拖慢这次轮转；轮到的是 AI 且没有思考延迟时马上就出牌，不必预想
+    ++ponderSerial;
+    if (ponderBudgetMs > 0 && (aiDelayMs > 0 || !isBotSeat(seat))) ponderOthers(seat);
+    if (isBotSeat(seat)) {
+        if (aiDelayMs <= 0) aiPlay();
+        else scheduleAfter(aiDelayMs, [this]() { aiPlay(); });
+    } else {
+        // 通知UI或远程客户端：该玩家可以出牌
+        emit playerTurnStart(seat);
+    }
+}
+
+void Judge::ponderOthers(int seat) {
+    if (machine.state() != TableState::Playing || currentTurn != seat) return;
+    // 先数出要预想的局面：桌上这手牌（轮回自己时就是首出，与下面重复）和一轮结束后首出
+    struct Job {
+        int seat;
+        bool lead;
+    };
+    std::array<Job, 8> jobs;
+    int jobCount = 0;
+    for (int other = 0; other < static_cast<int>(players.size()); ++other) {
+        if (other == seat || !isBotSeat(other) || players[other]->getCardCount() == 0) continue;
+        if (lastPlayer != other && !lastCards.empty()) jobs[jobCount++] = {other, false};
+        jobs[jobCount++] = {other, true};
+    }
+    if (jobCount == 0) return;
+
+    // 每个任务各自计时，时限是平分的预算与调度器给的空闲时间中较早的一个
+    const auto share = std::chrono::microseconds(ponderBudgetMs * 1000 / jobCount);
+    const unsigned serial = ponderSerial;
+    for (int i = 0; i < jobCount; ++i) {
+        scheduleIdle([this, seat, serial, share, job = jobs[i]](std::chrono::steady_clock::time_point deadline) {
+            if (serial != ponderSerial || machine.state() != TableState::Playing || currentTurn != seat) return;
+            if (players[job.seat]->getCardCount() == 0) return;
+            static const std::vector<Card> lead;
+            AIPlayer* ai = static_cast<AIPlayer*>(players[job.seat]);
+            ai->ponder(job.lead ? lead : lastCards, getCurrentLevelRank(),
+                       std::min(deadline, std::chrono::steady_clock::now() + share));
+        });
+    }
+}
+
+void Judge::setSeatRemote(int seat, bool remote) {
+    if (seat < 0 || seat >= static_cast<int>(remoteSeats.size())) return;
+    if (remoteSeats[seat] == remote) return;
+    remoteSeats[seat] = remote;
+
+    // 远程玩家在自己回合断线，由 AI 接着打
+    if (!remote && machine.state() == TableState::Playing && seat == currentTurn && !players.empty()) {
+        promptSeat(seat, 800);
+    }
+}
+
+bool Judge::isSeatRemote(int seat) const {
+    if (seat < 0 || seat >= static_cast<int>(remoteSeats.size())) return false;
+    return remoteSeats[seat];
+}
+
+static uint8_t packCards(const std::vector<Card>& cards, uint8_t* out) {
+    const size_t n = std::min<size_t>(cards.size(), JudgeSnapshot::kMaxCards);
+    for (size_t i = 0; i < n; ++i) out[i] = static_cast<uint8_t>(cards[i].toId());
+    return static_cast<uint8_t>(n);
+}
+
+static bool unpackCards(const uint8_t* ids, uint8_t count, std::vector<Card>& out) {
+    if (count > JudgeSnapshot::kMaxCards) return false;
+    out.clear();
+    for (uint8_t i = 0; i < count; ++i) {
+        if (ids[i] >= Card::kIdCount) return false;
+        out.push_back(Card::fromId(ids[i]));
+    }
+    return true;
+}
+
+static uint8_t packSeat(int seat) {
+    return (seat < 0 || seat > 3) ? JudgeSnapshot::kNone : static_cast<uint8_t>(seat);
+}
+
+void Judge::saveSnapshot(JudgeSnapshot& out) const {
+    std::memset(&out, 0, sizeof(out));
+    for (int seat = 0; seat < 4 && seat < players.size(); ++seat) {
+        out.handCounts[seat] = packCards(players[seat]->getHandCopy(), out.hands[seat]);
+        if (seat < static_cast<int>(playerLastPlays.size())) {
+            out.lastPlayCounts[seat] = packCards(playerLastPlays[seat], out.lastPlays[seat]);
+        }
+        if (seat < static_cast<int>(playerPassedRound.size()) && playerPassedRound[seat]) out.passedMask |= 1u << seat;
+    }
+    out.lastCardCount = packCards(lastCards, out.lastCards);
+    out.currentTurn = packSeat(currentTurn);
+    out.lastPlayer = packSeat(lastPlayer);
+    out.direction = static_cast<int8_t>(direction);
+    out.teamLevels[0] = static_cast<uint8_t>(teamLevels[0]);
+    out.teamLevels[1] = static_cast<uint8_t>(teamLevels[1]);
+    out.finishCount = static_cast<uint8_t>(std::min<size_t>(finishOrder.size(), 4));
+    for (int i = 0; i < out.finishCount; ++i) out.finishOrder[i] = packSeat(finishOrder[i]);
+    out.placementCount = static_cast<uint8_t>(std::min<size_t>(previousPlacements.size(), 4));
+    for (int i = 0; i < out.placementCount; ++i) out.previousPlacements[i] = packSeat(previousPlacements[i]);
+    out.tableState = static_cast<uint8_t>(machine.state());
+    out.tributeCount = static_cast<uint8_t>(std::min<size_t>(tributeList.size(), 2));
+    for (int i = 0; i < out.tributeCount; ++i) {
+        const TributeTrans& trans = tributeList[i];
+        out.tributes[i] = {packSeat(trans.payer), packSeat(trans.receiver), static_cast<uint8_t>(trans.card.toId()),
+                           static_cast<uint8_t>((trans.active ? 1u : 0u) | (trans.cardSelected ? 2u : 0u))};
+    }
+    for (const auto& [seat, card] : doubleTributeStaging) {
+        if (seat < 0 || seat > 3) continue;
+        out.stagingMask |= 1u << seat;
+        out.staging[seat] = static_cast<uint8_t>(card.toId());
+    }
+}
+
+static bool validCards(const uint8_t* ids, uint8_t count) {
+    if (count > JudgeSnapshot::kMaxCards) return false;
+    return std::all_of(ids, ids + count, [](uint8_t id) { return id < Card::kIdCount; });
+}
+
+static bool validSeats(const uint8_t* seats, uint8_t count) {
+    return std::all_of(seats, seats + count, [](uint8_t seat) { return seat < 4; });
+}
+
+bool Judge::isValidSnapshot(const JudgeSnapshot& in) {
+    for (int seat = 0; seat < 4; ++seat) {
+        if (!validCards(in.hands[seat], in.handCounts[seat])) return false;
+        if (!validCards(in.lastPlays[seat], in.lastPlayCounts[seat])) return false;
+    }
+    if (!validCards(in.lastCards, in.lastCardCount)) return false;
+    if (in.finishCount > 4 || in.tributeCount > 2) return false;
+    if (in.tableState >= kTableStateCount) return false;
+
+    // 座位：当前出牌人与上一手出牌人可以为空，其余都必须是 0..3
+    if (in.currentTurn > 3 && in.currentTurn != JudgeSnapshot::kNone) return false;
+    if (in.lastPlayer > 3 && in.lastPlayer != JudgeSnapshot::kNone) return false;
+    if (!validSeats(in.finishOrder, in.finishCount)) return false;
+    for (int team = 0; team < 2; ++team) {
+        if (in.teamLevels[team] < 2 || in.teamLevels[team] > 14) return false;
+    }
+
+    // 上一局名次要么没有（首局），要么四家齐全；进贡各阶段都要按它决定谁进贡给谁
+    if (in.placementCount != 0 && in.placementCount != 4) return false;
+    if (!validSeats(in.previousPlacements, in.placementCount)) return false;
+    const auto state = static_cast<TableState>(in.tableState);
+    const bool tributeState = state == TableState::DoubleTributeSelect || state == TableState::Tribute
+                              || state == TableState::ReturnTribute;
+    if (tributeState && in.placementCount != 4) return false;
+
+    for (int i = 0; i < in.tributeCount; ++i) {
+        const auto& t = in.tributes[i];
+        if (t.payer > 3 || t.receiver > 3 || t.card >= Card::kIdCount) return false;
+    }
+    if (in.stagingMask > 0x0F) return false;
+    for (int seat = 0; seat < 4; ++seat) {
+        if (((in.stagingMask >> seat) & 1u) && in.staging[seat] >= Card::kIdCount) return false;
+    }
+    return true;
+}
+
+bool Judge::restoreSnapshot(const JudgeSnapshot& in) {
+    if (players.size() != 4) return false;
+    // 先整体校验再落地，损坏的记录不会留下半恢复的牌桌
+    if (!isValidSnapshot(in)) return false;
+    std::array<std::vector<Card>, 4> hands, plays;
+    std::vector<Card> table;
+    for (int seat = 0; seat < 4; ++seat) {
+        unpackCards(in.hands[seat], in.handCounts[seat], hands[seat]);
+        unpackCards(in.lastPlays[seat], in.lastPlayCounts[seat], plays[seat]);
+    }
+    unpackCards(in.lastCards, in.lastCardCount, table);
+
+    for (int seat = 0; seat < 4; ++seat) players[seat]->setHand(hands[seat]);
+    playerLastPlays.assign(plays.begin(), plays.end());
+    playerPassedRound.assign(4, false);
+    for (int seat = 0; seat < 4; ++seat) playerPassedRound[seat] = (in.passedMask >> seat) & 1u;
+    lastCards = std::move(table);
+    currentTurn = (in.currentTurn == JudgeSnapshot::kNone) ? -1 : in.currentTurn;
+    lastPlayer = (in.lastPlayer == JudgeSnapshot::kNone) ? -1 : in.lastPlayer;
+    direction = in.direction < 0 ? -1 : 1;
+    teamLevels = {in.teamLevels[0], in.teamLevels[1]};
+    finishOrder.assign(in.finishOrder, in.finishOrder + in.finishCount);
+    previousPlacements.assign(in.previousPlacements, in.previousPlacements + in.placementCount);
+    machine.reset(static_cast<TableState>(in.tableState));
+    eventQueue.clear();
+    ++botMoveSerial;
+    tributeList.clear();
+    for (int i = 0; i < in.tributeCount; ++i) {
+        const auto& t = in.tributes[i];
+        tributeList.push_back({t.payer, t.receiver, Card::fromId(t.card), (t.flags & 1u) != 0, (t.flags & 2u) != 0});
+    }
+    doubleTributeStaging.clear();
+    for (int seat = 0; seat < 4; ++seat) {
+        if ((in.stagingMask >> seat) & 1u) doubleTributeStaging[seat] = Card::fromId(in.staging[seat]);
+    }
+    pendingDelta = StateDelta{};
+    return true;
+}
+
+void Judge::resumeAfterRestore() {
+    // 检查点里没有待执行的定时任务和挂起的协程，按恢复出的阶段重新发起等待中的那一步
+    if (players.size() != 4) return;
+
+    switch (machine.state()) {
+    case TableState::Dealt:
+    case TableState::HandOver:
+        return; // 由牌桌决定何时开始进贡或下一局
+    default:
+        break;
+    }
+    if (machine.state() == TableState::Playing) {
+        if (currentTurn >= 0) promptSeat(currentTurn, 800);
+        return;
+    }
+    // 进贡/还贡：流程协程按恢复出的状态从等待中的那一步继续
+    cancelFlow();
+    tributeFlow();
 }
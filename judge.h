@@ -4,16 +4,79 @@
 #include <QObject>
 #include <QString>
 #include <vector>
-#include <random>
 #include <array>
+#include <cstdint>
+#include <type_traits>
 #include "card.h"
 #include "player.h"
 #include "AIPlayer.h"
+#include "turnScheduler.h"
+#include "moveDecider.h"
+#include "gameFlow.h"
+#include "gameState.h"
+// 界面使用的粗粒度阶段，由 TableState 折算得出
 enum class GamePhase {
     Playing,        // 正常打牌
     Tribute,        // 进贡阶段
     ReturnTribute   // 还贡阶段
 };
+// 一次引擎推进后发生变化的区域（按位组合）
+enum StateChangeFlag : unsigned {
+    ChangeNone     = 0,
+    ChangeHands    = 1u << 0,  // 手牌张数/内容
+    ChangeLastPlay = 1u << 1,  // 某座位的桌面出牌或“不要”
+    ChangeTurn     = 1u << 2,  // 轮到谁出牌
+    ChangeTable    = 1u << 3,  // 新一轮开始，桌面清空
+    ChangeReport   = 1u << 4,  // 报牌（剩余 10 张及以下）
+    ChangeFinish   = 1u << 5   // 有玩家出完牌
+};
+// 合并后的状态增量：同一事件循环内的多次变更只通知一次
+struct StateDelta {
+    unsigned changed = ChangeNone;
+    unsigned handSeats = 0;        // bit i：座位 i 的手牌变化
+    unsigned playSeats = 0;        // bit i：座位 i 的桌面区域变化
+    int currentTurn = -1;
+    std::array<int, 4> handCounts{};
+    unsigned reportSeats = 0;      // bit i：座位 i 报牌，张数见 reportedRemain[i]
+    unsigned finishSeats = 0;      // bit i：座位 i 出完牌，名次见 finishedPlace[i]
+    std::array<int, 4> reportedRemain{};
+    std::array<int, 4> finishedPlace{};
+};
+// 单桌裁判状态的定长快照：只含整数与牌 id，可直接写入内存映射的检查点文件
+struct JudgeSnapshot {
+    static constexpr int kMaxCards = 32;   // 一手牌最多 27 张，收贡后再多 1 张
+    static constexpr uint8_t kNone = 0xFF; // 座位/牌为空
+
+    struct Tribute {
+        uint8_t payer;
+        uint8_t receiver;
+        uint8_t card;
+        uint8_t flags; // bit0 active, bit1 cardSelected
+    };
+
+    uint8_t handCounts[4];
+    uint8_t hands[4][kMaxCards];
+    uint8_t lastPlayCounts[4];
+    uint8_t lastPlays[4][kMaxCards];
+    uint8_t lastCardCount;
+    uint8_t lastCards[kMaxCards];
+    uint8_t currentTurn;
+    uint8_t lastPlayer;
+    int8_t direction;
+    uint8_t teamLevels[2];
+    uint8_t finishCount;
+    uint8_t finishOrder[4];
+    uint8_t placementCount;
+    uint8_t previousPlacements[4];
+    uint8_t passedMask;
+    uint8_t tableState; // TableState
+    uint8_t tributeCount;
+    Tribute tributes[2];
+    uint8_t stagingMask; // bit i：座位 i 已暂存双贡选牌
+    uint8_t staging[4];
+};
+static_assert(std::is_trivially_copyable<JudgeSnapshot>::value, "JudgeSnapshot must be memcpy-able");
+
 struct TributeTrans {
     int payer;      // 进贡者
     int receiver;   // 收贡者
@@ -25,6 +88,7 @@ class Judge : public QObject {
     Q_OBJECT
 public:
     explicit Judge(QObject *parent = nullptr);
+    ~Judge() override;
 
     QVector<Player*> players;
 
@@ -67,8 +131,47 @@ public:
     //进贡
     void startTributePhase();
     bool submitTribute(int playerId, const Card& card);
-    GamePhase getGamePhase() const { return gamePhase; }
+    GamePhase getGamePhase() const;
+    TableState getTableState() const { return machine.state(); }
     std::vector<TributeTrans> getPendingTributes() const { return tributeList; }
+
+    // 延时任务调度：默认使用 QTimer，服务器牌桌注入共享调度器
+    void setScheduler(TurnScheduler* newScheduler) { scheduler = newScheduler; }
+    // AI 出牌：默认同步调用 AIPlayer::decideToMove，服务器牌桌注入批量决策
+    void setMoveDecider(MoveDecider* decider) { moveDecider = decider; }
+    // 轮到某个座位后，其余 AI 座位在线程空闲时合计最多用 budgetMs 毫秒预想自己的下一手（见 AIPlayer::ponder），
+    // 每个座位每个局面一个单独的空闲任务，平分预算；0 表示关闭
+    void setPonderBudgetMs(int budgetMs) { ponderBudgetMs = budgetMs; }
+    // 座位由远程客户端控制时，即使是 AIPlayer 也等待外部出牌
+    void setSeatRemote(int seat, bool remote);
+    bool isSeatRemote(int seat) const;
+    // 通用座位出牌/过牌接口（校验轮次与手牌），人类/远程玩家共用
+    bool playSeatCards(int seat, const std::vector<Card>& playCards);
+    bool passSeat(int seat);
+    // 超时托管：按 AI 规则替 seat 出牌/过牌或进贡还贡，没轮到该座位行动时返回 false
+    bool actForSeat(int seat);
+
+    // 检查点：保存/恢复整桌状态（含手牌）。恢复后调用 resumeAfterRestore 重新安排 AI 与进贡步骤
+    void saveSnapshot(JudgeSnapshot& out) const;
+    bool restoreSnapshot(const JudgeSnapshot& in);
+    // 只校验记录本身（牌 id、各处座位号、级别、阶段与上一局名次是否相符），不需要构造 Judge，
+    // 供停放恢复前快速过滤损坏的记录
+    static bool isValidSnapshot(const JudgeSnapshot& in);
+    void resumeAfterRestore();
+    bool isHandOver() const { return machine.state() == TableState::HandOver; }
+
+    // 座位事件队列：多个来源（界面、AI 定时器、远程连接、超时）先投递，再按到达顺序批量应用。
+    // apply 先按状态机查表拒绝当前状态不接受的动作，再校验轮次、手牌与牌型
+    void post(SeatEvent event);
+    bool hasPendingEvents() const { return !eventQueue.empty(); }
+    // 返回被接受的事件数；onResult 依次收到每个事件及其结果
+    int processEvents(const std::function<void(const SeatEvent&, bool)>& onResult = {});
+    bool apply(const SeatEvent& event);
+
+    // 发牌等外部改动手牌后调用，并入下一次状态增量
+    void notifyHandsDealt();
+    // 立即发出积压的状态增量（通常由事件循环自动调用）
+    void flushStateDelta();
 signals:
     //贡
     void askForTribute(int playerId, bool isReturn);
@@ -84,6 +187,8 @@ signals:
     void playerTurnStart(int currentTurn);
     void playerReported(int playerId, int remainCards);
     void matchFinished(int winningTeam);
+    // 每个事件循环最多发出一次，携带本次合并的全部变化
+    void stateChanged(const StateDelta& delta);
 private:
     int currentTurn;
     // 出牌方向：1 表示逆时针（0 -> 1 -> 2 -> 3），-1 表示顺时针
@@ -92,34 +197,87 @@ private:
     std::vector<int> finishOrder;
     int lastPlayer;
     std::vector<Card> lastCards;
-    bool lastWasPass;
      std::vector<bool> playerPassedRound;
     std::vector<int> previousPlacements;
-    bool tributePending{false};
-    std::mt19937 rng;
      void startNewRound(int leaderId);
     void aiPlay();
+    // 把 AI 为 seat 选出的牌（空表示过）落到桌面并推进轮次
+    void applyBotMove(int seat, const std::vector<Card>& chosen);
     void checkVictory(int playerId);
     void finalizeGame();
     bool allOthersPassed() const;
     int advanceTurnIndex(int startFrom) const;
     int teammateOf(int playerId) const;
 
-    GamePhase gamePhase = GamePhase::Playing;
+    // 流程状态：发牌 -> 进贡/还贡 -> 打牌 -> 结算，所有阶段判断都查它
+    TableStateMachine machine;
+    std::vector<SeatEvent> eventQueue;
     std::vector<TributeTrans> tributeList;
 
-    void executeNextTributeStep(); // 执行下一步（处理AI或等待Human）
+    // 各座位动作的实际处理，调用前已由状态机确认当前状态接受该动作
+    bool handlePlay(int seat, const std::vector<Card>& playCards);
+    bool handlePass(int seat);
+    bool handleTribute(int seat, const Card& card);
+    bool handleTimeout(int seat);
+
     void finishTributePhase(); // 结束进贡，开始打牌
     Card findLargestCardForTribute(int playerId) const;
+    Card findCardForReturn(int playerId) const;
     //双贡
-    // 增加一个状态标记
-    bool isResolvingDoubleTribute = false;
-
     // 暂存双贡候选牌：map<playerID, Card>
     std::map<int, Card> doubleTributeStaging;
 
     // 辅助：处理双贡比大小并生成最终进贡任务
     void resolveDoubleTributeMatch();
+
+    // 进贡流程协程：双贡比牌 -> 进贡 -> 还贡 -> 开始打牌，选牌与延时都是 co_await
+    enum class FlowWait { None, Decision, Delay };
+    struct FlowAwait {
+        Judge* judge;
+        FlowWait kind;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            judge->flowHandle = handle;
+            judge->flowWait = kind;
+        }
+        void await_resume() const noexcept {}
+    };
+    FlowTask tributeFlow();
+    // 请求某个座位选牌：AI 经调度器延时提交，人类/远程座位发出 askForTribute
+    void requestTribute(int seat, bool isReturn, int aiDelayMs);
+    FlowAwait flowDelay(int delayMs);
+    void resumeFlow();
+    // 作废当前流程（新一局开始或析构），挂起的协程帧随之销毁
+    void cancelFlow();
+    std::coroutine_handle<> flowHandle;
+    FlowWait flowWait = FlowWait::None;
+    unsigned flowEpoch = 0;
+
+    TurnScheduler* scheduler = nullptr;
+    MoveDecider* moveDecider = nullptr;
+    // 每次发出异步 AI 决策请求、轮次推进、新一局或恢复检查点时加一，过期的结果按编号丢弃
+    unsigned botMoveSerial = 0;
+    std::array<bool, 4> remoteSeats{};
+    void scheduleAfter(int delayMs, std::function<void()> task);
+    void scheduleIdle(TurnScheduler::IdleTask task);
+    // 该座位是否由本地 AI 自动出牌
+    bool isBotSeat(int seat) const;
+    // 轮到 seat 时：AI 延时出牌，否则通知外部
+    void promptSeat(int seat, int aiDelayMs);
+    // 轮到 seat 期间让其余 AI 座位预想：中间的人都过时桌上仍是这手牌，以及一轮结束后自己首出
+    void ponderOthers(int seat);
+    int ponderBudgetMs = 0;
+    unsigned ponderSerial = 0; // 每次轮转加一，之前排队的预想任务随之作废
+
+    // 状态增量合并：记录变化，并在回到事件循环时统一发出 stateChanged
+    void markChanged(unsigned flags, int seat = -1);
+    StateDelta pendingDelta;
+    bool deltaFlushScheduled = false;
 };
 
+Q_DECLARE_METATYPE(StateDelta)
+
+// 单张牌比大小（考虑级牌与红桃级牌），进贡/还贡选牌使用
+bool isCardSmaller(const Card& a, const Card& b, int levelRank);
+
 #endif // JUDGE_H
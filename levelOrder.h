@@ -0,0 +1,101 @@
+#ifndef LEVELORDER_H
+#define LEVELORDER_H
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include "card.h"
+
+// 按级牌点数预先算好的单张牌次序表，下标为 Card::toId()。
+// 级牌每局只有一个，出牌分析时按级牌选一次表，之后每张牌只查表，不再逐张比较 levelRank。
+struct LevelOrder {
+    uint8_t logValue[Card::kIdCount] = {}; // 比大小的逻辑值：2..A 为 2..14，级牌 18，小王 19，大王 20
+    uint8_t seqValue[Card::kIdCount] = {}; // 顺子序列值：2..A 为 2..14，小王 16，大王 17
+    uint16_t orderKey[Card::kIdCount] = {}; // 单张次序（进贡/还贡选牌）：点数档次 * 4 + 花色
+    uint64_t wildMask = 0;                 // 红桃级牌（万能牌）的 id 位
+
+    constexpr bool isWild(int id) const { return (wildMask >> id) & 1u; }
+    bool isWild(const Card& c) const { return isWild(c.toId()); }
+    int logOf(const Card& c) const { return logValue[c.toId()]; }
+    int seqOf(const Card& c) const { return seqValue[c.toId()]; }
+};
+
+// 级牌点数的取值范围：2..14 为 2..A，0 表示尚无级牌（没有牌是级牌）
+constexpr int kMaxLevelRank = 14;
+
+namespace levelorder_detail {
+
+// 与 Card::getRankInt 一致：2 为 2，3..A 为 3..14，小王 16，大王 17
+constexpr int rankIntOfId(int id) {
+    if (id == 52) return 16;
+    if (id == 53) return 17;
+    const int rank = static_cast<int>(Rank::Three) + id % 13;
+    return rank == static_cast<int>(Rank::Two) ? 2 : rank;
+}
+
+constexpr LevelOrder makeLevelOrder(int levelRank) {
+    LevelOrder order;
+    for (int id = 0; id < Card::kIdCount; ++id) {
+        const int r = rankIntOfId(id);
+        const bool joker = id >= 52;
+        const bool hearts = !joker && id / 13 == static_cast<int>(Suit::Hearts);
+        const bool level = !joker && r == levelRank;
+
+        int log = r;
+        if (id == 53) log = 20;
+        else if (id == 52) log = 19;
+        else if (level) log = 18;
+        order.logValue[id] = static_cast<uint8_t>(log);
+        order.seqValue[id] = static_cast<uint8_t>(r);
+
+        // 单张次序：普通牌按点数，级牌高于 A，红桃级牌高于其他级牌，再往上是小王、大王；同档按花色
+        int tier = r * 10;
+        if (id == 53) tier = 200;
+        else if (id == 52) tier = 190;
+        else if (level) tier = hearts ? 180 : 170;
+        const int suit = joker ? static_cast<int>(Suit::None) : id / 13;
+        order.orderKey[id] = static_cast<uint16_t>(tier * 8 + suit);
+
+        if (level && hearts) order.wildMask |= uint64_t{1} << id;
+    }
+    return order;
+}
+
+template <size_t... Levels>
+constexpr std::array<LevelOrder, sizeof...(Levels)> makeLevelOrders(std::index_sequence<Levels...>) {
+    return {makeLevelOrder(static_cast<int>(Levels))...};
+}
+
+} // namespace levelorder_detail
+
+// 下标即级牌点数；0、1 不对应任何点数，等价于没有级牌
+inline constexpr std::array<LevelOrder, kMaxLevelRank + 1> kLevelOrders =
+    levelorder_detail::makeLevelOrders(std::make_index_sequence<kMaxLevelRank + 1>{});
+
+constexpr const LevelOrder& levelOrder(int levelRank) {
+    return kLevelOrders[(levelRank >= 0 && levelRank <= kMaxLevelRank) ? levelRank : 0];
+}
+
+// 把运行期的级牌点数换成编译期常量：fn 以 std::integral_constant<int, L> 调用，返回其结果。
+// 用于让内层循环里的级牌判断在每个实例中都是常量。
+template <typename Fn>
+decltype(auto) withLevelRank(int levelRank, Fn&& fn) {
+    switch (levelRank) {
+    case 2:  return fn(std::integral_constant<int, 2>{});
+    case 3:  return fn(std::integral_constant<int, 3>{});
+    case 4:  return fn(std::integral_constant<int, 4>{});
+    case 5:  return fn(std::integral_constant<int, 5>{});
+    case 6:  return fn(std::integral_constant<int, 6>{});
+    case 7:  return fn(std::integral_constant<int, 7>{});
+    case 8:  return fn(std::integral_constant<int, 8>{});
+    case 9:  return fn(std::integral_constant<int, 9>{});
+    case 10: return fn(std::integral_constant<int, 10>{});
+    case 11: return fn(std::integral_constant<int, 11>{});
+    case 12: return fn(std::integral_constant<int, 12>{});
+    case 13: return fn(std::integral_constant<int, 13>{});
+    case 14: return fn(std::integral_constant<int, 14>{});
+    default: return fn(std::integral_constant<int, 0>{});
+    }
+}
+
+#endif // LEVELORDER_H
@@ -4,7 +4,6 @@
 #include <QTimer>        // 延迟控制
 #include <QElapsedTimer> // （可选）实际加载计时
 #include <QScreen>
-#include <QSoundEffect>
 #include "soundmanager.h"
 #include "mainwindow.h"  // 主窗口类
 
@@ -15,16 +14,13 @@ int main(int argc, char *argv[])
     // 初始化音效管理器
     SoundManager::instance().init();
 
-    // 播放背景音乐（循环播放）
-    QSoundEffect* backgroundMusic = new QSoundEffect;
-    backgroundMusic->setSource(QUrl("qrc:/sounds/background.wav"));
-    backgroundMusic->setVolume(0.3);
-    backgroundMusic->setLoopCount(QSoundEffect::Infinite);
-    backgroundMusic->play();
+    // 播放背景音乐（循环播放，复用 SoundManager 中已解码的 background.wav）
+    SoundManager::instance().playBackgroundMusic(0.3);
     // 1. 加载启动图片并创建启动界面
     QPixmap splashPix(":/images/splash.png");  // 从资源文件加载图片
     if (splashPix.isNull()) {  // 检查图片是否加载成功（避免路径错误）
         qWarning() << "启动图片加载失败！请检查资源文件路径";
+        SoundManager::instance().shutdown();  // 未进入 exec()，不会触发 aboutToQuit
         return -1;
     }
     // 获取屏幕尺寸
@@ -6,6 +6,7 @@
 #include <QFrame>
 #include <QMessageBox>
 #include <QListWidgetItem>
+#include <QItemSelectionModel>
 #include <QStyledItemDelegate>
 #include <QPainter>
 #include <QPainterPath>
@@ -15,13 +16,14 @@
 #include <QLineEdit>
 #include <QInputDialog>
 #include <QGraphicsDropShadowEffect>
-// 放在 mainwindow.cpp 顶部
-
+#include "soundmanager.h"
 // mainwindow.cpp 顶部的 CardDelegate 类
 
 class CardDelegate : public QStyledItemDelegate {
 public:
-    using QStyledItemDelegate::QStyledItemDelegate;
+    explicit CardDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {
+        buildFaceTable();
+    }
 
     QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override {
         Q_UNUSED(option);
@@ -32,26 +34,31 @@ public:
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
         if (!index.isValid()) return;
 
+        const QVariant idData = index.data(CardIdRole);
+        if (!idData.isValid()) return;
+        const int id = idData.toInt();
+
         painter->save();
         painter->setRenderHint(QPainter::Antialiasing);
 
-        QString text = index.data(Qt::DisplayRole).toString();
         // 处理特殊状态文字
-        if (text == "不要" || text.compare("PASS", Qt::CaseInsensitive) == 0) {
+        if (id == kPassCardId) {
             painter->setPen(QColor(100, 100, 100));
             QFont font = painter->font();
             font.setBold(true);
             font.setPixelSize(22); // 字体加大
             painter->setFont(font);
-            painter->drawText(option.rect, Qt::AlignCenter, text);
+            painter->drawText(option.rect, Qt::AlignCenter, passLabel);
             painter->restore();
             return;
         }
-        if (text.isEmpty()) { painter->restore(); return; }
+        if (id < 0 || id >= Card::kIdCount) { painter->restore(); return; }
+        CardFace &face = faces[id];
 
         // 绘制卡牌背景
         bool isSelected = index.data(Qt::UserRole).toBool();
-        QRect rect = option.rect.adjusted(6, 10, -6, -10);
+        // 上浮空间预留在项矩形之内，只重绘该项时不会在上方留下残影
+        QRect rect = option.rect.adjusted(6, 18, -6, -2);
         if (isSelected) rect.translate(0, -18); // 选中上浮
 
         painter->setBrush(QColor(0, 0, 0, 60));
@@ -62,35 +69,14 @@ public:
         painter->setPen(QPen(QColor(200, 200, 210), 1.2));
         painter->drawRoundedRect(rect, 12, 12);
 
-        const QString resourcePath = resourcePathForCard(text);
-        QPixmap pixmap = pixmapForPath(resourcePath);
-
-        if (!pixmap.isNull()) {
-            QPixmap scaled = pixmap.scaled(rect.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        if (!face.pixmap.isNull()) {
+            const QPixmap &scaled = scaledFace(face, rect.size());
             QRect target(QPoint(0, 0), scaled.size());
             target.moveCenter(rect.center());
             painter->drawPixmap(target.topLeft(), scaled);
         } else {
             // 如果找不到贴图，使用文字作为后备渲染
-            QColor textColor = (text.contains("♥") || text.contains("♦")) ? QColor(200, 0, 0) : QColor(30, 30, 30);
-            painter->setPen(textColor);
-
-            QString rankStr = text;
-            QString suitStr;
-            if (text.contains("jokerSmall", Qt::CaseInsensitive)) {
-                rankStr = "JOKER"; suitStr="BLACK";
-            }
-            else if (text.contains("jokerBig", Qt::CaseInsensitive)) {
-                rankStr = "JOKER"; suitStr="RED";
-            }
-            else {
-                if (text.startsWith("♠")) suitStr="♠";
-                else if (text.startsWith("♣")) suitStr="♣";
-                else if (text.startsWith("♥")) suitStr="♥";
-                else if (text.startsWith("♦")) suitStr="♦";
-
-                rankStr = text.mid(suitStr.length());
-            }
+            painter->setPen(face.color);
 
             QFont font = painter->font();
             font.setBold(true);
@@ -99,23 +85,21 @@ public:
 
             QRect topRect = rect.adjusted(8, 10, -8, -8);
 
-            if (text.contains("joker", Qt::CaseInsensitive)) {
+            if (face.joker) {
                 font.setPixelSize(14);
                 painter->setFont(font);
-                painter->drawText(topRect, Qt::AlignLeft | Qt::AlignTop, text.contains("Big") ? "大\n王" : "小\n王");
+                painter->drawText(topRect, Qt::AlignLeft | Qt::AlignTop, face.rank);
             } else {
-                painter->drawText(topRect, Qt::AlignLeft | Qt::AlignTop, rankStr);
+                painter->drawText(topRect, Qt::AlignLeft | Qt::AlignTop, face.rank);
 
                 font.setPixelSize(14);
                 painter->setFont(font);
-                painter->drawText(topRect.adjusted(0, 22, 0, 0), Qt::AlignLeft | Qt::AlignTop, suitStr);
-            }
+                painter->drawText(topRect.adjusted(0, 22, 0, 0), Qt::AlignLeft | Qt::AlignTop, face.suit);
 
-            if (!suitStr.isEmpty() && suitStr.length() < 5) {
                 font.setPixelSize(42);
                 painter->setFont(font);
                 painter->setOpacity(0.15);
-                painter->drawText(rect, Qt::AlignCenter, suitStr);
+                painter->drawText(rect, Qt::AlignCenter, face.suit);
             }
         }
 
@@ -123,43 +107,68 @@ public:
     }
 
 private:
-    QString resourcePathForCard(const QString &text) const {
-        if (text.isEmpty()) return {};
-        if (text.compare("BACK", Qt::CaseInsensitive) == 0) {
-            return QStringLiteral(":/cards/back/card_back.png");
-        }
-        if (text.contains("jokerSmall", Qt::CaseInsensitive)) {
-            return QStringLiteral(":/cards/jokers/joker_small.png");
-        }
-        if (text.contains("jokerBig", Qt::CaseInsensitive)) {
-            return QStringLiteral(":/cards/jokers/joker_big.png");
-        }
-
-        const QChar suitChar = text.front();
-        QString suitKey;
-        if (suitChar == QChar(u'♠')) suitKey = "spades";
-        else if (suitChar == QChar(u'♣')) suitKey = "clubs";
-        else if (suitChar == QChar(u'♦')) suitKey = "diamonds";
-        else if (suitChar == QChar(u'♥')) suitKey = "hearts";
-        if (suitKey.isEmpty()) return {};
-
-        QString rank = text.mid(1);
-        if (rank.isEmpty()) return {};
+    // 同一个委托服务手牌区和各出牌区，卡面尺寸各不相同：每种尺寸占一个槽位，缩放结果按槽位缓存，
+    // 避免每次重绘都做平滑缩放。槽位数固定，窗口缩放出现新尺寸时淘汰最久未用的槽位，
+    // 并丢弃该槽位下的全部缩放图，内存不随缩放次数增长
+    static constexpr int kSizeSlots = 4;
+
+    // 按卡牌编号预先计算好的贴图与后备文字，绘制时直接查表
+    struct CardFace {
+        QPixmap pixmap;
+        QPixmap scaled[kSizeSlots]; // 按尺寸槽位缓存的缩放结果，槽位对应 slotSizes
+        QString rank;
+        QString suit;
+        QColor color;
+        bool joker = false;
+    };
 
-        return QString(":/cards/front/%1_%2.png").arg(suitKey, rank);
+    const QPixmap &scaledFace(CardFace &face, const QSize &size) const {
+        int slot = 0;
+        while (slot < kSizeSlots && slotSizes[slot] != size) ++slot;
+        if (slot == kSizeSlots) {
+            slot = static_cast<int>(std::min_element(slotUse, slotUse + kSizeSlots) - slotUse);
+            for (CardFace &f : faces) f.scaled[slot] = QPixmap();
+            slotSizes[slot] = size;
+        }
+        slotUse[slot] = ++useClock;
+        QPixmap &scaled = face.scaled[slot];
+        if (scaled.isNull()) scaled = face.pixmap.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        return scaled;
     }
 
-    QPixmap pixmapForPath(const QString &path) const {
-        if (path.isEmpty()) return {};
-        auto it = cache.find(path);
-        if (it != cache.end()) return it.value();
-
-        QPixmap pix(path);
-        cache.insert(path, pix);
-        return pix;
+    void buildFaceTable() {
+        static const char *suitKeys[] = {"spades", "clubs", "diamonds", "hearts"};
+        for (int id = 0; id < Card::kIdCount; ++id) {
+            const Card card = Card::fromId(id);
+            CardFace &face = faces[id];
+            QString path;
+            if (card.getRank() == Rank::S) {
+                path = QStringLiteral(":/cards/jokers/joker_small.png");
+                face.joker = true;
+                face.rank = QStringLiteral("小\n王");
+                face.color = QColor(30, 30, 30);
+            } else if (card.getRank() == Rank::B) {
+                path = QStringLiteral(":/cards/jokers/joker_big.png");
+                face.joker = true;
+                face.rank = QStringLiteral("大\n王");
+                face.color = QColor(30, 30, 30);
+            } else {
+                const QString rank = QString::fromStdString(card.getRankString());
+                path = QString(":/cards/front/%1_%2.png").arg(suitKeys[static_cast<int>(card.getSuit())], rank);
+                face.rank = rank;
+                face.suit = QString::fromStdString(card.getSuitString());
+                const bool red = card.getSuit() == Suit::Hearts || card.getSuit() == Suit::Diamonds;
+                face.color = red ? QColor(200, 0, 0) : QColor(30, 30, 30);
+            }
+            face.pixmap = QPixmap(path);
+        }
     }
 
-    mutable QHash<QString, QPixmap> cache;
+    mutable CardFace faces[Card::kIdCount];
+    mutable QSize slotSizes[kSizeSlots];
+    mutable quint64 slotUse[kSizeSlots] = {};
+    mutable quint64 useClock = 0;
+    const QString passLabel = QStringLiteral("不要");
 };
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -201,7 +210,11 @@ void MainWindow::setupUI()
     listAI1 = new QListWidget;
     listAI2 = new QListWidget;
     listAI3 = new QListWidget;
-    listHuman = new QListWidget;
+    humanHandModel = new CardListModel(this);
+    for (auto &model : playModels) model = new CardListModel(this);
+
+    listHuman = new QListView;
+    listHuman->setModel(humanHandModel);
     listHuman->setSizeAdjustPolicy(QAbstractItemView::AdjustToContents);
     listHuman->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     listHuman->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
@@ -292,12 +305,16 @@ void MainWindow::setupUI()
     listHuman->setSelectionMode(QAbstractItemView::NoSelection);
 
     // --- 中央出牌区（四个面板） ---
-    playTop = new QListWidget;         // 对应玩家 2（队友）
-    playLeft = new QListWidget;        // 对应玩家 3（左手边）
-    playRight = new QListWidget;       // 对应玩家 1（右手边）
-    playCenterBottom = new QListWidget;// 对应 Human 的桌面出牌（位于 human 手牌之上）
-
-    auto makePlayWidgetDefault = [](QListWidget* w){
+    playTop = new QListView;         // 对应玩家 2（队友）
+    playLeft = new QListView;        // 对应玩家 3（左手边）
+    playRight = new QListView;       // 对应玩家 1（右手边）
+    playCenterBottom = new QListView;// 对应 Human 的桌面出牌（位于 human 手牌之上）
+    playCenterBottom->setModel(playModels[0]);
+    playRight->setModel(playModels[1]);
+    playTop->setModel(playModels[2]);
+    playLeft->setModel(playModels[3]);
+
+    auto makePlayWidgetDefault = [](QListView* w){
         w->setViewMode(QListView::IconMode);
         w->setFlow(QListView::LeftToRight);
         w->setWrapping(false);
@@ -443,7 +460,7 @@ void MainWindow::setupUI()
     playRight->setItemDelegate(delegate);
     playCenterBottom->setItemDelegate(delegate);
 
-    auto polishList = [](QListWidget* list, int baseIconW = 90, int baseIconH = 120, int overlap = -40, bool allowScroll = false) {
+    auto polishList = [](QListView* list, int baseIconW = 90, int baseIconH = 120, int overlap = -40, bool allowScroll = false) {
         list->setViewMode(QListView::IconMode);
         list->setFlow(QListView::LeftToRight);
         list->setWrapping(false);
@@ -516,7 +533,7 @@ void MainWindow::setupUI()
             font-weight: 800;
         }
 
-        QListWidget {
+        QListView {
             background-color: transparent;
             border: none;
             outline: none;
@@ -592,8 +609,7 @@ void MainWindow::setupUI()
 }
 
 void MainWindow::setupConnections() {
-    connect(listHuman, &QListWidget::itemSelectionChanged, this, &MainWindow::onSelectionChanged);
-    connect(listHuman, &QListWidget::itemClicked, this, &MainWindow::onCardClicked);
+    connect(listHuman, &QListView::clicked, this, &MainWindow::onCardClicked);
     connect(btnPlay, &QPushButton::clicked, this, &MainWindow::onPlayClicked);
     connect(btnPass, &QPushButton::clicked, this, &MainWindow::onPassClicked);
     // connect(btnCheatWin, &QPushButton::clicked, this, [this]() {
@@ -634,31 +650,20 @@ void MainWindow::setupConnections() {
             humanPlayer->resetSelection();
         }
         // 清空 UI 中可能残留的上浮标记
-        if (listHuman) {
-            for (int i = 0; i < listHuman->count(); ++i) {
-                if (auto *item = listHuman->item(i)) {
-                    item->setData(Qt::UserRole, false);
-                }
-            }
-            listHuman->viewport()->update();
+        if (humanHandModel) {
+            humanHandModel->clearSelection();
         }
         btnCheatWin->setEnabled(true);
         QMetaObject::invokeMethod(gameManager, "startNewGame", Qt::QueuedConnection);
     });
-    connect(judge, &Judge::lastPlayUpdated, this, [this](int playerId){
-        Q_UNUSED(playerId);
-        this->updateUI(); // 也可以实现一个更细粒度的 updatePlayerArea(playerId)
-    });
-    connect(gameManager, &GameManager::playerDealt, this, &MainWindow::updateUI);
     connect(gameManager, &GameManager::gameStarted, this, [this]() {
         lblStatus->setText("游戏开始！");
-        updateUI();
+        SoundManager::instance().playSound("deal");
     });
 
 
-    // Judge 通知 UI 更新
-    connect(judge, &Judge::playerHandChanged, this, &MainWindow::updateUI);
-    //connect(judge, &Judge::lastPlayUpdated, this, &MainWindow::updateUI);
+    // Judge 通知 UI 更新：出牌/手牌/轮次/清台等变化合并为一次 stateChanged，按区域局部刷新
+    connect(judge, &Judge::stateChanged, this, &MainWindow::onStateChanged);
     connect(btnNewGame, &QPushButton::clicked, this, [this]() {
         lblStatus->setText("正在初始化新比赛(打2)...");
         // ... (原有的清理UI逻辑) ...
@@ -718,15 +723,6 @@ void MainWindow::setupConnections() {
         btnPlay->setEnabled(false);
         btnPass->setEnabled(false);
     });
-    connect(judge, &Judge::turnChanged, this, &MainWindow::updateUI);
-    // 连接清台信号
-    connect(judge, &Judge::tableCleared, this, &MainWindow::updateUI);
-    connect(judge, &Judge::playerReported, this, [this](int playerId, int remain){
-        lblStatus->setText(QString("玩家 %1 报牌：剩余 %2 张").arg(playerId).arg(remain));
-    });
-    // 确保其他信号也连接了
-    connect(judge, &Judge::lastPlayUpdated, this, &MainWindow::updateUI); // 这里不再需要 lambda 参数，全量刷新虽然浪费一点但逻辑最稳
-    connect(judge, &Judge::turnChanged, this, &MainWindow::updateUI);
     connect(judge, &Judge::askForTribute, this, [this](int playerId, bool isReturn) {
         if (playerId != 0) return; // 只处理人类
 
@@ -753,52 +749,21 @@ void MainWindow::setupConnections() {
                           .arg(QString::fromStdString(card.toString()));
 
         QMessageBox::information(this, "进贡通知", msg);
-        updateUI(); // 刷新手牌显示
     });
 
     connect(judge, &Judge::tributeResisted, this, [this](int playerId) {
         QMessageBox::information(this, "抗贡", QString("玩家 %1 拥有双大王，触发抗贡！").arg(playerId));
     });
 }
-void MainWindow::onCardClicked(QListWidgetItem *item) {
-    if (!humanPlayer) return;
-    int index = listHuman->row(item);
-    humanPlayer->toggleSelectCard(index);
-    bool nowSelected = humanPlayer->isIndexSelected(index);
-    item->setData(Qt::UserRole, nowSelected); // 切换
-    listHuman->viewport()->update(); // 强制重绘，触发 Delegate 的上浮动画
+void MainWindow::onCardClicked(const QModelIndex &index) {
+    if (!humanPlayer || !index.isValid()) return;
+    int row = index.row();
+    humanPlayer->toggleSelectCard(row);
+    // 模型只对这一行发出 dataChanged，视图只重绘这张牌
+    humanHandModel->setSelected(row, humanPlayer->isIndexSelected(row));
     refreshSelectionSummary();
 }
 
-void MainWindow::onSelectionChanged() {
-    QList<QListWidgetItem*> selectedItems = listHuman->selectedItems();
-
-    // 恢复所有牌的默认外观
-    // for (int i = 0; i < listHuman->count(); ++i) {
-    //     QListWidgetItem* item = listHuman->item(i);
-    //     item->setBackground(Qt::white);
-    //     item->setSizeHint(QSize(40, 100));  // 默认卡牌大小
-    // }
-
-    // // 高亮选中的牌并获取选中的 Card
-    // for (QListWidgetItem* item : selectedItems) {
-    //     item->setBackground(Qt::yellow);
-    //     item->setSizeHint(QSize(40, 120)); // 稍微变高一点，模拟“上移”的感觉
-
-    //     // 找到该 item 的索引
-    //     int index = listHuman->row(item);
-    //     if (index >= 0 && humanPlayer) {
-    //         // 获取该索引对应的 Card 对象
-    //         Card selectedCard = humanPlayer->getHandCopy()[index];
-
-    //         // 通知 humanPlayer 切换选中状态（传入 Card）
-    //         humanPlayer->toggleSelectCard(selectedCard);
-    //     }
-    // }
-
-    // qDebug() << "当前选中牌数：" << selectedItems.size();
-}
-
 void MainWindow::onPlayClicked() {
     if (!humanPlayer || !judge) return;
 
@@ -831,9 +796,8 @@ void MainWindow::onPlayClicked() {
     if (cards.empty()) {
         std::vector<Card> fallbackSelection;
         std::vector<Card> humanHand = humanPlayer->getHandCopy();
-        for (int i = 0; i < listHuman->count() && i < static_cast<int>(humanHand.size()); ++i) {
-            QListWidgetItem* item = listHuman->item(i);
-            if (item && item->data(Qt::UserRole).toBool()) {
+        for (int i = 0; i < humanHandModel->rowCount() && i < static_cast<int>(humanHand.size()); ++i) {
+            if (humanHandModel->isSelected(i)) {
                 fallbackSelection.push_back(humanHand[i]);
             }
         }
@@ -849,10 +813,8 @@ void MainWindow::onPlayClicked() {
 
     if (success) {
         // 【修复核心】：出牌成功后，必须清空 HumanPlayer 内部的选中状态
+        // 界面由随后到达的 stateChanged 统一刷新
         humanPlayer->resetSelection();
-
-        // 重新刷新界面状态
-        updateUI();
     } else {
         QMessageBox::warning(this, "出牌失败", "出牌不符合规则或管不上上家");
     }
@@ -861,15 +823,92 @@ void MainWindow::onPassClicked() {
     if (judge) {
         lblStatus->setText("你选择了过");
         judge->humanPass();
-        updateUI();
     }
 }
 
 void MainWindow::updateUI() {
     if (!humanPlayer || !judge) return;
-    bool isHumanTurn = (judge->getCurrentTurn() == 0);
-    btnPlay->setEnabled(isHumanTurn);
-    btnPass->setEnabled(isHumanTurn);
+    // 全量刷新：初始化或无法确定变化范围时使用
+    refreshHumanHand();
+    for (int seat = 1; seat < 4; ++seat) refreshRemainCount(seat);
+    for (int seat = 0; seat < 4; ++seat) refreshTableArea(seat);
+    refreshLevels();
+    refreshTurnState();
+}
+
+void MainWindow::onStateChanged(const StateDelta &delta) {
+    if (!humanPlayer || !judge) return;
+
+    // 只刷新本次增量涉及的区域
+    if (delta.changed & ChangeHands) {
+        if (delta.handSeats & 1u) refreshHumanHand();
+        for (int seat = 1; seat < 4; ++seat) {
+            if (delta.handSeats & (1u << seat)) refreshRemainCount(seat);
+        }
+    }
+    if (delta.changed & (ChangeLastPlay | ChangeTable)) {
+        bool anyPlay = false;
+        for (int seat = 0; seat < 4; ++seat) {
+            if (!(delta.playSeats & (1u << seat))) continue;
+            refreshTableArea(seat);
+            anyPlay = anyPlay || !judge->hasPlayerPassed(seat);
+        }
+        if (delta.changed & ChangeLastPlay) {
+            SoundManager::instance().playSound(anyPlay ? "play" : "pass");
+        }
+    }
+    if (delta.changed & (ChangeTable | ChangeFinish)) {
+        refreshLevels();
+    }
+    if (delta.changed & (ChangeTurn | ChangeTable | ChangeLastPlay)) {
+        refreshTurnState();
+    }
+    if (delta.changed & ChangeReport) {
+        // 一次合并的增量里可能有多名玩家报牌，逐个列出
+        QStringList reports;
+        for (int seat = 0; seat < 4; ++seat) {
+            if (!(delta.reportSeats & (1u << seat))) continue;
+            reports << QString("玩家 %1 报牌：剩余 %2 张").arg(seat).arg(delta.reportedRemain[seat]);
+        }
+        lblStatus->setText(reports.join("；"));
+    }
+}
+
+void MainWindow::refreshHumanHand() {
+    // 模型逐行比较，只有变化的牌会被重绘
+    std::vector<Card> humanHand = humanPlayer->getHandCopy();
+    humanHandModel->setCards(humanHand);
+    for (int i = 0; i < static_cast<int>(humanHand.size()); ++i) {
+        humanHandModel->setSelected(i, humanPlayer->isIndexSelected(i));
+    }
+    refreshSelectionSummary();
+}
+
+void MainWindow::refreshRemainCount(int seat) {
+    // 更新侧边栏文字
+    QListWidget *list = (seat == 1) ? listAI1 : (seat == 2) ? listAI2 : listAI3;
+    int count = judge->getPlayerHandCount(seat);
+    list->clear();
+    if (count < 10) {
+        list->addItem(QString("剩 %1 张").arg(count));
+    }
+}
+
+void MainWindow::refreshTableArea(int seat) {
+    CardListModel *area = playModels[seat];
+
+    // 情况A：玩家 Pass 了
+    if (judge->hasPlayerPassed(seat)) {
+        area->setPassMarker();
+        return;
+    }
+
+    // 情况B：玩家出牌了
+    // 情况C：新的一轮还没轮到他，或者他是庄家刚开始 -> 显示空白
+    area->setCards(judge->getPlayerLastPlay(seat));
+}
+
+void MainWindow::refreshLevels() {
     auto rankToString = [](int rank) -> QString {
         switch (rank) {
         case 11: return "J";
@@ -880,66 +919,6 @@ void MainWindow::updateUI() {
         default: return QString::number(rank);
         }
     };
-    // 1. 刷新人类手牌（保持不变，但确保用新的 Delegate）
-    listHuman->clear();
-    std::vector<Card> humanHand = humanPlayer->getHandCopy();
-    for (size_t i = 0; i < humanHand.size(); ++i) {
-        const auto& card = humanHand[i];
-        QListWidgetItem* item = new QListWidgetItem(QString::fromStdString(card.toString()));
-        bool selected = humanPlayer->isIndexSelected(static_cast<int>(i));
-        item->setData(Qt::UserRole, selected); // 初始化选中状态
-        listHuman->addItem(item);
-    }
-
-    // 2. 刷新 AI 剩余张数
-    // 更新侧边栏文字
-    auto updateRemainList = [](QListWidget *list, int count) {
-        list->clear();
-        if (count < 10) {
-            list->addItem(QString("剩 %1 张").arg(count));
-        }
-    };
-
-    updateRemainList(listAI1, judge->getPlayerHandCount(1));
-    updateRemainList(listAI2, judge->getPlayerHandCount(2));
-    updateRemainList(listAI3, judge->getPlayerHandCount(3));
-
-    // 3. 刷新桌面出牌区域（核心修改）
-    auto updateTableArea = [&](int playerId, QListWidget* area) {
-        area->clear();
-
-        // 情况A：玩家 Pass 了
-        if (judge->hasPlayerPassed(playerId)) {
-            QListWidgetItem* item = new QListWidgetItem("不要");
-            item->setFlags(Qt::NoItemFlags); // 不可选中
-            area->addItem(item);
-            return;
-        }
-
-        // 情况B：玩家出牌了
-        std::vector<Card> played = judge->getPlayerLastPlay(playerId);
-        if (!played.empty()) {
-            for (const auto& c : played) {
-                QListWidgetItem* item = new QListWidgetItem(QString::fromStdString(c.toString()));
-                item->setFlags(Qt::NoItemFlags);
-                area->addItem(item);
-            }
-        }
-        // 情况C：新的一轮还没轮到他，或者他是庄家刚开始 -> 显示空白（什么都不做）
-    };
-
-    updateTableArea(0, playCenterBottom);
-    updateTableArea(1, playRight);
-    updateTableArea(2, playTop);
-    updateTableArea(3, playLeft);
-
-    // 4. 更新状态文字
-    if (judge->getCurrentTurn() == 0) {
-        lblStatus->setText("轮到你了：请出牌");
-    } else {
-        lblStatus->setText(QString("等待玩家 %1 出牌...").arg(judge->getCurrentTurn()));
-    }
-
     // 显示双方等级与本局级牌
     if (lblLevels) {
         lblLevels->setText(QString("队伍0 等级：%1 | 队伍1 等级：%2")
@@ -953,8 +932,17 @@ void MainWindow::updateUI() {
                                   .arg(rankText)
                                   .arg(judge->getCurrentLevelTeam()));
     }
+}
+
+void MainWindow::refreshTurnState() {
+    // 更新状态文字
+    if (judge->getCurrentTurn() == 0) {
+        lblStatus->setText("轮到你了：请出牌");
+    } else {
+        lblStatus->setText(QString("等待玩家 %1 出牌...").arg(judge->getCurrentTurn()));
+    }
 
-    // 5. 按钮控制
+    // 按钮控制
     if (judge->getCurrentTurn() == 0) {
         btnPlay->setEnabled(true);
         listHuman->setEnabled(true);
@@ -973,8 +961,6 @@ void MainWindow::updateUI() {
         listHuman->setEnabled(false);
         btnPass->setText("不要");
     }
-
-    refreshSelectionSummary();
 }
 
 void MainWindow::refreshSelectionSummary() {
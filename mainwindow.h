@@ -3,12 +3,14 @@
 
 #include <QMainWindow>
 #include <QListWidget>
+#include <QListView>
 #include <QPushButton>
 #include <QLabel>
 #include "gameManager.h"
 #include "judge.h"
 #include "humanPlayer.h"
 #include "AIPlayer.h"
+#include "cardListModel.h"
 
 class MainWindow : public QMainWindow
 {
@@ -19,14 +21,20 @@ public:
     ~MainWindow();
 private slots:
     void updateUI();
-    void onSelectionChanged();
     void onPlayClicked();       // 点击“出牌”按钮
     void onPassClicked();       // 点击“过”按钮
-    void onCardClicked(QListWidgetItem *item);
+    void onCardClicked(const QModelIndex &index);
+    void onStateChanged(const StateDelta &delta);
 private:
     void setupUI();
     void setupConnections();
     void refreshSelectionSummary();
+    // 按区域刷新，由 updateUI（全量）与 onStateChanged（增量）共用
+    void refreshHumanHand();
+    void refreshRemainCount(int seat);
+    void refreshTableArea(int seat);
+    void refreshLevels();
+    void refreshTurnState();
     GameManager *gameManager;
     Judge *judge;
     HumanPlayer *humanPlayer;
@@ -36,11 +44,13 @@ private:
     QListWidget *listAI1;
     QListWidget *listAI2;
     QListWidget *listAI3;
-    QListWidget *listHuman;
-    QListWidget *playTop;     // 中央上：显示 AI1 的出牌
-    QListWidget *playLeft;    // 中央左：显示 AI2 的出牌
-    QListWidget *playRight;   // 中央右：显示 AI3 的出牌
-    QListWidget *playCenterBottom; // 中央下：显示 Human 的出牌（位于人类手牌上方）
+    QListView *listHuman;
+    QListView *playTop;     // 中央上：显示 AI1 的出牌
+    QListView *playLeft;    // 中央左：显示 AI2 的出牌
+    QListView *playRight;   // 中央右：显示 AI3 的出牌
+    QListView *playCenterBottom; // 中央下：显示 Human 的出牌（位于人类手牌上方）
+    CardListModel *humanHandModel;
+    CardListModel *playModels[4];  // 按座位号索引的桌面出牌模型
     QLabel *lblLastPlay;
     QLabel *lblStatus;
     QLabel *lblLevels;
@@ -0,0 +1,182 @@
+#include "moveBatcher.h"
+#include <utility>
+#include "AIPlayer.h"
+#include "handBatch.h"
+
+namespace {
+
+// 跟牌时的牌型档次（越小越先出），未列出的牌型与原先的排序一致记为 0
+constexpr int64_t kTypeOrder[] = {
+    0, // Invalid
+    1, // Single
+    2, // Pair
+    3, // Trips
+    0, // TripsWithPair
+    0, // TriplePairs
+    0, // SteelPlate
+    0, // Straight
+    4, // Bomb
+    5, // StraightFlush
+    6, // TianWang
+};
+constexpr int kTypeOrderCount = static_cast<int>(sizeof(kTypeOrder) / sizeof(kTypeOrder[0]));
+constexpr int32_t kFirstBombType = static_cast<int32_t>(HandType::Bomb);
+
+} // namespace
+
+void MoveColumns::clear() {
+    type.clear();
+    primary.clear();
+    size.clear();
+    cards.clear();
+    wilds.clear();
+    noise.clear();
+}
+
+void MoveColumns::push(const PlayInfo& info, int cardCount, int wildCount, uint32_t randomBits) {
+    type.push_back(static_cast<int32_t>(info.type));
+    primary.push_back(info.primaryRank);
+    size.push_back(info.size);
+    cards.push_back(cardCount);
+    wilds.push_back(wildCount);
+    noise.push_back(randomBits);
+}
+
+void scoreMoves(const MoveColumns& columns, size_t begin, size_t end,
+                const PlayInfo& base, int baseCards, int64_t* scores) {
+    const int32_t* type = columns.type.data();
+    const int32_t* primary = columns.primary.data();
+    const int32_t* size = columns.size.data();
+    const int32_t* cards = columns.cards.data();
+    const int32_t* wilds = columns.wilds.data();
+    const uint32_t* noise = columns.noise.data();
+
+    if (baseCards == 0) {
+        // 首出：非炸弹之间均匀随机，只剩炸弹时再在炸弹里随机
+        for (size_t i = begin; i < end; ++i) {
+            const int64_t bomb = type[i] == kFirstBombType ? 1 : 0;
+            scores[i - begin] = (bomb << 40) | static_cast<int64_t>(noise[i] & 0xFFFFFFu);
+        }
+        return;
+    }
+
+    const int32_t bt = static_cast<int32_t>(base.type);
+    const int32_t bs = base.size;
+    const int32_t bp = base.primaryRank;
+    const bool baseValid = base.type != HandType::Invalid;
+    const bool baseBomb = bt >= kFirstBombType;
+    for (size_t i = begin; i < end; ++i) {
+        const int32_t t = type[i];
+        const bool candBomb = t >= kFirstBombType;
+        // 与 AIPlayer::canBeat 相同的规则，写成无分支的布尔运算
+        const bool bombBeats = (t > bt) | ((t == bt) & ((size[i] > bs) | ((size[i] == bs) & (primary[i] > bp))));
+        const bool plainBeats = (t == bt) & (cards[i] == baseCards) & (primary[i] > bp);
+        const bool beats = baseValid & (t != 0) &
+                           ((candBomb & !baseBomb) | (candBomb & baseBomb & bombBeats) | (!candBomb & !baseBomb & plainBeats));
+        const int64_t order = kTypeOrder[static_cast<uint32_t>(t) < static_cast<uint32_t>(kTypeOrderCount) ? t : 0];
+        const int64_t score = (order << 48) | (static_cast<int64_t>(primary[i] & 0xFF) << 40)
+                            | (static_cast<int64_t>(cards[i] & 0xFF) << 32) | (static_cast<int64_t>(wilds[i] & 0xFF) << 24)
+                            | static_cast<int64_t>(noise[i] & 0xFFFFFFu);
+        scores[i - begin] = beats ? score : kRejectedMove;
+    }
+}
+
+size_t pickBestMove(const int64_t* scores, size_t n) {
+    size_t best = n;
+    int64_t bestScore = kRejectedMove;
+    for (size_t i = 0; i < n; ++i) {
+        if (scores[i] < bestScore) {
+            bestScore = scores[i];
+            best = i;
+        }
+    }
+    return best;
+}
+
+bool MoveBatcher::submit(uint64_t owner, AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank, Done done) {
+    Request request;
+    request.owner = owner;
+    request.ai = ai;
+    request.lastCards = lastCards;
+    request.levelRank = levelRank;
+    request.done = std::move(done);
+    queue_.push_back(std::move(request));
+    return queue_.size() == maxBatch_;
+}
+
+void MoveBatcher::flush() {
+    if (queue_.empty()) return;
+    running_.clear();
+    running_.swap(queue_);
+
+    // 1. 每个请求先查决策缓存，未命中的生成候选并写入同一组特征列，offsets_ 记录各请求在列中的区间
+    plays_.clear();
+    offsets_.clear();
+    bases_.clear();
+    columns_.clear();
+    keys_.resize(running_.size());
+    cached_.resize(running_.size());
+    hits_.assign(running_.size(), 0);
+    for (size_t r = 0; r < running_.size(); ++r) {
+        Request& request = running_[r];
+        offsets_.push_back(plays_.size());
+        if (request.owner != 0 && ownerAlive_ && !ownerAlive_(request.owner)) {
+            request.ai = nullptr;
+            bases_.emplace_back();
+            continue;
+        }
+        bases_.push_back(request.lastCards.empty() ? PlayInfo{} : HandBatch::classifyOne(request.lastCards, request.levelRank));
+        if (cache_) {
+            keys_[r] = DecisionCache::makeKey(request.ai->getHand(), bases_[r],
+                                              static_cast<int>(request.lastCards.size()), request.levelRank);
+            if (cache_->lookup(keys_[r], static_cast<uint32_t>(rng_()), cached_[r])) {
+                hits_[r] = 1;
+                continue;
+            }
+        }
+        const size_t first = plays_.size();
+        const auto& legal = request.ai->legalMoves(request.levelRank);
+        plays_.insert(plays_.end(), legal.begin(), legal.end());
+        request.ai->describePlays(plays_, first, request.levelRank, columns_);
+    }
+    offsets_.push_back(plays_.size());
+
+    // 2. 整批一次打分，未命中缓存的结果写回
+    scores_.resize(plays_.size());
+    for (size_t r = 0; r < running_.size(); ++r) {
+        scoreMoves(columns_, offsets_[r], offsets_[r + 1], bases_[r],
+                   static_cast<int>(running_[r].lastCards.size()), scores_.data() + offsets_[r]);
+        if (cache_ && running_[r].ai && !hits_[r]) {
+            cache_->insert(keys_[r], std::span<const Play>(plays_.data() + offsets_[r], offsets_[r + 1] - offsets_[r]),
+                           scores_.data() + offsets_[r]);
+        }
+    }
+
+    ++stats_.batches;
+    stats_.candidates += plays_.size();
+
+    // 3. 交回结果；回调里新提交的请求进入 queue_，不影响本批
+    for (size_t r = 0; r < running_.size(); ++r) {
+        Request& request = running_[r];
+        if (!request.ai) {
+            ++stats_.dropped;
+            continue;
+        }
+        if (request.owner != 0 && ownerAlive_ && !ownerAlive_(request.owner)) {
+            ++stats_.dropped; // 本批前面的回调里牌桌被移走了
+            continue;
+        }
+        ++stats_.decisions;
+        std::vector<Card> chosen;
+        if (hits_[r]) {
+            chosen.assign(cached_[r].begin(), cached_[r].end());
+            request.done(std::move(chosen));
+            continue;
+        }
+        const size_t count = offsets_[r + 1] - offsets_[r];
+        const size_t best = pickBestMove(scores_.data() + offsets_[r], count);
+        if (best < count) chosen.assign(plays_[offsets_[r] + best].begin(), plays_[offsets_[r] + best].end());
+        request.done(std::move(chosen));
+    }
+    running_.clear();
+}
@@ -0,0 +1,100 @@
+#ifndef MOVEBATCHER_H
+#define MOVEBATCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+#include "card.h"
+#include "decisionCache.h"
+#include "handmatcher.h"
+#include "moveIndex.h"
+
+class AIPlayer;
+
+// 候选出牌的特征列（结构数组）：每手候选牌分析一次，之后打分只做逐元素整数运算
+struct MoveColumns {
+    std::vector<int32_t> type;    // HandType
+    std::vector<int32_t> primary; // PlayInfo::primaryRank
+    std::vector<int32_t> size;    // PlayInfo::size
+    std::vector<int32_t> cards;   // 实际张数
+    std::vector<int32_t> wilds;   // 用到的万能牌张数
+    std::vector<uint32_t> noise;  // 同分候选之间的随机次序
+
+    size_t count() const { return type.size(); }
+    void clear();
+    void push(const PlayInfo& info, int cardCount, int wildCount, uint32_t randomBits);
+};
+
+// 不能出的候选的分数
+constexpr int64_t kRejectedMove = INT64_MAX;
+// 分数的低位是同分候选之间的随机次序，去掉这几位后相同的候选即并列
+constexpr int kScoreNoiseBits = 24;
+
+// 给 [begin, end) 区间的候选打分，分数越小越优先：
+// 首出时优先非炸弹、其余随机；跟牌时只保留压得过 base 的，按牌型档次、主值、张数、万能牌用量从小到大。
+// 循环体没有分支，编译器可以向量化；decideToMove 与 MoveBatcher 共用，两条路径选出同一手牌
+void scoreMoves(const MoveColumns& columns, size_t begin, size_t end,
+                const PlayInfo& base, int baseCards, int64_t* scores);
+
+// 返回分数最小的下标，全部不能出时返回 n
+size_t pickBestMove(const int64_t* scores, size_t n);
+
+// 跨牌桌批量 AI 决策：同一分片里等待出牌的 AI 先排队，凑满一批或等到最长排队时间后一起处理。
+// 一批里所有候选的特征写进同一组列，一次打分；列、分数和候选缓冲区在批次之间复用，
+// 用有界的排队延迟换取每核更高的决策吞吐。非线程安全：每个分片线程独占一个。
+class MoveBatcher {
+public:
+    using Done = std::function<void(std::vector<Card>)>;
+
+    struct Stats {
+        uint64_t batches = 0;
+        uint64_t decisions = 0;
+        uint64_t candidates = 0;
+        uint64_t dropped = 0; // 所属牌桌已不在，直接丢弃的请求
+    };
+
+    explicit MoveBatcher(size_t maxBatch = 64) : maxBatch_(maxBatch == 0 ? 1 : maxBatch) {}
+
+    // owner 非 0 时，flush 前先经 setOwnerCheck 设置的回调确认请求所属的牌桌仍然存在（ai 指针才有效）
+    void setOwnerCheck(std::function<bool(uint64_t)> check) { ownerAlive_ = std::move(check); }
+    // 可选的共享决策缓存：命中的请求不再生成候选、不进列，未命中的打分后写回
+    void setDecisionCache(DecisionCache* cache) { cache_ = cache; }
+
+    // 入队，恰好凑满一批时返回 true，调用方应尽快（在当前调用栈之外）flush
+    bool submit(uint64_t owner, AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank, Done done);
+    // 处理当前排队的全部请求；done 里新提交的请求留到下一批
+    void flush();
+
+    size_t pending() const { return queue_.size(); }
+    size_t maxBatch() const { return maxBatch_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Request {
+        uint64_t owner = 0;
+        AIPlayer* ai = nullptr;
+        std::vector<Card> lastCards;
+        int levelRank = 0;
+        Done done;
+    };
+
+    size_t maxBatch_;
+    std::function<bool(uint64_t)> ownerAlive_;
+    DecisionCache* cache_ = nullptr;
+    std::minstd_rand rng_{std::random_device{}()};
+    std::vector<Request> queue_;
+    std::vector<Request> running_;
+    // 批次内复用的缓冲区
+    std::vector<Play> plays_;
+    std::vector<size_t> offsets_;
+    std::vector<PlayInfo> bases_;
+    std::vector<DecisionCache::Key> keys_;
+    std::vector<Play> cached_;   // 命中缓存的请求选出的牌
+    std::vector<uint8_t> hits_;  // 各请求是否命中缓存
+    MoveColumns columns_;
+    std::vector<int64_t> scores_;
+    Stats stats_;
+};
+
+#endif // MOVEBATCHER_H
@@ -0,0 +1,21 @@
+#ifndef MOVEDECIDER_H
+#define MOVEDECIDER_H
+
+#include <functional>
+#include <vector>
+#include "card.h"
+
+class AIPlayer;
+
+// Judge 的 AI 出牌出口。未设置时 Judge 直接同步调用 AIPlayer::decideToMove；
+// 服务器把同一分片里多张牌桌同时等待的 AI 决策攒成一批统一打分（见 MoveBatcher）。
+class MoveDecider {
+public:
+    virtual ~MoveDecider() = default;
+
+    // 替 ai 决定下一手（结果为空表示过），done 在牌桌所属线程上稍后执行，不会在本调用内执行
+    virtual void requestMove(AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank,
+                             std::function<void(std::vector<Card>)> done) = 0;
+};
+
+#endif // MOVEDECIDER_H
@@ -0,0 +1,383 @@
+// moveIndex.cpp
+#include "moveIndex.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory_resource>
+#include <utility>
+#include "cardSignature.h"
+#include "decisionArena.h"
+#include "handBatch.h"
+#include "handmatcher.h"
+#include "levelOrder.h"
+
+namespace {
+
+// 只由万能牌组成的出牌不依赖任何点数，只在整体重建时重算
+constexpr uint32_t kWildDep = 1u << 21;
+
+constexpr uint32_t depOf(int value) { return 1u << value; }
+
+// id 到牌的表，展开候选时不逐张调用 Card::fromId
+struct CardTable {
+    Card cards[Card::kIdCount];
+
+    CardTable() {
+        for (int id = 0; id < Card::kIdCount; ++id) cards[id] = Card::fromId(id);
+    }
+};
+
+const CardTable& cardTable() {
+    static const CardTable table;
+    return table;
+}
+
+uint64_t nextStamp() {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// 同一逻辑值的固定牌：两副牌最多 8 张
+using Group = SmallVector<Card, 8>;
+
+// 依次把 src 中 k 张的每种组合（按下标字典序）接在 combo 末尾交给 fn，返回前恢复 combo；不分配内存
+template <typename Fn>
+void forEachChoice(const Group& src, int k, Play& combo, Fn&& fn) {
+    const int n = static_cast<int>(src.size());
+    if (k < 0 || k > n || k > static_cast<int>(kMaxPlayCards)) return;
+    const size_t base = combo.size();
+    int idx[kMaxPlayCards];
+    for (int i = 0; i < k; ++i) idx[i] = i;
+    while (true) {
+        combo.resize(base);
+        for (int i = 0; i < k; ++i) combo.push_back(src[idx[i]]);
+        fn(combo);
+        int pos = k - 1;
+        while (pos >= 0 && idx[pos] == n - k + pos) pos--;
+        if (pos < 0) break;
+        idx[pos]++;
+        for (int j = pos + 1; j < k; ++j) idx[j] = idx[j - 1] + 1;
+    }
+    combo.resize(base);
+}
+
+} // namespace
+
+PackedPlay PackedPlay::pack(const Play& play) {
+    PackedPlay packed;
+    for (const Card& c : play) packed.ids[packed.count++] = static_cast<uint8_t>(c.toId());
+    return packed;
+}
+
+void PackedPlay::unpack(Play& out) const {
+    const CardTable& table = cardTable();
+    out.clear();
+    for (int i = 0; i < count; ++i) out.push_back(table.cards[ids[i]]);
+}
+
+void MoveIndex::reset() {
+    levelRank_ = -1;
+    changedIds_ = 0;
+}
+
+void MoveIndex::cardsChanged(const std::vector<Card>& cards) {
+    for (const Card& c : cards) changedIds_ |= uint64_t{1} << c.toId();
+}
+
+const std::vector<Play>& MoveIndex::moves(const std::vector<Card>& hand, int levelRank) {
+    refresh(hand, levelRank);
+    // 各线程一份展开缓冲区，记着展开的是哪一版候选
+    struct Unpacked {
+        uint64_t stamp = 0;
+        std::vector<Play> plays;
+    };
+    thread_local Unpacked unpacked;
+    if (unpacked.stamp != stamp_) {
+        unpacked.plays.resize(moves_.size());
+        for (size_t i = 0; i < moves_.size(); ++i) moves_[i].unpack(unpacked.plays[i]);
+        unpacked.stamp = stamp_;
+    }
+    return unpacked.plays;
+}
+
+const std::vector<PackedPlay>& MoveIndex::packedMoves(const std::vector<Card>& hand, int levelRank) {
+    refresh(hand, levelRank);
+    return moves_;
+}
+
+void MoveIndex::refresh(const std::vector<Card>& hand, int levelRank) {
+    const LevelOrder& order = levelOrder(levelRank);
+    uint32_t dirty = 0;
+    if (levelRank != levelRank_ || (changedIds_ & order.wildMask) != 0) {
+        dirty = ~0u;
+    } else {
+        for (uint64_t ids = changedIds_; ids != 0; ids &= ids - 1) dirty |= depOf(order.logValue[std::countr_zero(ids)]);
+    }
+    changedIds_ = 0;
+    levelRank_ = levelRank;
+    if (stamp_ == 0) stamp_ = nextStamp();
+    if (dirty == 0) return;
+    stamp_ = nextStamp();
+
+    if (dirty == ~0u) {
+        ++stats_.fullRebuilds;
+        moves_.clear();
+        deps_.clear();
+    } else {
+        // 丢掉依赖了变化点数的候选，其余原样保留
+        ++stats_.partialRefreshes;
+        size_t kept = 0;
+        for (size_t i = 0; i < moves_.size(); ++i) {
+            if (deps_[i] & dirty) continue;
+            if (kept != i) {
+                moves_[kept] = moves_[i];
+                deps_[kept] = deps_[i];
+            }
+            ++kept;
+        }
+        moves_.resize(kept);
+        deps_.resize(kept);
+    }
+    regenerate(hand, levelRank, dirty);
+    // 开局的整手牌候选最多，之后越出越少：整体重建后收紧到实际大小，之后空出一半以上时再还给堆（每手牌只有几次）
+    const size_t slack = dirty == ~0u ? moves_.size() / 4 : moves_.size();
+    if (moves_.capacity() > moves_.size() + slack + 64) {
+        moves_.shrink_to_fit();
+        deps_.shrink_to_fit();
+    }
+}
+
+// 按牌型生成依赖位与 dirty 相交的候选（支持所有掼蛋牌型），整批识别后只保留合法且未出现过的
+void MoveIndex::regenerate(const std::vector<Card>& hand, int levelRank, uint32_t dirty) {
+    // 本局级牌的次序表：判定红桃级牌（万能牌）与逻辑值都只查表
+    const LevelOrder& order = levelOrder(levelRank);
+
+    // 固定牌按逻辑值分组（hand 已按点数、花色排好序，组内次序随之确定）
+    Group groups[HandBatch::kValues];
+    Group wildCards;
+    for (const auto& c : hand) {
+        if (order.isWild(c)) wildCards.push_back(c);
+        else groups[order.logOf(c)].push_back(c);
+    }
+    const int wildTotal = static_cast<int>(wildCards.size());
+    auto wants = [dirty](uint32_t dep) { return (dep & dirty) != 0; };
+
+    // 本次刷新的临时数据都从 arena 里分配
+    DecisionArena arena;
+    std::pmr::vector<Play> fresh(&arena);
+    std::pmr::vector<uint32_t> freshDeps(&arena);
+    fresh.reserve(dirty == ~0u ? 1024 : 256);
+    freshDeps.reserve(fresh.capacity());
+    auto add = [&](const Play& cards, uint32_t dep) {
+        if (cards.empty()) return;
+        fresh.push_back(cards);
+        freshDeps.push_back(dep);
+    };
+    // 在 combo 末尾补 n 张万能牌交给 add，返回前去掉
+    auto addWithWilds = [&](Play& combo, int n, uint32_t dep) {
+        const size_t base = combo.size();
+        combo.append(wildCards.begin(), wildCards.begin() + n);
+        add(combo, dep);
+        combo.resize(base);
+    };
+    Play combo;
+
+    // 1) 基础牌型
+    for (int v = 2; v < HandBatch::kValues; ++v) {
+        const auto& cards = groups[v];
+        if (cards.empty() || !wants(depOf(v))) continue;
+        int sz = static_cast<int>(cards.size());
+        for (int take = 1; take <= std::min(3, sz); ++take) {
+            forEachChoice(cards, take, combo, [&](Play& subset) { add(subset, depOf(v)); });
+        }
+        // 至少一张固定牌；全是万能牌的归下面单独一组
+        for (int need = 2; need <= 3; ++need) {
+            int maxWild = std::min(need - 1, wildTotal);
+            for (int wildUse = 1; wildUse <= maxWild; ++wildUse) {
+                int solidNeed = need - wildUse;
+                if (solidNeed > sz) continue;
+                forEachChoice(cards, solidNeed, combo, [&](Play& subset) { addWithWilds(subset, wildUse, depOf(v)); });
+            }
+        }
+    }
+    if (wants(kWildDep)) {
+        for (int need = 1; need <= std::min(3, wildTotal); ++need) addWithWilds(combo, need, kWildDep);
+    }
+
+    // 2) 炸弹
+    for (int v = 2; v < HandBatch::kValues; ++v) {
+        const auto& cards = groups[v];
+        if (cards.empty() || !wants(depOf(v))) continue;
+        int sz = static_cast<int>(cards.size());
+        for (int total = 4; total <= sz + wildTotal; ++total) {
+            int minSolids = std::max(1, total - wildTotal);
+            int maxSolids = std::min(total, sz);
+            for (int solidsTake = minSolids; solidsTake <= maxSolids; ++solidsTake) {
+                int wildNeed = total - solidsTake;
+                forEachChoice(cards, solidsTake, combo, [&](Play& subset) { addWithWilds(subset, wildNeed, depOf(v)); });
+            }
+        }
+    }
+
+    // 3) 天王炸
+    const auto& smallJokers = groups[19];
+    const auto& bigJokers = groups[20];
+    if (wants(depOf(19) | depOf(20)) && smallJokers.size() >= 2 && bigJokers.size() >= 2) {
+        Play jokers(smallJokers.begin(), smallJokers.begin() + 2);
+        jokers.append(bigJokers.begin(), bigJokers.begin() + 2);
+        add(jokers, depOf(19) | depOf(20));
+    }
+
+    // 4) 三带二：三张与对子取不同点数，对子至少一张固定牌（否则五张同点，是上面已生成的炸弹）
+    for (int t = 2; t < HandBatch::kValues; ++t) {
+        const auto& tripCards = groups[t];
+        if (tripCards.empty()) continue;
+        for (int p = 2; p < HandBatch::kValues; ++p) {
+            const auto& pairCards = groups[p];
+            const uint32_t dep = depOf(t) | depOf(p);
+            if (p == t || pairCards.empty() || !wants(dep)) continue;
+            for (int wildTrip = 0; wildTrip <= wildTotal; ++wildTrip) {
+                for (int wildPair = 0; wildPair + wildTrip <= wildTotal; ++wildPair) {
+                    int needTrip = 3 - wildTrip, needPair = 2 - wildPair;
+                    if (needTrip < 0 || needPair <= 0) continue;
+                    if (needTrip > (int)tripCards.size() || needPair > (int)pairCards.size()) continue;
+                    forEachChoice(tripCards, needTrip, combo, [&](Play& withTrip) {
+                        forEachChoice(pairCards, needPair, withTrip, [&](Play& withPair) {
+                            addWithWilds(withPair, wildTrip + wildPair, dep);
+                        });
+                    });
+                }
+            }
+        }
+    }
+
+    // 5) 三连对 / 6) 钢板：按逻辑值的“至少 k 张”掩码一次找出所有可行窗口（与 HandMatcher 相同，最多用 1 张万能牌）
+    int logCounts[21] = {};
+    for (int v = 2; v < HandBatch::kValues; ++v) logCounts[v] = static_cast<int>(groups[v].size());
+    uint32_t atLeast[5];
+    fillAtLeastMasks(logCounts, atLeast);
+    const int tupleWild = std::min(wildTotal, 1);
+
+    for (uint32_t windows = tupleWindows(atLeast, 2, 3, tupleWild); windows != 0; windows &= windows - 1) {
+        const int a = std::countr_zero(windows);
+        const uint32_t dep = 7u << a;
+        if (!wants(dep)) continue;
+        const auto& g1 = groups[a];
+        const auto& g2 = groups[a + 1];
+        const auto& g3 = groups[a + 2];
+
+        auto tryCombo = [&](int w1, int w2, int w3, int usedWild) {
+            if (usedWild > wildTotal) return;
+            forEachChoice(g1, 2-w1, combo, [&](Play& c1) {
+                forEachChoice(g2, 2-w2, c1, [&](Play& c2) {
+                    forEachChoice(g3, 2-w3, c2, [&](Play& c3) { addWithWilds(c3, usedWild, dep); });
+                });
+            });
+        };
+        tryCombo(0,0,0,0); // 0 wild
+        tryCombo(1,0,0,1); tryCombo(0,1,0,1); tryCombo(0,0,1,1); // 1 wild
+    }
+
+    for (uint32_t windows = tupleWindows(atLeast, 3, 2, tupleWild); windows != 0; windows &= windows - 1) {
+        const int a = std::countr_zero(windows);
+        const uint32_t dep = 3u << a;
+        if (!wants(dep)) continue;
+        const auto& g1 = groups[a];
+        const auto& g2 = groups[a + 1];
+
+        auto tryCombo = [&](int w1, int w2, int usedWild) {
+            if (usedWild > wildTotal) return;
+            forEachChoice(g1, 3-w1, combo, [&](Play& c1) {
+                forEachChoice(g2, 3-w2, c1, [&](Play& c2) { addWithWilds(c2, usedWild, dep); });
+            });
+        };
+        tryCombo(0,0,0);
+        tryCombo(1,0,1); tryCombo(0,1,1);
+    }
+
+    // 7) 同花顺 / 8) 顺子：每种花色一个点数掩码，straightWindows 一次给出所有能用万能牌补齐的窗口
+    // bySuit[s][v] 为该花色序列值 v（2..14）的任一张牌
+    const Card* bySuit[4][15] = {};
+    uint32_t suitMask[4] = {};
+    for (const auto& c : hand) {
+        if (order.isWild(c) || c.getSuit() == Suit::None) continue;
+        const int v = order.seqOf(c);
+        const int s = static_cast<int>(c.getSuit());
+        if (!bySuit[s][v]) bySuit[s][v] = &c;
+        suitMask[s] |= straightBit(v);
+    }
+    auto seqAt = [](int window, int k) {
+        const int v = window + 1 + k; // 窗口 window 覆盖序列值 window+1 .. window+5
+        return v == 1 ? 14 : v;
+    };
+    // 万能牌补洞时相邻几个窗口可能给出同一手牌，所以顺子类候选一起依赖 2..A 全部点数
+    // （非红桃的级牌在顺子里按本来的点数，逻辑值却是 18），任一点数变化就整组重算，最多几十手
+    uint32_t straightDep = depOf(18);
+    for (int v = 2; v <= 14; ++v) straightDep |= depOf(v);
+    const bool wantStraights = wants(straightDep);
+
+    for (int s = 0; s < 4 && wantStraights; ++s) {
+        for (uint32_t windows = straightWindows(suitMask[s], wildTotal); windows != 0; windows &= windows - 1) {
+            const int window = std::countr_zero(windows);
+            combo.clear();
+            for (int k = 0; k < 5; ++k) {
+                if (const Card* card = bySuit[s][seqAt(window, k)]) combo.push_back(*card);
+            }
+            addWithWilds(combo, 5 - static_cast<int>(combo.size()), straightDep);
+        }
+    }
+
+    // 顺子每个窗口只出一手代表：每个点数取第一张，若恰好同花再换一张别的花色，避免与同花顺重复
+    const uint32_t anyMask = wantStraights ? (suitMask[0] | suitMask[1] | suitMask[2] | suitMask[3]) : 0;
+    for (uint32_t windows = straightWindows(anyMask, wildTotal); windows != 0; windows &= windows - 1) {
+        const int window = std::countr_zero(windows);
+        combo.clear();
+        int firstSuit = -1;
+        bool mixed = false;
+        for (int k = 0; k < 5; ++k) {
+            const int v = seqAt(window, k);
+            for (int s = 0; s < 4; ++s) {
+                if (!bySuit[s][v]) continue;
+                if (firstSuit < 0) firstSuit = s;
+                mixed |= s != firstSuit;
+                combo.push_back(*bySuit[s][v]);
+                break;
+            }
+        }
+        for (size_t k = 0; !mixed && k < combo.size(); ++k) {
+            const int v = order.seqOf(combo[k]);
+            for (int s = 0; s < 4; ++s) {
+                if (s == firstSuit || !bySuit[s][v]) continue;
+                combo[k] = *bySuit[s][v];
+                mixed = true;
+                break;
+            }
+        }
+        addWithWilds(combo, 5 - static_cast<int>(combo.size()), straightDep);
+    }
+
+    // 新候选整批识别（缓冲区按线程复用），丢掉非法的。重复的候选只会出现在同一次生成里：
+    // 能生成同一手牌的几处依赖位相同，总是一起保留或一起重算，所以只在 fresh 内按签名去重，留最先生成的
+    thread_local HandBatch batch;
+    batch.clear();
+    for (const auto& cards : fresh) batch.push(cards, levelRank);
+    batch.classify();
+    stats_.regenerated += fresh.size();
+
+    std::pmr::vector<std::pair<CardSignature, uint32_t>> valid(&arena);
+    valid.reserve(fresh.size());
+    for (size_t i = 0; i < fresh.size(); ++i) {
+        if (batch.types()[i] != static_cast<int32_t>(HandType::Invalid)) valid.emplace_back(CardSignature::of(fresh[i]), static_cast<uint32_t>(i));
+    }
+    std::sort(valid.begin(), valid.end());
+    std::pmr::vector<uint32_t> keep(&arena);
+    keep.reserve(valid.size());
+    for (size_t i = 0; i < valid.size(); ++i) {
+        if (i == 0 || valid[i].first != valid[i - 1].first) keep.push_back(valid[i].second);
+    }
+    std::sort(keep.begin(), keep.end());
+    for (uint32_t i : keep) {
+        moves_.push_back(PackedPlay::pack(fresh[i]));
+        deps_.push_back(freshDeps[i]);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef MOVEINDEX_H
+#define MOVEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "card.h"
+#include "smallVector.h"
+
+// 一手出牌最多 10 张（8 张的炸弹加 2 张万能牌），候选出牌都放在内联存储里，不单独占堆
+constexpr size_t kMaxPlayCards = 10;
+using Play = SmallVector<Card, kMaxPlayCards>;
+
+// 索引里长期存放的一手候选：按原次序记下每张牌的 Card::toId，11 字节（Play 要 96 字节）
+struct PackedPlay {
+    uint8_t ids[kMaxPlayCards];
+    uint8_t count = 0;
+
+    size_t size() const { return count; }
+    static PackedPlay pack(const Play& play);
+    void unpack(Play& out) const;
+};
+
+// 一手牌的合法出牌索引。每手候选记下生成它时看过的逻辑值（依赖位，见 LevelOrder::logValue），
+// 手牌变化后只丢掉并重算依赖了变化点数的那部分：单/对/三与炸弹按点数，三带二按三张与对子的点数，
+// 三连对、钢板、顺子、同花顺按窗口覆盖的点数。换手牌、换级牌或万能牌进出时整体重建。
+// Player 在 setHand/addCards/receiveCards/playCards 里通知变化，legalMoves 取用时按需刷新。
+// 刷新时的临时数据都在 DecisionArena 里，候选存储的容量跨刷新保留，稳定后刷新不再分配内存。
+// 候选按 PackedPlay 压缩存放（每个 AI 平均约 270 手、开局最多一千多手），moves 取用时才展开到按线程共用的缓冲区。
+class MoveIndex {
+public:
+    // 整手牌被替换或清空：下次取用时整体重建
+    void reset();
+    // 这些牌刚进入或离开手牌
+    void cardsChanged(const std::vector<Card>& cards);
+
+    // 按 hand（Player 维护的有序手牌）刷新后返回全部合法出牌（仅保留 HandMatcher 认定的合法牌型）。
+    // 结果展开在本线程共用的缓冲区里，同一线程再对别的索引调用 moves 之前有效；索引没变时不重复展开
+    const std::vector<Play>& moves(const std::vector<Card>& hand, int levelRank);
+    // 同上，但直接返回压缩的候选，不展开（搜索里只看张数、逐步出牌时用）
+    const std::vector<PackedPlay>& packedMoves(const std::vector<Card>& hand, int levelRank);
+
+    // 候选存储占用的堆内存（按容量计）
+    size_t memoryBytes() const { return moves_.capacity() * sizeof(PackedPlay) + deps_.capacity() * sizeof(uint32_t); }
+
+    struct Stats {
+        uint64_t fullRebuilds = 0;     // 整体重建次数
+        uint64_t partialRefreshes = 0; // 只重算部分点数的刷新次数
+        uint64_t regenerated = 0;      // 刷新时重新生成并识别的候选数
+    };
+    const Stats& stats() const { return stats_; }
+
+private:
+    void refresh(const std::vector<Card>& hand, int levelRank);
+    void regenerate(const std::vector<Card>& hand, int levelRank, uint32_t dirty);
+
+    std::vector<PackedPlay> moves_;
+    std::vector<uint32_t> deps_; // 与 moves_ 一一对应的依赖位
+    uint64_t stamp_ = 0;         // moves_ 每次变化换一个全局唯一的编号，展开缓冲区据此判断是否要重新展开
+    uint64_t changedIds_ = 0;    // 上次刷新以来进出手牌的牌（Card::toId 位）
+    int levelRank_ = -1;         // 索引对应的级牌；-1 表示需要整体重建
+    Stats stats_;
+};
+
+#endif // MOVEINDEX_H
@@ -0,0 +1,302 @@
+#include "pcmMixer.h"
+#include <QAudioFormat>
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QFile>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+quint16 readLE16(const char* p) {
+    return static_cast<quint16>(static_cast<quint8>(p[0]) | (static_cast<quint8>(p[1]) << 8));
+}
+
+quint32 readLE32(const char* p) {
+    return static_cast<quint32>(readLE16(p)) | (static_cast<quint32>(readLE16(p + 2)) << 16);
+}
+
+} // namespace
+
+PcmMixer::PcmMixer(QObject* parent)
+    : QIODevice(parent)
+{
+    m_busGain.fill(1.0f);
+    open(QIODevice::ReadOnly);
+}
+
+PcmMixer::~PcmMixer() {
+    stopOutput();
+}
+
+QByteArray PcmMixer::decodeWav(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "PcmMixer: 无法打开音频文件" << filePath;
+        return {};
+    }
+    const QByteArray raw = file.readAll();
+    const char* base = raw.constData();
+    const qint64 size = raw.size();
+    if (size < 12 || std::memcmp(base, "RIFF", 4) != 0 || std::memcmp(base + 8, "WAVE", 4) != 0) {
+        qWarning() << "PcmMixer: 不是 WAV 文件" << filePath;
+        return {};
+    }
+
+    int channels = 0, sampleRate = 0, bits = 0;
+    const char* pcm = nullptr;
+    qint64 pcmBytes = 0;
+
+    // 遍历 RIFF 子块，找到 fmt 与 data
+    qint64 pos = 12;
+    while (pos + 8 <= size) {
+        const char* chunk = base + pos;
+        qint64 chunkSize = readLE32(chunk + 4);
+        const char* body = chunk + 8;
+        qint64 avail = std::min<qint64>(chunkSize, size - pos - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && avail >= 16) {
+            if (readLE16(body) != 1) {
+                qWarning() << "PcmMixer: 仅支持 PCM 编码" << filePath;
+                return {};
+            }
+            channels = readLE16(body + 2);
+            sampleRate = static_cast<int>(readLE32(body + 4));
+            bits = readLE16(body + 14);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            pcm = body;
+            pcmBytes = avail;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (!pcm || channels < 1 || channels > 2 || sampleRate <= 0 || (bits != 8 && bits != 16)) {
+        qWarning() << "PcmMixer: 不支持的 WAV 格式" << filePath << channels << sampleRate << bits;
+        return {};
+    }
+
+    const int bytesPerSample = bits / 8;
+    const qint64 srcFrames = pcmBytes / (bytesPerSample * channels);
+    if (srcFrames <= 0) return {};
+
+    auto sampleAt = [&](qint64 frame, int ch) -> int {
+        const char* p = pcm + (frame * channels + std::min(ch, channels - 1)) * bytesPerSample;
+        if (bits == 8) return (static_cast<quint8>(*p) - 128) << 8;
+        return static_cast<qint16>(readLE16(p));
+    };
+
+    // 统一转换为混音器格式，采样率不一致时做线性插值
+    const qint64 dstFrames = srcFrames * kSampleRate / sampleRate;
+    QByteArray out(static_cast<int>(dstFrames * kBytesPerFrame), Qt::Uninitialized);
+    qint16* dst = reinterpret_cast<qint16*>(out.data());
+    for (qint64 i = 0; i < dstFrames; ++i) {
+        const double srcPos = static_cast<double>(i) * sampleRate / kSampleRate;
+        const qint64 i0 = std::min<qint64>(static_cast<qint64>(srcPos), srcFrames - 1);
+        const qint64 i1 = std::min<qint64>(i0 + 1, srcFrames - 1);
+        const double t = srcPos - static_cast<double>(i0);
+        for (int ch = 0; ch < kChannels; ++ch) {
+            double v = sampleAt(i0, ch) * (1.0 - t) + sampleAt(i1, ch) * t;
+            dst[i * kChannels + ch] = static_cast<qint16>(v);
+        }
+    }
+    return out;
+}
+
+void PcmMixer::startOutput(int latencyMs) {
+    if (m_sink) return;
+
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(kChannels);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    m_sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), format, this);
+    // 缓冲区越小，触发到出声的延迟越低；这里按 latencyMs 的两个周期设置
+    const int frames = kSampleRate * std::max(latencyMs, 1) / 1000;
+    m_sink->setBufferSize(frames * kBytesPerFrame * 2);
+    m_sink->start(this);
+}
+
+void PcmMixer::stopOutput() {
+    if (!m_sink) return;
+    m_sink->stop();
+    m_sink->deleteLater();
+    m_sink = nullptr;
+}
+
+int PcmMixer::play(const QByteArray& pcm, qreal volume, bool loop, int bus) {
+    if (pcm.isEmpty()) return 0;
+    Command cmd{CommandType::Play};
+    cmd.pcm = pcm;
+    cmd.bus = std::clamp(bus, 0, kBusCount - 1);
+    cmd.value = static_cast<float>(volume);
+    cmd.flag = loop;
+    QMutexLocker locker(&m_commandLock);
+    cmd.voiceId = m_nextVoiceId++;
+    const int id = cmd.voiceId;
+    m_pending.push_back(std::move(cmd));
+    return id;
+}
+
+void PcmMixer::stop(int voiceId) {
+    Command cmd{CommandType::Stop};
+    cmd.voiceId = voiceId;
+    pushCommand(std::move(cmd));
+}
+
+void PcmMixer::fade(int voiceId, qreal targetVolume, int durationMs, bool stopAtEnd) {
+    Command cmd{CommandType::Fade};
+    cmd.voiceId = voiceId;
+    cmd.value = static_cast<float>(targetVolume);
+    cmd.durationMs = durationMs;
+    cmd.flag = stopAtEnd;
+    pushCommand(std::move(cmd));
+}
+
+void PcmMixer::setVoiceVolume(int voiceId, qreal volume) {
+    Command cmd{CommandType::Volume};
+    cmd.voiceId = voiceId;
+    cmd.value = static_cast<float>(volume);
+    pushCommand(std::move(cmd));
+}
+
+void PcmMixer::setPaused(int voiceId, bool paused) {
+    Command cmd{CommandType::Pause};
+    cmd.voiceId = voiceId;
+    cmd.flag = paused;
+    pushCommand(std::move(cmd));
+}
+
+void PcmMixer::setMasterVolume(qreal volume) {
+    Command cmd{CommandType::Master};
+    cmd.value = static_cast<float>(volume);
+    pushCommand(std::move(cmd));
+}
+
+void PcmMixer::setBusVolume(int bus, qreal volume) {
+    if (bus < 0 || bus >= kBusCount) return;
+    Command cmd{CommandType::Bus};
+    cmd.bus = bus;
+    cmd.value = static_cast<float>(volume);
+    pushCommand(std::move(cmd));
+}
+
+qint64 PcmMixer::bytesAvailable() const {
+    // 混音器是无限流：没有声部时输出静音
+    return kSampleRate * kBytesPerFrame + QIODevice::bytesAvailable();
+}
+
+void PcmMixer::pushCommand(Command&& cmd) {
+    QMutexLocker locker(&m_commandLock);
+    m_pending.push_back(std::move(cmd));
+}
+
+PcmMixer::Voice* PcmMixer::findVoice(int voiceId) {
+    auto it = std::find_if(m_voices.begin(), m_voices.end(), [voiceId](const Voice& v) {
+        return v.id == voiceId;
+    });
+    return it == m_voices.end() ? nullptr : &*it;
+}
+
+void PcmMixer::applyCommands() {
+    std::vector<Command> commands;
+    {
+        QMutexLocker locker(&m_commandLock);
+        if (m_pending.empty()) return;
+        commands.swap(m_pending);
+    }
+
+    for (auto& cmd : commands) {
+        switch (cmd.type) {
+        case CommandType::Play: {
+            Voice v;
+            v.id = cmd.voiceId;
+            v.pcm = std::move(cmd.pcm);
+            v.gain = cmd.value;
+            v.bus = cmd.bus;
+            v.loop = cmd.flag;
+            m_voices.push_back(std::move(v));
+            break;
+        }
+        case CommandType::Stop:
+            m_voices.erase(std::remove_if(m_voices.begin(), m_voices.end(), [&](const Voice& v) {
+                               return v.id == cmd.voiceId;
+                           }), m_voices.end());
+            break;
+        case CommandType::Fade:
+            if (Voice* v = findVoice(cmd.voiceId)) {
+                v->rampFrames = std::max<qint64>(1, static_cast<qint64>(kSampleRate) * cmd.durationMs / 1000);
+                v->gainStep = (cmd.value - v->gain) / static_cast<float>(v->rampFrames);
+                v->stopAtRampEnd = cmd.flag;
+            }
+            break;
+        case CommandType::Volume:
+            if (Voice* v = findVoice(cmd.voiceId)) {
+                v->gain = cmd.value;
+                v->rampFrames = 0;
+                v->gainStep = 0.0f;
+            }
+            break;
+        case CommandType::Pause:
+            if (Voice* v = findVoice(cmd.voiceId)) v->paused = cmd.flag;
+            break;
+        case CommandType::Master:
+            m_master = cmd.value;
+            break;
+        case CommandType::Bus:
+            m_busGain[cmd.bus] = cmd.value;
+            break;
+        }
+    }
+}
+
+qint64 PcmMixer::readData(char* data, qint64 maxlen) {
+    applyCommands();
+
+    const qint64 frames = maxlen / kBytesPerFrame;
+    if (frames <= 0) return 0;
+    const qint64 samples = frames * kChannels;
+    m_accum.assign(static_cast<size_t>(samples), 0);
+
+    for (auto& v : m_voices) {
+        if (v.paused) continue;
+        const qint16* src = reinterpret_cast<const qint16*>(v.pcm.constData());
+        const qint64 total = v.pcm.size() / kBytesPerFrame;
+        const float busGain = m_busGain[v.bus] * m_master;
+        for (qint64 f = 0; f < frames; ++f) {
+            if (v.frame >= total) {
+                if (!v.loop) break;
+                v.frame = 0;
+            }
+            const float g = v.gain * busGain;
+            m_accum[f * kChannels] += static_cast<qint32>(src[v.frame * kChannels] * g);
+            m_accum[f * kChannels + 1] += static_cast<qint32>(src[v.frame * kChannels + 1] * g);
+            ++v.frame;
+            if (v.rampFrames > 0) {
+                v.gain += v.gainStep;
+                if (--v.rampFrames == 0 && v.stopAtRampEnd) {
+                    v.frame = total;
+                    v.loop = false;
+                }
+            }
+        }
+    }
+
+    // 播放完毕（且不循环）的声部直接移除
+    m_voices.erase(std::remove_if(m_voices.begin(), m_voices.end(), [](const Voice& v) {
+                       return !v.loop && v.frame >= v.pcm.size() / kBytesPerFrame;
+                   }), m_voices.end());
+
+    qint16* out = reinterpret_cast<qint16*>(data);
+    for (qint64 i = 0; i < samples; ++i) {
+        out[i] = static_cast<qint16>(std::clamp<qint32>(m_accum[i], -32768, 32767));
+    }
+    return frames * kBytesPerFrame;
+}
+
+qint64 PcmMixer::writeData(const char* data, qint64 len) {
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
+}
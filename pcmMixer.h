@@ -0,0 +1,93 @@
+#ifndef PCMMIXER_H
+#define PCMMIXER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <vector>
+
+class QAudioSink;
+
+// 预解码 PCM 混音器：所有音效在加载时一次性解码为 44.1kHz/16bit/立体声，
+// 播放时只在音频线程里把若干“声部”(voice) 叠加到输出缓冲，避免 QSoundEffect 的启动延迟。
+// 同一段 PCM 通过 QByteArray 隐式共享，多个声部同时播放也不会复制数据。
+class PcmMixer : public QIODevice {
+    Q_OBJECT
+public:
+    static constexpr int kSampleRate = 44100;
+    static constexpr int kChannels = 2;
+    static constexpr int kBytesPerFrame = kChannels * static_cast<int>(sizeof(qint16));
+    // 声部按总线(bus)分组，同一总线共享一个增益，可一次性调整所有正在播放的声部
+    static constexpr int kBusCount = 4;
+
+    explicit PcmMixer(QObject* parent = nullptr);
+    ~PcmMixer() override;
+
+    // 解码 WAV（PCM 8/16bit，单/双声道，任意采样率）为混音器格式，失败返回空数组
+    static QByteArray decodeWav(const QString& filePath);
+
+    // 在音频线程中创建并启动输出设备（需通过 QueuedConnection 调用）
+    Q_INVOKABLE void startOutput(int latencyMs = 10);
+    Q_INVOKABLE void stopOutput();
+
+    // 以下接口可在任意线程调用：命令先入队，由音频线程在下一次 readData 时执行
+    int play(const QByteArray& pcm, qreal volume, bool loop = false, int bus = 0);
+    void stop(int voiceId);
+    void fade(int voiceId, qreal targetVolume, int durationMs, bool stopAtEnd = false);
+    void setVoiceVolume(int voiceId, qreal volume);
+    void setPaused(int voiceId, bool paused);
+    void setMasterVolume(qreal volume);
+    void setBusVolume(int bus, qreal volume);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxlen) override;
+    qint64 writeData(const char* data, qint64 len) override;
+
+private:
+    struct Voice {
+        int id = 0;
+        QByteArray pcm;          // 隐式共享的预解码数据
+        qint64 frame = 0;        // 当前播放到的帧
+        float gain = 1.0f;
+        int bus = 0;
+        float gainStep = 0.0f;   // 淡入淡出：每帧增益变化量
+        qint64 rampFrames = 0;   // 剩余渐变帧数
+        bool loop = false;
+        bool paused = false;
+        bool stopAtRampEnd = false;
+    };
+
+    enum class CommandType { Play, Stop, Fade, Volume, Pause, Master, Bus };
+    struct Command {
+        CommandType type;
+        int voiceId = 0;
+        int bus = 0;
+        QByteArray pcm;
+        float value = 0.0f;
+        int durationMs = 0;
+        bool flag = false;
+    };
+
+    void pushCommand(Command&& cmd);
+    void applyCommands();
+    Voice* findVoice(int voiceId);
+
+    // 仅由音频线程访问
+    std::vector<Voice> m_voices;
+    std::vector<qint32> m_accum;
+    float m_master = 1.0f;
+    std::array<float, kBusCount> m_busGain;
+    QAudioSink* m_sink = nullptr;
+
+    // 跨线程命令队列
+    QMutex m_commandLock;
+    std::vector<Command> m_pending;
+    int m_nextVoiceId = 1;
+};
+
+#endif // PCMMIXER_H
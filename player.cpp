@@ -15,10 +15,12 @@ std::vector<Card> Player::getHandCopy() const {
 void Player::clearHand() {
     handCards.clear();
     rankCounts_.fill(0);
+    moveIndex_.reset();
 }
 // 替换手牌（用于每局发牌时使用）
 void Player::setHand(const std::vector<Card>& cards) {
     handCards = cards;         // 直接替换，不追加
+    moveIndex_.reset();
     qDebug() << "玩家" << ID << "手牌设置完成，数量:" << handCards.size();
     updateRankCounts();        // 更新 rankCounts_、并可排序 handCards
 }
@@ -26,6 +28,7 @@ void Player::setHand(const std::vector<Card>& cards) {
 // 追加手牌（如果你确实需要追加语义）
 void Player::addCards(const std::vector<Card>& cards) {
     handCards.insert(handCards.end(), cards.begin(), cards.end());
+    moveIndex_.cardsChanged(cards);
     updateRankCounts();
 }
 
@@ -35,6 +38,7 @@ void Player::receiveCards(const std::vector<Card>& cards) {
     for (const auto &c : cards) {
         handCards.push_back(c);
     }
+    moveIndex_.cardsChanged(cards);
     // 重新计算 rankCounts_
     updateRankCounts();
 }
@@ -65,7 +69,8 @@ bool Player::playCards(const std::vector<Card>& cards) {
         }
     }
 
-    // 更新计数表
+    // 更新计数表；合法出牌索引只需重算这些牌的点数
+    moveIndex_.cardsChanged(cards);
     updateRankCounts();
     return true;
 }
@@ -78,6 +83,10 @@ void Player::pass() {
 
 
 
+const std::vector<Play>& Player::legalMoves(int levelRank) const {
+    return moveIndex_.moves(handCards, levelRank);
+}
+
 void Player::updateRankCounts() {
     // 清零
     rankCounts_.fill(0);
@@ -2,6 +2,7 @@
 #define PLAYER_H
 
 #include "card.h"
+#include "moveIndex.h"
 #include <array>
 #include <vector>
 
@@ -17,6 +18,7 @@ public:
     size_t getCardCount() const noexcept;
     std::array<int,15> getRankCounts() const;
     std::vector<Card> getHandCopy() const;
+    const std::vector<Card>& getHand() const noexcept { return handCards; }
     void clearHand();
     void setHand(const std::vector<Card>& cards);   // 替换整个手牌
     void addCards(const std::vector<Card>& cards);   // 保留原追加语义（可选）
@@ -33,6 +35,11 @@ public:
 
     virtual void updateRankCounts();
 
+    // 当前手牌的全部合法出牌：索引随手牌变化只重算变化过的点数，取用时按需刷新。
+    // 返回的是本线程的展开缓冲区，同一线程取别的玩家的 legalMoves 之前有效（见 MoveIndex::moves）
+    const std::vector<Play>& legalMoves(int levelRank) const;
+    const MoveIndex& moveIndex() const noexcept { return moveIndex_; }
+
 protected:
     int ID;
     std::string name;
@@ -45,6 +52,7 @@ protected:
     // A 14
     // 2 15
     std::array<int, 18> rankCounts_{};     // 按 rank 的计数（A..K）
+    mutable MoveIndex moveIndex_;          // 合法出牌索引（见 legalMoves）
 };
 
 #endif // PLAYER_H
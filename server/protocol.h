@@ -0,0 +1,151 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "card.h"
+
+// 客户端二进制协议（v3：Delta 的报牌/完成改为按座位掩码逐项下发；
+// v2：handType 按 HandType 编号，加入顺子后炸弹类编号后移）。
+// 帧格式：u8 type | u8 payloadLength | payload，多字节整数一律小端。
+// 牌一律用 1 字节的 Card::toId()（0..53），一手牌就是若干字节。
+//
+// 连接建立后客户端先发 Hello{version}，服务器回 Welcome{version}，版本不一致时回 Error 并断开。
+// 每次引擎推进后服务器只发一帧 Delta（由 Judge::stateChanged 合并而来）：
+//   u8 changed | u8 currentTurn | u8 handCounts[4] | u8 passFlags | u8 playSeats
+//   对 playSeats 中每个座位（升序）：u8 handType | u8 primaryRank | u8 n | n 个牌 id（n=0 表示过/清空）
+//   changed 含 ChangeReport 时追加 u8 reportSeats，再对其中每个座位（升序）追加 u8 remain；
+//   含 ChangeFinish 时追加 u8 finishSeats，再对其中每个座位（升序）追加 u8 place
+// 自己的手牌只在发牌、进贡还贡后整手下发（Hand），出牌造成的变化由客户端按 Delta 自行扣除。
+// 观战者用 Watch 加入，收到 seat = kSpectatorSeat 的 Seat 帧，之后与入座玩家共享同一份公开帧，
+// 但永远不会收到 Hand / TributeAsk 这类只属于某个座位的帧。
+namespace proto {
+
+constexpr uint8_t kVersion = 3;
+constexpr size_t kHeaderSize = 2;
+constexpr size_t kMaxPayload = 255;
+constexpr uint8_t kSpectatorSeat = 0xFF;
+
+enum class MsgType : uint8_t {
+    // 客户端 -> 服务器
+    Hello       = 0x01, // u8 version
+    Join        = 0x02, // u32 table | u8 seat
+    Play        = 0x03, // n 个牌 id
+    Pass        = 0x04,
+    Tribute     = 0x05, // u8 牌 id
+    Leave       = 0x06, // 离座或停止观战
+    Watch       = 0x07, // u32 table
+
+    // 服务器 -> 客户端
+    Welcome     = 0x81, // u8 version
+    Seat        = 0x82, // u32 table | u8 seat（观战为 kSpectatorSeat）
+    Hand        = 0x83, // n 个牌 id
+    Delta       = 0x84, // 见上
+    TributeAsk  = 0x85, // u8 isReturn
+    TributeGive = 0x86, // u8 payer | u8 receiver | u8 牌 id | u8 isReturn
+    Level       = 0x87, // u8 levelRank | u8 team0Level | u8 team1Level
+    GameEnd     = 0x88, // u8 team0Level | u8 team1Level
+    MatchEnd    = 0x89, // u8 winningTeam
+    Timeout     = 0x8A,
+    Error       = 0x8F  // u8 ErrorCode
+};
+
+enum class ErrorCode : uint8_t {
+    BadVersion = 1,
+    BadFrame,
+    NotGreeted,
+    AlreadySeated,
+    BadSeat,
+    SeatTaken,
+    NotSeated,
+    InvalidPlay,
+    CannotPass,
+    InvalidTribute
+};
+
+// 解码得到的帧：payload 直接指向接收缓冲区，不复制
+struct FrameView {
+    MsgType type;
+    const uint8_t* payload;
+    size_t size;
+};
+
+// 从 data[0..len) 取出一帧；数据不完整返回 0，否则返回该帧占用的字节数
+inline size_t peekFrame(const char* data, size_t len, FrameView& out) {
+    if (len < kHeaderSize) return 0;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    const size_t payload = bytes[1];
+    if (len < kHeaderSize + payload) return 0;
+    out.type = static_cast<MsgType>(bytes[0]);
+    out.payload = bytes + kHeaderSize;
+    out.size = payload;
+    return kHeaderSize + payload;
+}
+
+inline uint32_t readU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+           | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// 就地解码牌 id 列表，任何一个 id 越界都视为整帧无效
+inline bool readCards(const uint8_t* p, size_t n, std::vector<Card>& out) {
+    out.clear();
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] >= Card::kIdCount) return false;
+        out.push_back(Card::fromId(p[i]));
+    }
+    return true;
+}
+
+// 直接往目标缓冲区尾部写帧：先占位帧头，写完负载后回填长度，没有中间对象
+class FrameWriter {
+public:
+    FrameWriter(std::string& buffer, MsgType type) : buf_(buffer), start_(buffer.size()) {
+        buf_.push_back(static_cast<char>(type));
+        buf_.push_back('\0');
+    }
+    ~FrameWriter() {
+        buf_[start_ + 1] = static_cast<char>(static_cast<uint8_t>(buf_.size() - start_ - kHeaderSize));
+    }
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    FrameWriter& u8(unsigned v) { buf_.push_back(static_cast<char>(static_cast<uint8_t>(v))); return *this; }
+    FrameWriter& u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) u8((v >> (8 * i)) & 0xFFu);
+        return *this;
+    }
+    FrameWriter& cards(const std::vector<Card>& cards) {
+        for (const auto& c : cards) u8(static_cast<unsigned>(c.toId()));
+        return *this;
+    }
+
+private:
+    std::string& buf_;
+    size_t start_;
+};
+
+// 编码好的只读帧，按引用计数在多个连接的发送队列之间共享
+using SharedFrame = std::shared_ptr<const std::string>;
+
+// 编码一次得到共享帧：encode(std::string&) 往里写一个或多个帧
+template <typename Encode>
+SharedFrame makeShared(Encode&& encode) {
+    auto buffer = std::make_shared<std::string>();
+    encode(*buffer);
+    return buffer;
+}
+
+// 便捷函数：编码整帧到 out 尾部
+inline void writeEmpty(std::string& out, MsgType type) { FrameWriter w(out, type); }
+inline void writeError(std::string& out, ErrorCode code) { FrameWriter(out, MsgType::Error).u8(static_cast<unsigned>(code)); }
+
+} // namespace proto
+
+#endif // PROTOCOL_H
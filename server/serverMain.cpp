@@ -0,0 +1,102 @@
+// serverMain.cpp
+// 本机多牌桌服务器：在一个进程里运行 N 张掼蛋牌桌，客户端通过 TCP(127.0.0.1) 或 Unix 域套接字入座。
+//
+// 用法：tableServer [--tables N] [--shards K] [--port P] [--unix PATH] [--autoplay] [--delay-scale X]
+//                    [--turn-timeout MS] [--no-pin] [--checkpoint PATH [--checkpoint-interval S]]
+//                    [--ai-batch N [--ai-batch-delay MS]] [--ai-cache N] [--ai-think US] [--ai-ponder MS] [--verbose]
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include "tableServer.h"
+
+namespace {
+
+TableServer* g_server = nullptr;
+
+void handleStopSignal(int) {
+    if (g_server) g_server->stop();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // 只借用 Qt 的命令行解析与信号槽；事件循环由 TableServer 的 epoll 接管，不调用 exec()
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("tableServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local multi-table Guandan server");
+    parser.addHelpOption();
+    QCommandLineOption tablesOpt("tables", "Number of tables to host.", "N", "1000");
+    QCommandLineOption shardsOpt("shards", "Number of table shards/threads (0 = one per core).", "K", "0");
+    QCommandLineOption portOpt("port", "TCP port on 127.0.0.1 (0 disables TCP).", "P", "47100");
+    QCommandLineOption unixOpt("unix", "Also listen on this Unix domain socket.", "PATH");
+    QCommandLineOption autoplayOpt("autoplay", "Start every table immediately; empty seats are played by AI.");
+    QCommandLineOption delayOpt("delay-scale", "Scale factor for AI think/tribute delays (0 = run flat out).", "X", "1");
+    QCommandLineOption timeoutOpt("turn-timeout", "Remote player turn timeout in ms (0 = none).", "MS", "30000");
+    QCommandLineOption noPinOpt("no-pin", "Do not pin shard threads to cores.");
+    QCommandLineOption checkpointOpt("checkpoint", "Restore tables from and periodically checkpoint them to this file.", "PATH");
+    QCommandLineOption checkpointIntervalOpt("checkpoint-interval", "Seconds between checkpoints (0 = only on shutdown).", "S", "10");
+    QCommandLineOption aiBatchOpt("ai-batch", "Batch up to N pending AI decisions per shard (0 = decide inline).", "N", "0");
+    QCommandLineOption aiBatchDelayOpt("ai-batch-delay", "Longest time an AI decision waits for its batch.", "MS", "2");
+    QCommandLineOption aiCacheOpt("ai-cache", "Share an AI decision cache of about N entries across shards (0 = off).", "N", "0");
+    QCommandLineOption aiThinkOpt("ai-think", "Per-move AI search budget in microseconds (0 = heuristic only; batched decisions never search).", "US", "0");
+    QCommandLineOption aiPonderOpt("ai-ponder", "Let AI seats think ahead for up to MS ms during other turns (0 = off; not with --ai-batch).", "MS", "0");
+    QCommandLineOption verboseOpt("verbose", "Keep engine log output.");
+    parser.addOption(tablesOpt);
+    parser.addOption(shardsOpt);
+    parser.addOption(portOpt);
+    parser.addOption(unixOpt);
+    parser.addOption(autoplayOpt);
+    parser.addOption(delayOpt);
+    parser.addOption(timeoutOpt);
+    parser.addOption(noPinOpt);
+    parser.addOption(checkpointOpt);
+    parser.addOption(checkpointIntervalOpt);
+    parser.addOption(aiBatchOpt);
+    parser.addOption(aiBatchDelayOpt);
+    parser.addOption(aiCacheOpt);
+    parser.addOption(aiThinkOpt);
+    parser.addOption(aiPonderOpt);
+    parser.addOption(verboseOpt);
+    parser.process(app);
+
+    const int tables = std::max(1, parser.value(tablesOpt).toInt());
+    const uint16_t port = static_cast<uint16_t>(parser.value(portOpt).toUInt());
+
+    // 上万张牌桌的裁判日志会拖慢整个循环
+    if (!parser.isSet(verboseOpt)) {
+        qInstallMessageHandler([](QtMsgType, const QMessageLogContext&, const QString&) {});
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    TableServer server(parser.value(shardsOpt).toInt());
+    server.setDelayScale(parser.value(delayOpt).toDouble());
+    server.setTurnTimeoutMs(std::max(0, parser.value(timeoutOpt).toInt()));
+    server.setPinThreads(!parser.isSet(noPinOpt));
+    server.setMoveBatching(std::max(0, parser.value(aiBatchOpt).toInt()), std::max(0, parser.value(aiBatchDelayOpt).toInt()));
+    server.setDecisionCache(static_cast<size_t>(std::max(0, parser.value(aiCacheOpt).toInt())));
+    server.setAiThinkBudget(std::max(0, parser.value(aiThinkOpt).toInt()));
+    server.setAiPonderBudget(std::max(0, parser.value(aiPonderOpt).toInt()));
+    if (parser.isSet(checkpointOpt)) {
+        server.setCheckpoint(parser.value(checkpointOpt).toStdString(),
+                             static_cast<int>(parser.value(checkpointIntervalOpt).toDouble() * 1000));
+    }
+    if (port != 0 && !server.listenTcp(port)) return 1;
+    if (parser.isSet(unixOpt) && !server.listenUnix(parser.value(unixOpt).toStdString())) return 1;
+    server.createTables(tables, parser.isSet(autoplayOpt));
+
+    g_server = &server;
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    std::printf("tableServer: hosting %d tables on %d shards, 127.0.0.1:%u\n",
+                tables, server.shardCount(), static_cast<unsigned>(port));
+    std::fflush(stdout);
+    server.run();
+    g_server = nullptr;
+    return 0;
+}
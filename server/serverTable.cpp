@@ -0,0 +1,273 @@
+#include "serverTable.h"
+#include <algorithm>
+#include "handmatcher.h"
+#include "tableShard.h"
+
+using proto::MsgType;
+
+ServerTable::ServerTable(int tableId, TableShard* shard, uint64_t timerOwner, QObject* parent)
+    : QObject(parent), tableId_(tableId), shard_(shard), timerOwner_(timerOwner), judge_(new Judge(this))
+{
+    for (int i = 0; i < 4; ++i) {
+        auto* ai = new AIPlayer(i, "AI 玩家 " + std::to_string(i), this);
+        ai->setDecisionCache(shard_->decisionCache());
+        ai->setThinkBudget(shard_->aiThinkBudget());
+        players_.push_back(ai);
+    }
+    judge_->setPlayers(players_);
+    judge_->setScheduler(this);
+    // 批量决策不取用预想结果，只在同步决策时预想
+    if (shard_->moveBatchingEnabled()) judge_->setMoveDecider(this);
+    else judge_->setPonderBudgetMs(shard_->aiPonderBudgetMs());
+    connectJudge();
+}
+
+void ServerTable::connectJudge() {
+    // 同一线程内直接连接：信号发出时立即编码成协议帧
+    // 出牌、过牌、清桌、报牌、出完都已合并进 stateChanged，一次推进只发一帧 Delta
+    connect(judge_, &Judge::stateChanged, this, [this](const StateDelta& delta) {
+        if (!shard_->hasAudience(tableId_)) return; // 没人看就不编码
+        publish(proto::makeShared([&](std::string& out) { encodeDelta(delta, out); }));
+    });
+    connect(judge_, &Judge::playerTurnStart, this, [this](int seat) {
+        armTimeout(seat);
+    });
+    // 进贡/还贡移动牌后整手重发；出牌引起的变化客户端按 Delta 自行扣除
+    connect(judge_, &Judge::playerHandChanged, this, [this](int seat) {
+        if (seat < 0) {
+            for (int i = 0; i < 4; ++i) sendHand(i);
+        }
+    });
+    connect(judge_, &Judge::askForTribute, this, [this](int seat, bool isReturn) {
+        if (!seated_[seat]) return;
+        sendPrivate(seat, proto::makeShared([isReturn](std::string& out) {
+            proto::FrameWriter(out, MsgType::TributeAsk).u8(isReturn ? 1 : 0);
+        }));
+        armTimeout(seat);
+    });
+    connect(judge_, &Judge::tributeResult, this, [this](int payer, int receiver, const Card& card, bool isReturn) {
+        publish(proto::makeShared([&](std::string& out) {
+            proto::FrameWriter(out, MsgType::TributeGive).u8(payer).u8(receiver).u8(card.toId()).u8(isReturn ? 1 : 0);
+        }));
+    });
+    // 本局/整场结束都在 Judge 的出牌调用栈里发出，下一局必须延后开始
+    connect(judge_, &Judge::gameFinished, this, [this]() {
+        ++gamesPlayed_;
+        publish(proto::makeShared([this](std::string& out) {
+            proto::FrameWriter(out, MsgType::GameEnd).u8(judge_->getTeamLevel(0)).u8(judge_->getTeamLevel(1));
+        }));
+        scheduleNextRound();
+    });
+    connect(judge_, &Judge::matchFinished, this, [this](int winningTeam) {
+        ++gamesPlayed_;
+        matchOver_ = true;
+        publish(proto::makeShared([winningTeam](std::string& out) {
+            proto::FrameWriter(out, MsgType::MatchEnd).u8(winningTeam);
+        }));
+        scheduleNextRound();
+    });
+}
+
+void ServerTable::encodeDelta(const StateDelta& delta, std::string& out) const {
+    proto::FrameWriter w(out, MsgType::Delta);
+    unsigned passFlags = 0;
+    for (int seat = 0; seat < 4; ++seat) {
+        if (judge_->hasPlayerPassed(seat)) passFlags |= 1u << seat;
+    }
+    w.u8(delta.changed).u8(delta.currentTurn < 0 ? 0xFFu : static_cast<unsigned>(delta.currentTurn));
+    for (int count : delta.handCounts) w.u8(static_cast<unsigned>(count));
+    w.u8(passFlags).u8(delta.playSeats & 0xFu);
+
+    const int level = judge_->getCurrentLevelRank();
+    for (int seat = 0; seat < 4; ++seat) {
+        if (!(delta.playSeats & (1u << seat))) continue;
+        // 直接引用 Judge 里的桌面牌，不走返回副本的 getter
+        const std::vector<Card>& cards = judge_->playerLastPlays[seat];
+        PlayInfo info;
+        if (!cards.empty()) info = HandMatcher(cards, level).analyze();
+        w.u8(static_cast<unsigned>(info.type)).u8(static_cast<unsigned>(info.primaryRank))
+         .u8(static_cast<unsigned>(cards.size())).cards(cards);
+    }
+    // 合并后的增量可能同时带多个座位的报牌/完成，每个置位座位各占一项
+    if (delta.changed & ChangeReport) {
+        w.u8(delta.reportSeats & 0xFu);
+        for (int seat = 0; seat < 4; ++seat) {
+            if (delta.reportSeats & (1u << seat)) w.u8(static_cast<unsigned>(delta.reportedRemain[seat]));
+        }
+    }
+    if (delta.changed & ChangeFinish) {
+        w.u8(delta.finishSeats & 0xFu);
+        for (int seat = 0; seat < 4; ++seat) {
+            if (delta.finishSeats & (1u << seat)) w.u8(static_cast<unsigned>(delta.finishedPlace[seat]));
+        }
+    }
+}
+
+proto::SharedFrame ServerTable::encodeSnapshot(int seat) const {
+    return proto::makeShared([&](std::string& out) {
+        proto::FrameWriter(out, MsgType::Seat).u32(static_cast<uint32_t>(tableId_)).u8(static_cast<unsigned>(seat));
+        proto::FrameWriter(out, MsgType::Level)
+            .u8(judge_->getCurrentLevelRank()).u8(judge_->getTeamLevel(0)).u8(judge_->getTeamLevel(1));
+        StateDelta snapshot;
+        snapshot.changed = ChangeHands | ChangeLastPlay | ChangeTurn;
+        snapshot.handSeats = 0xFu;
+        snapshot.playSeats = 0xFu;
+        snapshot.currentTurn = judge_->getCurrentTurn();
+        for (int i = 0; i < 4; ++i) snapshot.handCounts[i] = judge_->getPlayerHandCount(i);
+        encodeDelta(snapshot, out);
+    });
+}
+
+void ServerTable::start() {
+    if (started_) return;
+    started_ = true;
+    judge_->resetGameLevels();
+    startNextRound();
+}
+
+void ServerTable::saveCheckpoint(TableCheckpoint::Record& out) const {
+    out.tableId = static_cast<uint32_t>(tableId_);
+    out.flags = (started_ ? TableCheckpoint::RecordStarted : 0) | (matchOver_ ? TableCheckpoint::RecordMatchOver : 0);
+    out.gamesPlayed = static_cast<uint32_t>(gamesPlayed_);
+    judge_->saveSnapshot(out.judge);
+}
+
+bool ServerTable::restoreCheckpoint(const TableCheckpoint::Record& in) {
+    if (!judge_->restoreSnapshot(in.judge)) return false;
+    started_ = true;
+    matchOver_ = (in.flags & TableCheckpoint::RecordMatchOver) != 0;
+    gamesPlayed_ = static_cast<int>(in.gamesPlayed);
+
+    // 定时任务不进检查点：局间空档重新安排下一局，局中重新发起等待中的出牌或进贡
+    if (judge_->isHandOver()) scheduleNextRound();
+    else judge_->resumeAfterRestore();
+    return true;
+}
+
+void ServerTable::schedule(int delayMs, std::function<void()> task) {
+    shard_->scheduleFor(timerOwner_, delayMs, std::move(task));
+}
+
+void ServerTable::scheduleIdle(IdleTask task) {
+    shard_->scheduleIdleFor(timerOwner_, std::move(task));
+}
+
+void ServerTable::requestMove(AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank,
+                              std::function<void(std::vector<Card>)> done) {
+    shard_->requestMove(timerOwner_, ai, lastCards, levelRank, std::move(done));
+}
+
+void ServerTable::scheduleNextRound() {
+    schedule(1500, [this]() {
+        // 没人看的牌桌停在局间，只留下检查点记录；之后不能再访问 this
+        if (shard_->parkIfIdle(tableId_)) return;
+        if (matchOver_) {
+            matchOver_ = false;
+            judge_->resetGameLevels(); // 整场结束，重新从打2开始
+        }
+        startNextRound();
+    });
+}
+
+size_t ServerTable::moveIndexBytes() const {
+    size_t bytes = 0;
+    for (const auto* player : players_) bytes += player->moveIndex().memoryBytes();
+    return bytes;
+}
+
+void ServerTable::startNextRound() {
+    // 与 GameManager::startNextRound 相同的流程：清手牌 -> 重置裁判 -> 发牌 -> 进贡
+    for (auto* player : players_) player->clearHand();
+    judge_->resetForNewHand();
+
+    Deck& deck = shard_->deck();
+    deck.buildDeck();
+    deck.shuffleDeck();
+    auto hands = deck.dealRoundRobin(static_cast<int>(players_.size()));
+    for (int i = 0; i < static_cast<int>(players_.size()); ++i) {
+        players_[i]->setHand(hands[i]);
+        sendHand(i);
+    }
+    judge_->notifyHandsDealt();
+
+    publish(proto::makeShared([this](std::string& out) {
+        proto::FrameWriter(out, MsgType::Level)
+            .u8(judge_->getCurrentLevelRank()).u8(judge_->getTeamLevel(0)).u8(judge_->getTeamLevel(1));
+    }));
+    judge_->startTributePhase();
+}
+
+void ServerTable::armTimeout(int seat) {
+    if (!seated_[seat] || shard_->turnTimeoutMs() <= 0) return;
+    const unsigned serial = ++timeoutSerial_[seat];
+    shard_->scheduleFor(timerOwner_, shard_->turnTimeoutMs(), [this, seat, serial]() {
+        if (serial != timeoutSerial_[seat] || !seated_[seat]) return;
+        sendPrivate(seat, proto::makeShared([](std::string& out) { proto::writeEmpty(out, MsgType::Timeout); }));
+        judge_->actForSeat(seat);
+    }, true);
+}
+
+bool ServerTable::join(int seat) {
+    if (seat < 0 || seat >= 4 || seated_[seat]) return false;
+    seated_[seat] = true;
+    judge_->setSeatRemote(seat, true);
+
+    // 入座时补发当前状态，再单独发自己的手牌
+    sendPrivate(seat, encodeSnapshot(seat));
+    sendHand(seat);
+
+    // 非 autoplay 的牌桌在第一个玩家入座时开局，空座位先由 AI 顶上
+    if (!started_) schedule(0, [this]() { start(); });
+    return true;
+}
+
+void ServerTable::leave(int seat) {
+    if (seat < 0 || seat >= 4 || !seated_[seat]) return;
+    seated_[seat] = false;
+    judge_->setSeatRemote(seat, false); // 交回 AI 托管
+}
+
+bool ServerTable::isSeatTaken(int seat) const {
+    return seat >= 0 && seat < 4 && seated_[seat];
+}
+
+bool ServerTable::post(int seat, SeatAction action, const std::vector<Card>& cards) {
+    if (!isSeatTaken(seat)) return false;
+    SeatEvent event;
+    event.action = action;
+    event.seat = seat;
+    event.cards = cards;
+    event.tag = timeoutSerial_[seat]; // 投递时的计时编号
+    judge_->post(std::move(event));
+    return true;
+}
+
+void ServerTable::processEvents() {
+    judge_->processEvents([this](const SeatEvent& event, bool ok) {
+        const int seat = event.seat;
+        if (ok) {
+            // 行动成功后作废该座位的超时任务；应用过程中又被重新计时（又轮到它）的保留
+            if (timeoutSerial_[seat] == event.tag) ++timeoutSerial_[seat];
+            return;
+        }
+        proto::ErrorCode code = proto::ErrorCode::InvalidPlay;
+        if (event.action == SeatAction::Pass) code = proto::ErrorCode::CannotPass;
+        else if (event.action == SeatAction::Tribute) code = proto::ErrorCode::InvalidTribute;
+        sendPrivate(seat, proto::makeShared([code](std::string& out) { proto::writeError(out, code); }));
+    });
+}
+
+void ServerTable::sendHand(int seat) {
+    if (!seated_[seat]) return;
+    sendPrivate(seat, proto::makeShared([this, seat](std::string& out) {
+        proto::FrameWriter(out, MsgType::Hand).cards(players_[seat]->getHandCopy());
+    }));
+}
+
+void ServerTable::sendPrivate(int seat, proto::SharedFrame frame) {
+    shard_->sendToSeat(tableId_, seat, std::move(frame));
+}
+
+void ServerTable::publish(proto::SharedFrame frame) {
+    shard_->broadcast(tableId_, frame);
+}
@@ -0,0 +1,94 @@
+#ifndef SERVERTABLE_H
+#define SERVERTABLE_H
+
+#include <QObject>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include "judge.h"
+#include "AIPlayer.h"
+#include "protocol.h"
+#include "moveDecider.h"
+#include "tableCheckpoint.h"
+#include "turnScheduler.h"
+
+class TableShard;
+
+// 服务器上的一张牌桌：一个 Judge + 四个 AIPlayer。
+// 没有客户端入座的座位由 AI 自动出牌，客户端 JOIN 后该座位切换为远程控制；
+// 所有延时（AI 思考、进贡步骤、下一局开局、玩家超时）都交给所属分片的时间轮，
+// 牌桌只在分片线程内被访问。
+// 公开事件每次只编码一份共享帧，由分片扇出给入座玩家和所有观战者；
+// 手牌、进贡请求等私有信息只编码进发给对应座位的帧，观战流里天然不含手牌。
+// 牌桌自己（以及它的 Judge）的定时任务都带上 timerOwner 交给分片，牌桌被停放销毁后这些任务自动作废；
+// 分片开启批量 AI 决策时，AI 出牌请求同样带上 timerOwner 交给分片排队。
+class ServerTable : public QObject, public TurnScheduler, public MoveDecider {
+    Q_OBJECT
+public:
+    ServerTable(int tableId, TableShard* shard, uint64_t timerOwner, QObject* parent = nullptr);
+
+    int id() const { return tableId_; }
+    Judge* judge() const { return judge_; }
+
+    // 开始第一局（从打2开始）
+    void start();
+
+    // 客户端入座/离座，座位已被占用时返回 false
+    bool join(int seat);
+    void leave(int seat);
+    bool isSeatTaken(int seat) const;
+
+    // 远程座位的操作先投递到 Judge 的事件队列，座位未入座时返回 false；
+    // 由分片在本轮读完所有连接后调用 processEvents 按到达顺序统一应用，被拒绝的操作回 Error 帧
+    bool post(int seat, SeatAction action, const std::vector<Card>& cards = {});
+    bool hasPendingEvents() const { return judge_->hasPendingEvents(); }
+    void processEvents();
+
+    // 入座/观战时补发的全桌状态：Seat + Level + 覆盖全桌的 Delta（seat 为观战时只含公开信息）
+    proto::SharedFrame encodeSnapshot(int seat) const;
+
+    // 已完成的局数（统计用）
+    int gamesPlayed() const { return gamesPlayed_; }
+    bool isStarted() const { return started_; }
+    // 四个座位的合法出牌索引占用的堆内存（统计用）
+    size_t moveIndexBytes() const;
+
+    // 检查点：只能在分片线程内调用；恢复应在牌桌创建后、任何客户端入座前进行
+    void saveCheckpoint(TableCheckpoint::Record& out) const;
+    bool restoreCheckpoint(const TableCheckpoint::Record& in);
+
+    // TurnScheduler：延时按分片的 delayScale 缩放
+    void schedule(int delayMs, std::function<void()> task) override;
+    // 空闲任务交给分片的空闲队列，牌桌停放后残留的任务直接丢弃
+    void scheduleIdle(IdleTask task) override;
+    // MoveDecider：交给分片的 MoveBatcher
+    void requestMove(AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank,
+                     std::function<void(std::vector<Card>)> done) override;
+
+private:
+    void startNextRound();
+    void scheduleNextRound();
+    void connectJudge();
+    // 远程座位被要求行动时开始计时，超时由 Judge 按 AI 规则代打
+    void armTimeout(int seat);
+
+    void encodeDelta(const StateDelta& delta, std::string& out) const;
+    void sendHand(int seat);
+    void sendPrivate(int seat, proto::SharedFrame frame);
+    void publish(proto::SharedFrame frame);
+
+    int tableId_;
+    TableShard* shard_;
+    uint64_t timerOwner_;
+    Judge* judge_;
+    std::vector<Player*> players_;
+    std::array<bool, 4> seated_{};
+    // 每个座位最近一次计时的编号，座位行动或重新计时后旧的超时任务自动失效
+    std::array<unsigned, 4> timeoutSerial_{};
+    bool started_ = false;
+    bool matchOver_ = false;
+    int gamesPlayed_ = 0;
+};
+
+#endif // SERVERTABLE_H
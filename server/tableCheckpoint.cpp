@@ -0,0 +1,134 @@
+#include "tableCheckpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'D', 'C', 'K', 'P', 'T', '\0', '\0'};
+constexpr uint32_t kFormatVersion = 2;
+
+} // namespace
+
+struct TableCheckpoint::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize; // 记录或快照结构变化时旧文件自动作废
+    uint32_t tableCount;
+    uint32_t reserved;
+};
+
+TableCheckpoint::~TableCheckpoint() {
+    unmap();
+    if (writable_ && !tempPath_.empty()) ::unlink(tempPath_.c_str()); // 未 commit 的临时文件
+}
+
+void TableCheckpoint::unmap() {
+    if (base_) ::munmap(base_, size_);
+    if (fd_ >= 0) ::close(fd_);
+    base_ = nullptr;
+    fd_ = -1;
+    size_ = 0;
+}
+
+bool TableCheckpoint::create(const std::string& path, int tableCount) {
+    unmap();
+    path_ = path;
+    tempPath_ = path + ".tmp";
+    tableCount_ = std::max(tableCount, 0);
+    writable_ = true;
+    size_ = sizeof(Header) + static_cast<size_t>(tableCount_) * sizeof(Record);
+
+    fd_ = ::open(tempPath_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::perror("TableCheckpoint: open");
+        return false;
+    }
+    // 新扩展的区域全部为零，flags 为 0 的槽位即未开局的牌桌，恢复时跳过
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) < 0) {
+        std::perror("TableCheckpoint: ftruncate");
+        unmap();
+        return false;
+    }
+    base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        std::perror("TableCheckpoint: mmap");
+        base_ = nullptr;
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+bool TableCheckpoint::commit() {
+    if (!writable_ || !base_) return false;
+    // 文件头最后写：没写完的临时文件即使被误用也会因 magic 不符被拒绝
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.recordSize = sizeof(Record);
+    header.tableCount = static_cast<uint32_t>(tableCount_);
+    std::memcpy(base_, &header, sizeof(header));
+
+    const bool synced = ::msync(base_, size_, MS_SYNC) == 0;
+    unmap();
+    if (!synced || ::rename(tempPath_.c_str(), path_.c_str()) < 0) {
+        std::perror("TableCheckpoint: commit");
+        ::unlink(tempPath_.c_str());
+        tempPath_.clear();
+        return false;
+    }
+    tempPath_.clear();
+    return true;
+}
+
+bool TableCheckpoint::open(const std::string& path) {
+    unmap();
+    path_ = path;
+    writable_ = false;
+
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) return false; // 首次启动没有检查点
+    struct stat st{};
+    if (::fstat(fd_, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        unmap();
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    // MAP_POPULATE：一次性把整个文件读进页缓存，恢复时不再逐页缺页
+    base_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        std::perror("TableCheckpoint: mmap");
+        base_ = nullptr;
+        unmap();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, base_, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion
+        || header.recordSize != sizeof(Record)
+        || size_ < sizeof(Header) + static_cast<size_t>(header.tableCount) * sizeof(Record)) {
+        std::fprintf(stderr, "TableCheckpoint: %s is not a compatible checkpoint, ignored\n", path.c_str());
+        unmap();
+        return false;
+    }
+    tableCount_ = static_cast<int>(header.tableCount);
+    return true;
+}
+
+TableCheckpoint::Record* TableCheckpoint::record(int table) {
+    if (!writable_ || !base_ || table < 0 || table >= tableCount_) return nullptr;
+    return reinterpret_cast<Record*>(static_cast<char*>(base_) + sizeof(Header)) + table;
+}
+
+const TableCheckpoint::Record* TableCheckpoint::record(int table) const {
+    if (!base_ || table < 0 || table >= tableCount_) return nullptr;
+    const Record* rec = reinterpret_cast<const Record*>(static_cast<const char*>(base_) + sizeof(Header)) + table;
+    if (!(rec->flags & RecordStarted) || rec->tableId != static_cast<uint32_t>(table)) return nullptr;
+    return rec;
+}
@@ -0,0 +1,66 @@
+#ifndef TABLECHECKPOINT_H
+#define TABLECHECKPOINT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "judge.h"
+
+// 所有牌桌的检查点文件：定长文件头 + 按全局牌桌编号排列的定长记录，整个文件内存映射。
+// 写入时先映射临时文件，各分片线程并行把自己的牌桌写进各自的槽位（互不重叠，无需加锁），
+// 全部写完后补上文件头、msync，再 rename 覆盖旧文件，崩溃时旧检查点仍然完整。
+// 恢复时只读映射，各分片直接按编号取自己牌桌的记录。
+class TableCheckpoint {
+public:
+    struct Record {
+        uint32_t tableId;
+        uint8_t flags;        // bit0 已开局，bit1 整场已结束、下一局重新从打2开始
+        uint8_t reserved[3];
+        uint32_t gamesPlayed;
+        JudgeSnapshot judge;
+    };
+
+    enum RecordFlag : uint8_t {
+        RecordStarted = 1u << 0,
+        RecordMatchOver = 1u << 1
+    };
+
+    TableCheckpoint() = default;
+    ~TableCheckpoint();
+    TableCheckpoint(const TableCheckpoint&) = delete;
+    TableCheckpoint& operator=(const TableCheckpoint&) = delete;
+
+    // 写入：在 path 旁边创建临时文件并映射出 tableCount 个空记录
+    bool create(const std::string& path, int tableCount);
+    // 写入：所有记录写完后调用，落盘并原子替换 path
+    bool commit();
+
+    // 恢复：只读映射并校验文件头，文件不存在或格式不符时返回 false
+    bool open(const std::string& path);
+
+    int tableCount() const { return tableCount_; }
+    // 写入时可写；恢复时未写入过的槽位返回 nullptr
+    Record* record(int table);
+    const Record* record(int table) const;
+
+    // 由各分片写完自己的牌桌后调用，主线程据此判断何时 commit
+    void setPendingWriters(int count) { pendingWriters_ = count; }
+    void writerDone() { pendingWriters_.fetch_sub(1, std::memory_order_acq_rel); }
+    bool allWritten() const { return pendingWriters_.load(std::memory_order_acquire) <= 0; }
+
+private:
+    struct Header;
+    void unmap();
+
+    std::string path_;
+    std::string tempPath_;
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    int tableCount_ = 0;
+    bool writable_ = false;
+    std::atomic<int> pendingWriters_{0};
+};
+
+#endif // TABLECHECKPOINT_H
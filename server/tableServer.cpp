@@ -0,0 +1,273 @@
+#include "tableServer.h"
+#include "tableShard.h"
+#include "tableCheckpoint.h"
+#include "decisionCache.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <malloc.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kMaxEpollEvents = 64;
+constexpr int kStatsIntervalMs = 5000;
+
+} // namespace
+
+TableServer::TableServer(int shardCount) {
+    if (shardCount <= 0) shardCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<TableShard>(this, i, shardCount));
+    }
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) std::perror("TableServer: epoll_create1");
+}
+
+TableServer::~TableServer() {
+    shards_.clear(); // 先停掉分片线程
+    for (int fd : listenFds_) ::close(fd);
+    for (const auto& path : unixPaths_) ::unlink(path.c_str());
+    if (epollFd_ >= 0) ::close(epollFd_);
+}
+
+void TableServer::setCheckpoint(const std::string& path, int intervalMs) {
+    checkpointPath_ = path;
+    checkpointIntervalMs_ = std::max(intervalMs, 0);
+}
+
+void TableServer::setDecisionCache(size_t entries) {
+    decisionCache_ = entries > 0 ? std::make_unique<DecisionCache>(entries) : nullptr;
+}
+
+void TableServer::createTables(int count, bool autoplay) {
+    tableCount_ = count;
+    autoplay_ = autoplay;
+}
+
+bool TableServer::addListener(int fd) {
+    if (::listen(fd, SOMAXCONN) < 0) {
+        std::perror("TableServer: listen");
+        ::close(fd);
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        std::perror("TableServer: epoll_ctl");
+        ::close(fd);
+        return false;
+    }
+    listenFds_.push_back(fd);
+    return true;
+}
+
+bool TableServer::listenTcp(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::perror("TableServer: socket");
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // 仅本机
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::perror("TableServer: bind tcp");
+        ::close(fd);
+        return false;
+    }
+    return addListener(fd);
+}
+
+bool TableServer::listenUnix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::fprintf(stderr, "TableServer: unix socket path too long: %s\n", path.c_str());
+        return false;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::perror("TableServer: socket");
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::perror("TableServer: bind unix");
+        ::close(fd);
+        return false;
+    }
+    unixPaths_.push_back(path);
+    return addListener(fd);
+}
+
+void TableServer::startShards() {
+    TableCheckpoint restore;
+    const bool restoring = !checkpointPath_.empty() && restore.open(checkpointPath_);
+    const auto begin = std::chrono::steady_clock::now();
+
+    // 分片线程屏蔽所有信号，SIGINT/SIGTERM 只会打断主线程的 epoll_wait
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    for (auto& shard : shards_) {
+        shard->configure(tableCount_, autoplay_, delayScale_, turnTimeoutMs_, pinThreads_, restoring ? &restore : nullptr);
+        shard->setMoveBatching(moveBatchMax_, moveBatchDelayMs_);
+        shard->setDecisionCache(decisionCache_.get());
+        shard->setAiThinkBudget(std::chrono::microseconds(std::max(aiThinkBudgetUs_, 0)));
+        shard->setAiPonderBudgetMs(std::max(aiPonderBudgetMs_, 0));
+        shard->start();
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    if (!restoring) return;
+
+    // 恢复期间映射必须保持有效，等各分片建完牌桌再解除
+    for (auto& shard : shards_) {
+        while (!shard->ready.load(std::memory_order_acquire)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int restored = 0;
+    for (auto& shard : shards_) restored += shard->restoredTables.load(std::memory_order_relaxed);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::printf("tableServer: restored %d tables from %s in %.1f ms\n", restored, checkpointPath_.c_str(), ms);
+    std::fflush(stdout);
+}
+
+void TableServer::beginCheckpoint() {
+    if (checkpoint_) return;
+    checkpoint_ = std::make_unique<TableCheckpoint>();
+    if (!checkpoint_->create(checkpointPath_, tableCount_)) {
+        checkpoint_.reset();
+        return;
+    }
+    checkpoint_->setPendingWriters(shardCount());
+    for (auto& shard : shards_) shard->requestCheckpoint(checkpoint_.get());
+}
+
+void TableServer::finishCheckpoint(bool wait) {
+    if (!checkpoint_) return;
+    while (!checkpoint_->allWritten()) {
+        if (!wait) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    checkpoint_->commit();
+    checkpoint_.reset();
+}
+
+void TableServer::run() {
+    running_ = true;
+    startShards();
+
+    auto lastStats = std::chrono::steady_clock::now();
+    auto lastCheckpoint = lastStats;
+    epoll_event events[kMaxEpollEvents];
+    while (running_) {
+        const int n = epoll_wait(epollFd_, events, kMaxEpollEvents, 1000);
+        if (n < 0 && errno != EINTR) {
+            std::perror("TableServer: epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) acceptAll(events[i].data.fd);
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastStats >= std::chrono::milliseconds(kStatsIntervalMs)) {
+            lastStats = now;
+            printStats();
+        }
+        if (!checkpointPath_.empty()) {
+            finishCheckpoint(false);
+            if (checkpointIntervalMs_ > 0 && now - lastCheckpoint >= std::chrono::milliseconds(checkpointIntervalMs_)) {
+                lastCheckpoint = now;
+                beginCheckpoint();
+            }
+        }
+    }
+
+    // 停机前写最后一次检查点，分片线程此时仍在运行
+    if (!checkpointPath_.empty()) {
+        finishCheckpoint(true);
+        beginCheckpoint();
+        finishCheckpoint(true);
+    }
+
+    for (auto& shard : shards_) shard->stop();
+    for (auto& shard : shards_) shard->join();
+}
+
+void TableServer::acceptAll(int listenFd) {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) std::perror("TableServer: accept");
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Unix 套接字上会失败，忽略即可
+
+        // 还不知道要去哪张桌，先轮流分给各分片；JOIN 时再转交给牌桌所在分片
+        shards_[nextShard_++ % shards_.size()]->adopt(fd, std::string());
+    }
+}
+
+long long TableServer::totalGamesPlayed() const {
+    long long total = 0;
+    for (const auto& shard : shards_) total += shard->gamesFinished.load(std::memory_order_relaxed);
+    return total;
+}
+
+int TableServer::connectionCount() const {
+    int total = 0;
+    for (const auto& shard : shards_) total += shard->connections.load(std::memory_order_relaxed);
+    return total;
+}
+
+void TableServer::printStats() const {
+    int live = 0, parked = 0;
+    long long decisions = 0, batches = 0, indexBytes = 0;
+    for (const auto& shard : shards_) {
+        live += shard->liveTables.load(std::memory_order_relaxed);
+        parked += shard->parkedTables.load(std::memory_order_relaxed);
+        decisions += shard->aiDecisions.load(std::memory_order_relaxed);
+        batches += shard->aiBatches.load(std::memory_order_relaxed);
+        indexBytes += shard->moveIndexBytes.load(std::memory_order_relaxed);
+    }
+    // 占用按整个进程的堆统计（含连接缓冲区），摊到每张牌桌上作为内存占用的上界
+    const struct mallinfo2 heap = mallinfo2();
+    const double heapBytes = static_cast<double>(heap.uordblks + heap.hblkhd);
+    std::printf("tableServer: %d tables on %d shards, %d connections, %lld games finished\n",
+                tableCount_, shardCount(), connectionCount(), totalGamesPlayed());
+    std::printf("tableServer: %d live / %d parked tables (record %zu B), heap %.1f MB = %.0f B/table\n",
+                live, parked, sizeof(TableCheckpoint::Record), heapBytes / (1024.0 * 1024.0),
+                tableCount_ > 0 ? heapBytes / tableCount_ : 0.0);
+    // 驻留牌桌里四个 AI 的合法出牌索引（已计入上面的堆占用），停放的牌桌不占
+    std::printf("tableServer: AI move index %.1f KB = %.0f B/live table\n",
+                static_cast<double>(indexBytes) / 1024.0, live > 0 ? static_cast<double>(indexBytes) / live : 0.0);
+    if (moveBatchMax_ > 0) {
+        std::printf("tableServer: %lld batched AI decisions in %lld batches (%.1f per batch)\n",
+                    decisions, batches, batches > 0 ? static_cast<double>(decisions) / batches : 0.0);
+    }
+    if (decisionCache_) {
+        const DecisionCache::Stats cache = decisionCache_->stats();
+        std::printf("tableServer: AI cache %.1f%% hits of %llu lookups, %llu evictions, %llu skipped (%zu entries)\n",
+                    cache.hitRate() * 100.0, static_cast<unsigned long long>(cache.lookups),
+                    static_cast<unsigned long long>(cache.evictions), static_cast<unsigned long long>(cache.skipped),
+                    decisionCache_->capacity());
+    }
+    std::fflush(stdout);
+}
@@ -0,0 +1,90 @@
+#ifndef TABLESERVER_H
+#define TABLESERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TableShard;
+class TableCheckpoint;
+class DecisionCache;
+
+// 多牌桌服务器：牌桌按编号分到若干分片（默认每个核一个），每个分片一个线程、一个 epoll 循环、
+// 一个分层时间轮，AI 思考延时、进贡步骤和玩家超时都挂在所属分片的时间轮上。
+// 主线程只负责 accept，新连接轮流交给各分片；客户端 Join 到别的分片的牌桌时连接随之转交。
+// 线上格式见 protocol.h。
+class TableServer {
+public:
+    // shardCount 为 0 时取 CPU 核数
+    explicit TableServer(int shardCount = 0);
+    ~TableServer();
+
+    // 以下配置须在 run() 之前调用
+    // 创建 count 张牌桌；autoplay 为 true 时立即开局（无人入座时全部由 AI 打）
+    void createTables(int count, bool autoplay);
+    // AI 思考等延时的缩放系数，压测时可设为 0 让牌桌全速推进
+    void setDelayScale(double scale) { delayScale_ = scale; }
+    // 远程玩家的行动时限（毫秒），到时由 AI 代打；0 表示不限时
+    void setTurnTimeoutMs(int ms) { turnTimeoutMs_ = ms; }
+    void setPinThreads(bool pin) { pinThreads_ = pin; }
+    // 每个分片把各牌桌的 AI 决策攒成最多 maxBatch 个一批处理，单个请求最多排队 maxDelayMs；maxBatch 为 0 时关闭
+    void setMoveBatching(int maxBatch, int maxDelayMs) { moveBatchMax_ = maxBatch; moveBatchDelayMs_ = maxDelayMs; }
+    // 所有分片共用一个最多约 entries 条的 AI 决策缓存（同手牌、同局面直接取并列最优）；0 表示关闭
+    void setDecisionCache(size_t entries);
+    // AI 同步决策时每步最多搜索 us 微秒，到时取目前最好的一手；0 表示只用启发式（批量决策总是只用启发式）
+    void setAiThinkBudget(int us) { aiThinkBudgetUs_ = us; }
+    // 同步决策时，AI 在别人回合里最多用 ms 毫秒预想自己的下一手；0 表示关闭
+    void setAiPonderBudget(int ms) { aiPonderBudgetMs_ = ms; }
+    // 每隔 intervalMs 把所有已开局牌桌写进 path（内存映射文件），退出时再写一次；
+    // 启动时 path 已有兼容的检查点则先从中恢复
+    void setCheckpoint(const std::string& path, int intervalMs);
+
+    // 监听 127.0.0.1:port 以及可选的 Unix 域套接字
+    bool listenTcp(uint16_t port);
+    bool listenUnix(const std::string& path);
+
+    // 启动各分片线程并在当前线程 accept，直到 stop() 被调用（可在信号处理函数中调用）
+    void run();
+    void stop() { running_ = false; }
+
+    int shardCount() const { return static_cast<int>(shards_.size()); }
+    TableShard* shardForTable(int table) const { return shards_[table % shards_.size()].get(); }
+
+    int tableCount() const { return tableCount_; }
+    long long totalGamesPlayed() const;
+    int connectionCount() const;
+
+private:
+    bool addListener(int fd);
+    void acceptAll(int listenFd);
+    void printStats() const;
+    void startShards();
+    // 向所有分片发起一次检查点；上一次还没写完时不重复发起
+    void beginCheckpoint();
+    void finishCheckpoint(bool wait);
+
+    std::vector<std::unique_ptr<TableShard>> shards_;
+    int tableCount_ = 0;
+    bool autoplay_ = false;
+    double delayScale_ = 1.0;
+    int turnTimeoutMs_ = 30000;
+    bool pinThreads_ = true;
+    int moveBatchMax_ = 0;
+    int moveBatchDelayMs_ = 2;
+    int aiThinkBudgetUs_ = 0;
+    int aiPonderBudgetMs_ = 0;
+    std::string checkpointPath_;
+    int checkpointIntervalMs_ = 0;
+    std::unique_ptr<TableCheckpoint> checkpoint_; // 正在写的检查点
+    std::unique_ptr<DecisionCache> decisionCache_;
+
+    int epollFd_ = -1;
+    std::vector<int> listenFds_;
+    std::vector<std::string> unixPaths_;
+    size_t nextShard_ = 0;
+    std::atomic<bool> running_{false};
+};
+
+#endif // TABLESERVER_H
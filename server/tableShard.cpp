@@ -0,0 +1,683 @@
+#include "tableShard.h"
+#include "serverTable.h"
+#include "tableServer.h"
+#include "tableCheckpoint.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kMaxOutputBacklog = 1 << 20; // 客户端读得太慢时直接断开
+constexpr int kMaxEpollEvents = 256;
+constexpr int kStatsIntervalMs = 1000;
+constexpr int kMaxIov = 64;
+
+} // namespace
+
+TableShard::TableShard(TableServer* server, int index, int shardCount)
+    : server_(server), index_(index), shardCount_(std::max(shardCount, 1))
+{
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        std::perror("TableShard: epoll/eventfd");
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+}
+
+TableShard::~TableShard() {
+    stop();
+    join();
+    for (auto& adopted : inbox_) ::close(adopted.fd);
+    if (wakeFd_ >= 0) ::close(wakeFd_);
+    if (epollFd_ >= 0) ::close(epollFd_);
+}
+
+void TableShard::configure(int totalTables, bool autoplay, double delayScale, int turnTimeoutMs, bool pinToCore,
+                           const TableCheckpoint* restoreFrom) {
+    totalTables_ = totalTables;
+    restoreFrom_ = restoreFrom;
+    autoplay_ = autoplay;
+    delayScale_ = delayScale;
+    turnTimeoutMs_ = turnTimeoutMs;
+    pinToCore_ = pinToCore;
+}
+
+void TableShard::start() {
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void TableShard::stop() {
+    running_ = false;
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void TableShard::join() {
+    if (thread_.joinable()) thread_.join();
+}
+
+void TableShard::adopt(int fd, std::string pendingInput, uint8_t version,
+                       std::deque<proto::SharedFrame> pendingOutput, size_t outOffset) {
+    {
+        std::lock_guard<std::mutex> locker(inboxLock_);
+        inbox_.push_back({fd, std::move(pendingInput), version, std::move(pendingOutput), outOffset});
+    }
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+uint64_t TableShard::nowTick() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch_).count());
+}
+
+void TableShard::schedule(int delayMs, std::function<void()> task) {
+    const double scaled = std::max(delayMs, 0) * delayScale_;
+    wheel_.schedule(static_cast<uint64_t>(std::llround(scaled)), std::move(task));
+}
+
+void TableShard::scheduleWallClock(int delayMs, std::function<void()> task) {
+    wheel_.schedule(static_cast<uint64_t>(std::max(delayMs, 0)), std::move(task));
+}
+
+void TableShard::scheduleFor(uint64_t owner, int delayMs, std::function<void()> task, bool wallClock) {
+    const double scaled = std::max(delayMs, 0) * (wallClock ? 1.0 : delayScale_);
+    wheel_.schedule(static_cast<uint64_t>(std::llround(scaled)), std::move(task), owner);
+}
+
+void TableShard::scheduleIdleFor(uint64_t owner, IdleTask task) {
+    if (idleTasks_.size() >= kMaxIdleTasks) idleTasks_.pop_front();
+    idleTasks_.push_back({owner, std::move(task)});
+}
+
+void TableShard::runIdleTask(Clock::time_point deadline) {
+    IdleEntry entry = std::move(idleTasks_.front());
+    idleTasks_.pop_front();
+    if (entry.owner != 0 && !isTimerOwnerAlive(entry.owner)) return;
+    entry.task(deadline);
+}
+
+void TableShard::setMoveBatching(int maxBatch, int maxDelayMs) {
+    moveBatchMax_ = std::max(maxBatch, 0);
+    moveBatchDelayMs_ = std::max(maxDelayMs, 0);
+    batcher_ = MoveBatcher(static_cast<size_t>(std::max(moveBatchMax_, 1)));
+    batcher_.setDecisionCache(decisionCache_);
+}
+
+void TableShard::setDecisionCache(DecisionCache* cache) {
+    decisionCache_ = cache;
+    batcher_.setDecisionCache(cache);
+}
+
+void TableShard::requestMove(uint64_t owner, AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank,
+                             MoveBatcher::Done done) {
+    // 凑满一批时下一个 tick 处理，否则最多等 moveBatchDelayMs_；先到的任务把队列处理完后，后到的直接返回
+    const bool first = batcher_.pending() == 0;
+    if (batcher_.submit(owner, ai, lastCards, levelRank, std::move(done))) {
+        scheduleWallClock(0, [this]() { batcher_.flush(); });
+    } else if (first) {
+        scheduleWallClock(moveBatchDelayMs_, [this]() { batcher_.flush(); });
+    }
+}
+
+bool TableShard::isTimerOwnerAlive(uint64_t owner) const {
+    // 代号 = (本分片内序号 + 1) << 32 | 创建代数
+    const uint64_t local = (owner >> 32) - 1;
+    if (local >= slots_.size()) return false;
+    const TableSlot& slot = slots_[local];
+    return slot.live && slot.generation == static_cast<uint32_t>(owner);
+}
+
+ServerTable* TableShard::materialize(int table) {
+    TableSlot& slot = slots_[table / shardCount_];
+    if (slot.live) return slot.live.get();
+
+    ++slot.generation;
+    const uint64_t owner = (static_cast<uint64_t>(table / shardCount_ + 1) << 32) | slot.generation;
+    slot.live = std::make_unique<ServerTable>(table, this, owner);
+    ++liveTables;
+    if (slot.parked) {
+        slot.live->restoreCheckpoint(*slot.parked);
+        slot.parked.reset();
+        --parkedTables;
+    }
+    return slot.live.get();
+}
+
+bool TableShard::parkIfIdle(int table) {
+    TableSlot& slot = slots_[table / shardCount_];
+    if (autoplay_ || !slot.live || hasAudience(table) || slot.live->hasPendingEvents()) return false;
+
+    auto record = std::make_unique<TableCheckpoint::Record>();
+    slot.live->saveCheckpoint(*record);
+    slot.parked = std::move(record);
+    slot.live.reset(); // 残留的定时任务因代号失效被时间轮丢弃
+    --liveTables;
+    ++parkedTables;
+    return true;
+}
+
+void TableShard::createTables() {
+    slots_.resize(static_cast<size_t>(std::max(0, (totalTables_ - index_ + shardCount_ - 1) / shardCount_)));
+    seatFds_.assign(slots_.size() * 4, -1);
+    spectatorFds_.assign(slots_.size(), {});
+    wheel_.setOwnerCheck([this](uint64_t owner) { return isTimerOwnerAlive(owner); });
+    batcher_.setOwnerCheck([this](uint64_t owner) { return isTimerOwnerAlive(owner); });
+
+    // 检查点只读映射，各分片并行恢复自己的牌桌；已开局的记录先原样停放，
+    // 有人入座、观战或 autoplay 开局时才恢复成完整牌桌（恢复出的牌桌已开局，autoplay 的开局任务会直接跳过）
+    if (restoreFrom_) {
+        int restored = 0;
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            const int tableId = index_ + static_cast<int>(i) * shardCount_;
+            const TableCheckpoint::Record* rec = restoreFrom_->record(tableId);
+            if (!rec || !Judge::isValidSnapshot(rec->judge)) continue;
+            slots_[i].parked = std::make_unique<TableCheckpoint::Record>(*rec);
+            ++restored;
+        }
+        restoredTables = restored;
+        parkedTables = restored;
+        restoreFrom_ = nullptr;
+    }
+
+    if (!autoplay_) return;
+    // 错开开局时间，避免同一分片内所有牌桌的 AI 延时落在同一个槽里
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        ServerTable* table = materialize(index_ + static_cast<int>(i) * shardCount_);
+        scheduleWallClock(static_cast<int>(i % 1000), [this, tableId = table->id()]() {
+            if (ServerTable* live = localTable(tableId)) live->start();
+        });
+    }
+}
+
+void TableShard::run() {
+    if (pinToCore_) {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(static_cast<int>(index_ % cores), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set); // 失败时退化为不绑核
+    }
+
+    // 牌桌在分片线程里创建，Judge/AIPlayer 的内存就近分配，QObject 也归属本线程
+    epoch_ = Clock::now();
+    createTables();
+    ready = true;
+    scheduleWallClock(kStatsIntervalMs, [this]() { publishStats(); });
+
+    epoll_event events[kMaxEpollEvents];
+    while (running_) {
+        wheel_.advance(nowTick());
+        flushOutputs();
+        closePending();
+        if (TableCheckpoint* checkpoint = checkpointRequest_.exchange(nullptr)) writeCheckpoint(*checkpoint);
+
+        // 按墙钟算到下一个到期 tick 还要多久（向上取整），不会在同一毫秒里反复 epoll_wait(0) 空转
+        int timeout = 1000;
+        if (wheel_.hasReady()) {
+            timeout = 0;
+        } else if (const int64_t ticks = wheel_.ticksUntilNext(); ticks >= 0) {
+            const auto due = epoch_ + std::chrono::milliseconds(wheel_.currentTick() + static_cast<uint64_t>(ticks));
+            const auto wait = std::chrono::ceil<std::chrono::milliseconds>(due - Clock::now()).count();
+            timeout = static_cast<int>(std::clamp<int64_t>(wait, 0, 1000));
+        }
+        // 有空闲任务时先不等待地看一眼 I/O；什么都没有才执行一个，时限到下一个定时任务为止
+        int n = 0;
+        if (!idleTasks_.empty() && timeout > 0) {
+            n = epoll_wait(epollFd_, events, kMaxEpollEvents, 0);
+            if (n == 0) {
+                runIdleTask(Clock::now() + std::chrono::milliseconds(timeout));
+                continue;
+            }
+        } else {
+            n = epoll_wait(epollFd_, events, kMaxEpollEvents, timeout);
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::perror("TableShard: epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                uint64_t count = 0;
+                ssize_t ignored = ::read(wakeFd_, &count, sizeof(count));
+                (void)ignored;
+                drainInbox();
+                continue;
+            }
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            Connection& conn = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                markClosing(conn);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                handleReadable(conn);
+                // 入座/观战可能把连接移交给别的分片（handOff 会把它从 connections_ 删掉），重新查一次
+                it = connections_.find(fd);
+                if (it == connections_.end()) continue;
+            }
+            if (events[i].events & EPOLLOUT) handleWritable(it->second);
+        }
+        processTableEvents();
+        flushOutputs();
+        closePending();
+    }
+
+    // 退出前还有未处理的检查点请求时照常写完，主线程不会一直等下去
+    if (TableCheckpoint* checkpoint = checkpointRequest_.exchange(nullptr)) writeCheckpoint(*checkpoint);
+
+    // 在本线程内拆掉连接和牌桌
+    for (auto& [fd, conn] : connections_) ::close(fd);
+    connections_.clear();
+    slots_.clear();
+    liveTables = 0;
+    parkedTables = 0;
+    connections = 0;
+}
+
+void TableShard::requestCheckpoint(TableCheckpoint* checkpoint) {
+    checkpointRequest_ = checkpoint;
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void TableShard::writeCheckpoint(TableCheckpoint& checkpoint) {
+    // 每张牌桌的记录在两次分片循环之间写出，单桌状态自洽；未开局的牌桌留空，停放的牌桌直接复制记录
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        const TableSlot& slot = slots_[i];
+        TableCheckpoint::Record* rec = checkpoint.record(index_ + static_cast<int>(i) * shardCount_);
+        if (!rec) continue;
+        if (slot.parked) *rec = *slot.parked;
+        else if (slot.live && slot.live->isStarted()) slot.live->saveCheckpoint(*rec);
+    }
+    checkpoint.writerDone();
+}
+
+void TableShard::drainInbox() {
+    std::vector<Adopted> adopted;
+    {
+        std::lock_guard<std::mutex> locker(inboxLock_);
+        adopted.swap(inbox_);
+    }
+    for (auto& item : adopted) addConnection(std::move(item));
+}
+
+void TableShard::addConnection(Adopted&& adopted) {
+    const int fd = adopted.fd;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        ::close(fd);
+        return;
+    }
+    Connection& conn = connections_[fd];
+    conn.fd = fd;
+    conn.in = std::move(adopted.input);
+    conn.version = adopted.version;
+    // 原分片没发完的输出排在最前，之后本分片的回复接在后面，对端收到的次序不变
+    conn.out = std::move(adopted.output);
+    conn.outOffset = conn.out.empty() ? 0 : adopted.outOffset;
+    for (const auto& frame : conn.out) conn.outBytes += frame->size();
+    conn.outBytes -= conn.outOffset;
+    if (!conn.out.empty()) {
+        conn.dirty = true;
+        dirtyFds_.push_back(fd);
+    }
+    // 转交过来的连接可能已经带着完整的命令
+    if (!conn.in.empty()) processInput(conn);
+}
+
+void TableShard::handleReadable(Connection& conn) {
+    if (conn.closing) return;
+    char buf[4096];
+    for (;;) {
+        const ssize_t n = ::read(conn.fd, buf, sizeof(buf));
+        if (n > 0) {
+            conn.in.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) markClosing(conn);
+        break;
+    }
+    processInput(conn);
+}
+
+void TableShard::processInput(Connection& conn) {
+    size_t start = 0;
+    proto::FrameView frame;
+    for (;;) {
+        const size_t used = proto::peekFrame(conn.in.data() + start, conn.in.size() - start, frame);
+        if (used == 0) break;
+        const size_t frameStart = start;
+        start += used;
+        if (!handleFrame(conn, frame, frameStart)) return; // 已转交，conn 失效
+        if (conn.closing) break;
+    }
+    conn.in.erase(0, start);
+}
+
+bool TableShard::handleFrame(Connection& conn, const proto::FrameView& frame, size_t frameStart) {
+    using proto::ErrorCode;
+    using proto::MsgType;
+
+    if (conn.version == 0) {
+        if (frame.type != MsgType::Hello || frame.size < 1) {
+            sendError(conn, ErrorCode::NotGreeted);
+            markClosing(conn);
+            return true;
+        }
+        if (frame.payload[0] != proto::kVersion) {
+            sendError(conn, ErrorCode::BadVersion);
+            markClosing(conn);
+            return true;
+        }
+        conn.version = frame.payload[0];
+        sendFrame(conn, proto::makeShared([](std::string& out) {
+            proto::FrameWriter(out, MsgType::Welcome).u8(proto::kVersion);
+        }));
+        return true;
+    }
+
+    if (frame.type == MsgType::Join) return handleJoin(conn, frame, frameStart);
+    if (frame.type == MsgType::Watch) return handleWatch(conn, frame, frameStart);
+    if (frame.type == MsgType::Leave) {
+        releaseSeat(conn);
+        return true;
+    }
+
+    if (conn.table < 0 || conn.spectator) {
+        sendError(conn, ErrorCode::NotSeated);
+        return true;
+    }
+    ServerTable* table = localTable(conn.table);
+    const bool idle = !table->hasPendingEvents();
+    bool queued = false;
+
+    // 座位操作只做格式校验并入队，规则校验在本轮末尾统一进行，失败时由牌桌回 Error
+    switch (frame.type) {
+    case MsgType::Play:
+        // 牌 id 在接收缓冲区里就地解码到复用的数组
+        if (frame.size == 0 || !proto::readCards(frame.payload, frame.size, scratchCards_)) {
+            sendError(conn, ErrorCode::InvalidPlay);
+            break;
+        }
+        queued = table->post(conn.seat, SeatAction::Play, scratchCards_);
+        break;
+    case MsgType::Pass:
+        queued = table->post(conn.seat, SeatAction::Pass);
+        break;
+    case MsgType::Tribute:
+        if (frame.size != 1 || !proto::readCards(frame.payload, 1, scratchCards_)) {
+            sendError(conn, ErrorCode::InvalidTribute);
+            break;
+        }
+        queued = table->post(conn.seat, SeatAction::Tribute, scratchCards_);
+        break;
+    default:
+        sendError(conn, ErrorCode::BadFrame);
+        break;
+    }
+    if (queued && idle) eventTables_.push_back(conn.table);
+    return true;
+}
+
+void TableShard::processTableEvents() {
+    // 同一桌来自多个座位的操作按到达顺序一次处理完
+    for (int table : eventTables_) localTable(table)->processEvents();
+    eventTables_.clear();
+}
+
+bool TableShard::handleJoin(Connection& conn, const proto::FrameView& frame, size_t frameStart) {
+    using proto::ErrorCode;
+
+    if (conn.table >= 0) { sendError(conn, ErrorCode::AlreadySeated); return true; }
+    if (frame.size != 5) { sendError(conn, ErrorCode::BadFrame); return true; }
+    const uint32_t tableId = proto::readU32(frame.payload);
+    const int seat = frame.payload[4];
+    if (tableId >= static_cast<uint32_t>(totalTables_) || seat >= 4) {
+        sendError(conn, ErrorCode::BadSeat);
+        return true;
+    }
+    if (!ownsTable(static_cast<int>(tableId))) {
+        handOff(conn, static_cast<int>(tableId), frameStart);
+        return false;
+    }
+    ServerTable* table = materialize(static_cast<int>(tableId));
+    if (table->isSeatTaken(seat)) { sendError(conn, ErrorCode::SeatTaken); return true; }
+    // 先登记座位，join 过程中补发的状态才能送达
+    seatFd(static_cast<int>(tableId), seat) = conn.fd;
+    conn.table = static_cast<int>(tableId);
+    conn.seat = seat;
+    table->join(seat);
+    return true;
+}
+
+bool TableShard::handleWatch(Connection& conn, const proto::FrameView& frame, size_t frameStart) {
+    using proto::ErrorCode;
+
+    if (conn.table >= 0) { sendError(conn, ErrorCode::AlreadySeated); return true; }
+    if (frame.size != 4) { sendError(conn, ErrorCode::BadFrame); return true; }
+    const uint32_t tableId = proto::readU32(frame.payload);
+    if (tableId >= static_cast<uint32_t>(totalTables_)) {
+        sendError(conn, ErrorCode::BadSeat);
+        return true;
+    }
+    if (!ownsTable(static_cast<int>(tableId))) {
+        handOff(conn, static_cast<int>(tableId), frameStart);
+        return false;
+    }
+    ServerTable* table = materialize(static_cast<int>(tableId));
+    spectatorFds_[tableId / shardCount_].push_back(conn.fd);
+    conn.table = static_cast<int>(tableId);
+    conn.seat = -1;
+    conn.spectator = true;
+    sendFrame(conn, table->encodeSnapshot(proto::kSpectatorSeat));
+    return true;
+}
+
+void TableShard::handOff(Connection& conn, int table, size_t frameStart) {
+    // 未发完的输出先尽量写出；要关闭的连接（含这次写出错的）留在本分片关掉，不再转交
+    handleWritable(conn);
+    if (conn.closing) return;
+    // 连同这条请求及之后的输入、还没写出的输出一起转交
+    const int fd = conn.fd;
+    std::string rest = conn.in.substr(frameStart);
+    auto pending = std::move(conn.out);
+    const size_t outOffset = conn.outOffset;
+    const uint8_t version = conn.version;
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    connections_.erase(fd);
+    server_->shardForTable(table)->adopt(fd, std::move(rest), version, std::move(pending), outOffset);
+}
+
+void TableShard::sendError(Connection& conn, proto::ErrorCode code) {
+    sendFrame(conn, proto::makeShared([code](std::string& out) { proto::writeError(out, code); }));
+}
+
+void TableShard::sendFrame(Connection& conn, proto::SharedFrame frame) {
+    if (conn.closing || !frame || frame->empty()) return;
+    conn.outBytes += frame->size();
+    conn.out.push_back(std::move(frame));
+    if (conn.outBytes > kMaxOutputBacklog) {
+        markClosing(conn);
+        return;
+    }
+    // 同一轮里产生的多帧合并成一次 writev
+    if (!conn.dirty) {
+        conn.dirty = true;
+        dirtyFds_.push_back(conn.fd);
+    }
+}
+
+void TableShard::sendToSeat(int table, int seat, proto::SharedFrame frame) {
+    const int fd = seatFd(table, seat);
+    if (fd < 0) return;
+    auto it = connections_.find(fd);
+    if (it != connections_.end()) sendFrame(it->second, std::move(frame));
+}
+
+void TableShard::broadcast(int table, const proto::SharedFrame& frame) {
+    // 入座玩家和观战者拿到的是同一块内存，这里只增加引用计数
+    for (int seat = 0; seat < 4; ++seat) {
+        const int fd = seatFd(table, seat);
+        if (fd < 0) continue;
+        auto it = connections_.find(fd);
+        if (it != connections_.end()) sendFrame(it->second, frame);
+    }
+    for (int fd : spectatorFds_[table / shardCount_]) {
+        auto it = connections_.find(fd);
+        if (it != connections_.end()) sendFrame(it->second, frame);
+    }
+}
+
+bool TableShard::hasAudience(int table) const {
+    const size_t local = static_cast<size_t>(table / shardCount_);
+    if (!spectatorFds_[local].empty()) return true;
+    for (int seat = 0; seat < 4; ++seat) {
+        if (seatFds_[local * 4 + seat] >= 0) return true;
+    }
+    return false;
+}
+
+void TableShard::flushOutputs() {
+    for (int fd : dirtyFds_) {
+        auto it = connections_.find(fd);
+        if (it == connections_.end()) continue;
+        it->second.dirty = false;
+        handleWritable(it->second);
+    }
+    dirtyFds_.clear();
+}
+
+void TableShard::handleWritable(Connection& conn) {
+    if (conn.closing) return;
+    while (!conn.out.empty()) {
+        // 共享帧直接作为 iovec 写出，不拼接到连接私有的缓冲区
+        iovec iov[kMaxIov];
+        int count = 0;
+        size_t offset = conn.outOffset;
+        for (auto it = conn.out.begin(); it != conn.out.end() && count < kMaxIov; ++it) {
+            iov[count].iov_base = const_cast<char*>((*it)->data() + offset);
+            iov[count].iov_len = (*it)->size() - offset;
+            offset = 0;
+            ++count;
+        }
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(count);
+        const ssize_t n = ::sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            size_t sent = static_cast<size_t>(n);
+            conn.outBytes -= sent;
+            while (sent > 0) {
+                const size_t left = conn.out.front()->size() - conn.outOffset;
+                if (sent < left) {
+                    conn.outOffset += sent;
+                    break;
+                }
+                sent -= left;
+                conn.out.pop_front();
+                conn.outOffset = 0;
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        markClosing(conn);
+        return;
+    }
+    updateInterest(conn);
+}
+
+void TableShard::updateInterest(Connection& conn) {
+    const bool wantWrite = !conn.out.empty();
+    if (wantWrite == conn.wantWrite) return;
+    conn.wantWrite = wantWrite;
+    epoll_event ev{};
+    ev.events = EPOLLIN | (wantWrite ? EPOLLOUT : 0u);
+    ev.data.fd = conn.fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void TableShard::markClosing(Connection& conn) {
+    if (conn.closing) return;
+    conn.closing = true;
+    closingFds_.push_back(conn.fd);
+}
+
+void TableShard::closePending() {
+    // 关闭可能触发牌桌交回 AI 托管，必须在 Judge 调用栈之外进行
+    std::vector<int> pending;
+    pending.swap(closingFds_);
+    for (int fd : pending) closeConnection(fd);
+}
+
+void TableShard::releaseSeat(Connection& conn) {
+    if (conn.table < 0) return;
+    if (conn.spectator) {
+        auto& watchers = spectatorFds_[conn.table / shardCount_];
+        auto it = std::find(watchers.begin(), watchers.end(), conn.fd);
+        if (it != watchers.end()) {
+            *it = watchers.back();
+            watchers.pop_back();
+        }
+        conn.table = -1;
+        conn.spectator = false;
+        return;
+    }
+    seatFd(conn.table, conn.seat) = -1;
+    localTable(conn.table)->leave(conn.seat);
+    conn.table = -1;
+    conn.seat = -1;
+}
+
+void TableShard::closeConnection(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    releaseSeat(it->second);
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections_.erase(it);
+}
+
+void TableShard::publishStats() {
+    long long games = 0, indexBytes = 0;
+    for (const auto& slot : slots_) {
+        if (slot.live) {
+            games += slot.live->gamesPlayed();
+            indexBytes += static_cast<long long>(slot.live->moveIndexBytes());
+        } else if (slot.parked) {
+            games += slot.parked->gamesPlayed;
+        }
+    }
+    gamesFinished.store(games, std::memory_order_relaxed);
+    moveIndexBytes.store(indexBytes, std::memory_order_relaxed);
+    aiDecisions.store(static_cast<long long>(batcher_.stats().decisions), std::memory_order_relaxed);
+    aiBatches.store(static_cast<long long>(batcher_.stats().batches), std::memory_order_relaxed);
+    connections.store(static_cast<int>(connections_.size()), std::memory_order_relaxed);
+    scheduleWallClock(kStatsIntervalMs, [this]() { publishStats(); });
+}
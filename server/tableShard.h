@@ -0,0 +1,222 @@
+#ifndef TABLESHARD_H
+#define TABLESHARD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "deck.h"
+#include "moveBatcher.h"
+#include "protocol.h"
+#include "tableCheckpoint.h"
+#include "timerWheel.h"
+#include "turnScheduler.h"
+
+class ServerTable;
+class TableServer;
+
+// 一个分片 = 一个线程 + 一个 epoll + 一个时间轮 + 一组牌桌。
+// 牌桌 t 固定属于分片 t % shardCount，它的 Judge、AI 延时、超时和入座连接都只在该分片线程里访问，
+// 热路径上没有任何跨分片的锁；只有新连接和换桌时通过收件箱（互斥锁 + eventfd）转交连接。
+// 牌桌按需创建：空桌只占一个槽位；没人看的牌桌在局间停放成一条检查点记录（几百字节），
+// 有人入座或观战时再从记录恢复成完整的 ServerTable。
+class TableShard : public TurnScheduler {
+public:
+    TableShard(TableServer* server, int index, int shardCount);
+    ~TableShard() override;
+
+    int index() const { return index_; }
+
+    // 在分片线程中创建本分片负责的牌桌（全局编号 index, index + shardCount, ...），
+    // restoreFrom 不为空时按检查点恢复已开局的牌桌（须在 ready 之前保持映射有效）
+    void configure(int totalTables, bool autoplay, double delayScale, int turnTimeoutMs, bool pinToCore,
+                   const TableCheckpoint* restoreFrom = nullptr);
+    void start();
+    void stop();
+    void join();
+
+    // 任意线程调用：把一个连接（及已读到但未处理的输入、已协商的协议版本、
+    // 原分片还没发完的输出和队首帧已发出的字节数）交给本分片
+    void adopt(int fd, std::string pendingInput, uint8_t version = 0,
+               std::deque<proto::SharedFrame> pendingOutput = {}, size_t outOffset = 0);
+
+    // TurnScheduler：牌桌线程内调用，延时按 delayScale 缩放
+    void schedule(int delayMs, std::function<void()> task) override;
+    // 不缩放的定时任务（玩家超时、统计）
+    void scheduleWallClock(int delayMs, std::function<void()> task);
+    // 牌桌的定时任务：owner 为牌桌创建时分配的代号，牌桌停放后残留的任务到期时直接丢弃
+    void scheduleFor(uint64_t owner, int delayMs, std::function<void()> task, bool wallClock = false);
+    // 空闲任务（AI 预想）：只在没有 I/O、没有就绪任务时每轮执行一个，deadline 不晚于下一个定时任务；
+    // 队列超过 kMaxIdleTasks 时丢弃最早的。owner 同 scheduleFor
+    void scheduleIdle(IdleTask task) override { scheduleIdleFor(0, std::move(task)); }
+    void scheduleIdleFor(uint64_t owner, IdleTask task);
+    int turnTimeoutMs() const { return turnTimeoutMs_; }
+
+    // 分片内所有牌桌共用一副牌发牌（只在分片线程内使用）
+    Deck& deck() { return deck_; }
+
+    // 跨牌桌批量 AI 决策，须在 start() 之前设置；maxBatch 为 0 时关闭，各牌桌同步决策
+    void setMoveBatching(int maxBatch, int maxDelayMs);
+    bool moveBatchingEnabled() const { return moveBatchMax_ > 0; }
+    // 所有分片共用的 AI 决策缓存（TableServer 持有），须在 start() 之前设置；nullptr 表示不用
+    void setDecisionCache(DecisionCache* cache);
+    DecisionCache* decisionCache() const { return decisionCache_; }
+    // 牌桌 AI 每步同步决策的计算时限（见 AIPlayer::setThinkBudget），须在 start() 之前设置；批量决策不搜索
+    void setAiThinkBudget(std::chrono::microseconds budget) { aiThinkBudget_ = budget; }
+    std::chrono::microseconds aiThinkBudget() const { return aiThinkBudget_; }
+    // 牌桌 AI 在别人回合里预想下一手的时限（毫秒，见 Judge::setPonderBudgetMs），须在 start() 之前设置
+    void setAiPonderBudgetMs(int ms) { aiPonderBudgetMs_ = ms; }
+    int aiPonderBudgetMs() const { return aiPonderBudgetMs_; }
+    // 牌桌线程内调用：请求排队，凑满一批或最多等 maxDelayMs 后统一决策，owner 同 scheduleFor
+    void requestMove(uint64_t owner, AIPlayer* ai, const std::vector<Card>& lastCards, int levelRank,
+                     MoveBatcher::Done done);
+
+    // 牌桌线程内调用：局间没人看（也不是 autoplay）的牌桌停放成检查点记录并销毁，返回是否已停放；
+    // 返回 true 时调用方（该牌桌自己的定时任务）不得再访问牌桌
+    bool parkIfIdle(int table);
+
+    // 牌桌线程内调用：发给某个座位；或发给该桌所有入座玩家和观战者（各连接只入队同一份帧的引用）
+    void sendToSeat(int table, int seat, proto::SharedFrame frame);
+    void broadcast(int table, const proto::SharedFrame& frame);
+    // 该桌是否有人在看（入座或观战），没人时牌桌可以跳过编码
+    bool hasAudience(int table) const;
+
+    // 任意线程调用：让分片在下一轮循环把本分片已开局的牌桌写进检查点，写完调用 checkpoint->writerDone()
+    void requestCheckpoint(TableCheckpoint* checkpoint);
+
+    // 由分片线程定期发布，供主线程读取
+    std::atomic<long long> gamesFinished{0};
+    std::atomic<int> connections{0};
+    // 牌桌创建（及恢复）完成后置位
+    std::atomic<bool> ready{false};
+    std::atomic<int> restoredTables{0};
+    // 驻留（完整对象）与停放（只剩记录）的牌桌数
+    std::atomic<int> liveTables{0};
+    std::atomic<int> parkedTables{0};
+    std::atomic<long long> aiDecisions{0};
+    std::atomic<long long> aiBatches{0};
+    std::atomic<long long> moveIndexBytes{0}; // 驻留牌桌的合法出牌索引合计
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        std::deque<proto::SharedFrame> out; // 待发送的帧，广播帧在多个连接间共享
+        size_t outOffset = 0;               // out.front() 已发送的字节数
+        size_t outBytes = 0;                // 队列中尚未发送的总字节数
+        int table = -1; // 全局牌桌编号
+        int seat = -1;
+        bool spectator = false;
+        uint8_t version = 0; // 0 表示尚未收到 Hello
+        bool wantWrite = false;
+        bool dirty = false;
+        bool closing = false;
+    };
+    struct Adopted {
+        int fd;
+        std::string input;
+        uint8_t version;
+        std::deque<proto::SharedFrame> output;
+        size_t outOffset;
+    };
+    struct IdleEntry {
+        uint64_t owner;
+        IdleTask task;
+    };
+    static constexpr size_t kMaxIdleTasks = 4096;
+
+    struct TableSlot {
+        std::unique_ptr<ServerTable> live;
+        std::unique_ptr<TableCheckpoint::Record> parked; // 停放时保存的状态，与 live 互斥
+        uint32_t generation = 0;                         // 每次创建牌桌加一，用作定时任务的代号
+    };
+
+    void run();
+    void createTables();
+    void drainInbox();
+    void addConnection(Adopted&& adopted);
+    void handleReadable(Connection& conn);
+    void processInput(Connection& conn);
+    void handleWritable(Connection& conn);
+    // 返回 false 表示连接已转交给其他分片（或因正在关闭而放弃转交），调用方应停止处理
+    bool handleFrame(Connection& conn, const proto::FrameView& frame, size_t frameStart);
+    bool handleJoin(Connection& conn, const proto::FrameView& frame, size_t frameStart);
+    bool handleWatch(Connection& conn, const proto::FrameView& frame, size_t frameStart);
+    // 牌桌不在本分片时把连接连同 frameStart 之后的输入和未发完的输出转交出去；正在关闭的连接不转交
+    void handOff(Connection& conn, int table, size_t frameStart);
+    void sendFrame(Connection& conn, proto::SharedFrame frame);
+    void sendError(Connection& conn, proto::ErrorCode code);
+    void flushOutputs();
+    void markClosing(Connection& conn);
+    void closePending();
+    void closeConnection(int fd);
+    void releaseSeat(Connection& conn);
+    void updateInterest(Connection& conn);
+    void publishStats();
+    void writeCheckpoint(TableCheckpoint& checkpoint);
+    // 对本轮收到座位操作的牌桌统一应用事件队列
+    void processTableEvents();
+    // 执行一个空闲任务，最多用到 deadline
+    void runIdleTask(Clock::time_point deadline);
+
+    bool ownsTable(int table) const { return table >= 0 && table % shardCount_ == index_; }
+    // 未创建或已停放时返回 nullptr
+    ServerTable* localTable(int table) const { return slots_[table / shardCount_].live.get(); }
+    // 取得驻留的牌桌，必要时新建或从停放的记录恢复
+    ServerTable* materialize(int table);
+    bool isTimerOwnerAlive(uint64_t owner) const;
+    int& seatFd(int table, int seat) { return seatFds_[static_cast<size_t>(table / shardCount_) * 4 + seat]; }
+    uint64_t nowTick() const;
+
+    TableServer* server_;
+    int index_;
+    int shardCount_;
+    int totalTables_ = 0;
+    bool autoplay_ = false;
+    double delayScale_ = 1.0;
+    int turnTimeoutMs_ = 30000;
+    bool pinToCore_ = true;
+    const TableCheckpoint* restoreFrom_ = nullptr;
+    std::atomic<TableCheckpoint*> checkpointRequest_{nullptr};
+
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    TimerWheel wheel_;
+    Clock::time_point epoch_;
+    std::deque<IdleEntry> idleTasks_;
+
+    std::vector<TableSlot> slots_; // 下标为本分片内的牌桌序号
+    Deck deck_;
+    MoveBatcher batcher_;
+    DecisionCache* decisionCache_ = nullptr;
+    std::chrono::microseconds aiThinkBudget_{0};
+    int aiPonderBudgetMs_ = 0;
+    int moveBatchMax_ = 0;
+    int moveBatchDelayMs_ = 2;
+    std::vector<int> seatFds_;
+    std::vector<std::vector<int>> spectatorFds_; // 下标为本分片内的牌桌序号
+    std::unordered_map<int, Connection> connections_;
+    std::vector<int> dirtyFds_;
+    std::vector<int> closingFds_;
+    std::vector<int> eventTables_; // 本轮有待处理座位事件的牌桌（全局编号）
+    // 解码用的复用缓冲区
+    std::vector<Card> scratchCards_;
+
+    // 跨线程收件箱：只在接入/换桌时使用
+    std::mutex inboxLock_;
+    std::vector<Adopted> inbox_;
+};
+
+#endif // TABLESHARD_H
@@ -0,0 +1,136 @@
+#include "timerWheel.h"
+#include <utility>
+
+TimerWheel::TimerWheel() {
+    for (int level = 0; level < kLevels; ++level) {
+        slots_[level].resize(static_cast<size_t>(levelSlots(level)));
+    }
+}
+
+int TimerWheel::allocNode() {
+    if (freeHead_ >= 0) {
+        int index = freeHead_;
+        freeHead_ = nodes_[index].next;
+        nodes_[index].next = -1;
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<int>(nodes_.size()) - 1;
+}
+
+void TimerWheel::freeNode(int index) {
+    nodes_[index].task = nullptr;
+    nodes_[index].next = freeHead_;
+    freeHead_ = index;
+}
+
+void TimerWheel::append(Slot& slot, int index) {
+    // 同一槽内保持提交顺序
+    nodes_[index].next = -1;
+    if (slot.tail >= 0) nodes_[slot.tail].next = index;
+    else slot.head = index;
+    slot.tail = index;
+}
+
+void TimerWheel::insert(int index) {
+    Node& node = nodes_[index];
+    if (node.expires < currentTick_) node.expires = currentTick_;
+    const uint64_t diff = node.expires - currentTick_;
+
+    int level = 0;
+    while (level < kLevels - 1 && diff >= (uint64_t{1} << levelShift(level + 1))) ++level;
+
+    // 超出最高层范围的任务挂在最高层最远的槽上，下放时再重新计算
+    uint64_t expires = node.expires;
+    const uint64_t maxSpan = uint64_t{1} << (levelShift(kLevels - 1) + kLevelBits);
+    if (diff >= maxSpan) expires = currentTick_ + maxSpan - 1;
+
+    const int slotIndex = static_cast<int>((expires >> levelShift(level)) & (levelSlots(level) - 1));
+    append(slots_[level][slotIndex], index);
+    ++levelCounts_[level];
+}
+
+void TimerWheel::schedule(uint64_t delayTicks, std::function<void()> task, uint64_t owner) {
+    const int index = allocNode();
+    nodes_[index].expires = currentTick_ + delayTicks;
+    nodes_[index].owner = owner;
+    nodes_[index].task = std::move(task);
+    ++pending_;
+    if (delayTicks == 0) {
+        append(ready_, index);
+        ++readyCount_;
+        return;
+    }
+    insert(index);
+}
+
+void TimerWheel::cascade(int level, int slotIndex) {
+    Slot& slot = slots_[level][slotIndex];
+    int index = slot.head;
+    slot = Slot{};
+    while (index >= 0) {
+        const int next = nodes_[index].next;
+        --levelCounts_[level];
+        insert(index);
+        index = next;
+    }
+}
+
+size_t TimerWheel::runList(int index, bool fromWheel) {
+    size_t ran = 0;
+    while (index >= 0) {
+        const int next = nodes_[index].next;
+        auto task = std::move(nodes_[index].task);
+        const uint64_t owner = nodes_[index].owner;
+        if (fromWheel) --levelCounts_[0];
+        else --readyCount_;
+        --pending_;
+        freeNode(index);
+        index = next;
+        // 所属对象已销毁的任务不执行（不逐个撤销，到期时再过滤）
+        if (owner != 0 && ownerAlive_ && !ownerAlive_(owner)) continue;
+        task();
+        ++ran;
+    }
+    return ran;
+}
+
+size_t TimerWheel::advance(uint64_t nowTick) {
+    size_t ran = 0;
+    while (currentTick_ <= nowTick) {
+        // 先摘下本 tick 的槽再推进时间：任务里新安排的非 0 延时任务从下一个 tick 起算
+        Slot& slot = slots_[0][currentTick_ & (kRootSlots - 1)];
+        int index = slot.head;
+        slot = Slot{};
+
+        ++currentTick_;
+        for (int level = 1; level < kLevels; ++level) {
+            const uint64_t mask = (uint64_t{1} << levelShift(level)) - 1;
+            if ((currentTick_ & mask) != 0) break;
+            cascade(level, static_cast<int>((currentTick_ >> levelShift(level)) & (kLevelSlots - 1)));
+        }
+
+        ran += runList(index, true);
+        if (pending_ == readyCount_ && currentTick_ <= nowTick) {
+            currentTick_ = nowTick + 1; // 空轮直接跳到当前时间
+        }
+    }
+    // 就绪队列整批摘下再执行，执行中新安排的 0 延时任务进下一轮
+    for (int round = 0; round < kReadyRounds && ready_.head >= 0; ++round) {
+        const int index = ready_.head;
+        ready_ = Slot{};
+        ran += runList(index, false);
+    }
+    return ran;
+}
+
+int64_t TimerWheel::ticksUntilNext() const {
+    if (pending_ == readyCount_) return -1;
+    if (levelCounts_[0] > 0) {
+        for (int i = 0; i < kRootSlots; ++i) {
+            if (slots_[0][(currentTick_ + i) & (kRootSlots - 1)].head >= 0) return i;
+        }
+    }
+    // 只剩高层任务：等到第 0 层转完这一圈，届时会发生下放
+    return kRootSlots - static_cast<int64_t>(currentTick_ & (kRootSlots - 1));
+}
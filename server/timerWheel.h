@@ -0,0 +1,75 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 分层时间轮（1 tick = 1ms）：第 0 层 256 个槽覆盖 256ms，之后每层 64 个槽，
+// 四层共约 18 小时，更远的任务按最远槽处理。插入和到期都是 O(1)，
+// 高层槽在低层转完一圈时整体下放（cascade），不需要堆排序。
+// 非线程安全：每个分片线程独占一个时间轮。
+class TimerWheel {
+public:
+    TimerWheel();
+
+    // delayTicks 个 tick 之后执行；0 表示放进就绪队列，下一次 advance 返回前执行（不等下一个 tick）。
+    // owner 非 0 时到期前先经 setOwnerCheck 设置的回调确认所属对象仍然存在，否则直接丢弃
+    void schedule(uint64_t delayTicks, std::function<void()> task, uint64_t owner = 0);
+    void setOwnerCheck(std::function<bool(uint64_t)> check) { ownerAlive_ = std::move(check); }
+
+    // 推进到 nowTick（含），依次执行所有到期任务，再执行就绪队列，返回执行的任务数。
+    // 就绪任务里又安排的 0 延时任务也在本次执行，最多 kReadyRounds 轮，剩下的留给下一次 advance
+    size_t advance(uint64_t nowTick);
+
+    uint64_t currentTick() const { return currentTick_; }
+    size_t pending() const { return pending_; }
+
+    // 就绪队列里还有任务（advance 的轮数用完了）：调用方不应再等待
+    bool hasReady() const { return ready_.head >= 0; }
+    // 从 currentTick() 起到下一个可能到期的槽还有多少 tick（不含就绪队列）；时间轮上没有任务时返回 -1
+    int64_t ticksUntilNext() const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kRootBits = 8;
+    static constexpr int kLevelBits = 6;
+    static constexpr int kRootSlots = 1 << kRootBits;
+    static constexpr int kLevelSlots = 1 << kLevelBits;
+    static constexpr int kReadyRounds = 16;
+
+    struct Node {
+        uint64_t expires = 0;
+        uint64_t owner = 0;
+        int next = -1;
+        std::function<void()> task;
+    };
+    struct Slot {
+        int head = -1;
+        int tail = -1;
+    };
+
+    int allocNode();
+    void freeNode(int index);
+    void insert(int index);
+    void append(Slot& slot, int index);
+    void cascade(int level, int slotIndex);
+    size_t runList(int index, bool fromWheel);
+
+    static int levelShift(int level) { return level == 0 ? 0 : kRootBits + (level - 1) * kLevelBits; }
+    static int levelSlots(int level) { return level == 0 ? kRootSlots : kLevelSlots; }
+
+    // 节点池：槽里只存下标，扩容不会使链表失效
+    std::vector<Node> nodes_;
+    int freeHead_ = -1;
+    std::array<std::vector<Slot>, kLevels> slots_;
+    std::array<uint64_t, kLevels> levelCounts_{}; // 每层挂着的任务数
+    Slot ready_;                                  // 0 延时任务，按提交顺序
+    size_t readyCount_ = 0;
+    uint64_t currentTick_ = 0;
+    size_t pending_ = 0;
+    std::function<bool(uint64_t)> ownerAlive_;
+};
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,153 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+// 带内联存储的顺序容器：不超过 N 个元素时全部放在对象内部，不碰堆；超出才换到堆上（极少发生）。
+// 只用于可平凡复制的小元素（Card 等），搬移都是 memcpy。接口取 std::vector 的常用子集。
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector 只存放可平凡复制的元素");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() noexcept = default;
+    template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+    SmallVector(It first, It last) { append(first, last); }
+    SmallVector(std::initializer_list<T> items) { append(items.begin(), items.end()); }
+
+    SmallVector(const SmallVector& other) { append(other.begin(), other.end()); }
+    SmallVector(SmallVector&& other) noexcept { takeFrom(other); }
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            append(other.begin(), other.end());
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            takeFrom(other);
+        }
+        return *this;
+    }
+    ~SmallVector() { release(); }
+
+    T* data() noexcept { return heap_ ? heap_ : inlineData(); }
+    const T* data() const noexcept { return heap_ ? heap_ : inlineData(); }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // 当前是否仍在内联存储里
+    bool isInline() const noexcept { return heap_ == nullptr; }
+
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + size_; }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + size_; }
+
+    T& operator[](size_t i) noexcept { return data()[i]; }
+    const T& operator[](size_t i) const noexcept { return data()[i]; }
+    T& front() noexcept { return data()[0]; }
+    const T& front() const noexcept { return data()[0]; }
+    T& back() noexcept { return data()[size_ - 1]; }
+    const T& back() const noexcept { return data()[size_ - 1]; }
+
+    void clear() noexcept { size_ = 0; }
+    void pop_back() noexcept { --size_; }
+    void reserve(size_t n) {
+        if (n > capacity_) grow(n);
+    }
+    // 变长时新位置值初始化
+    void resize(size_t n) {
+        reserve(n);
+        for (size_t i = size_; i < n; ++i) new (data() + i) T();
+        size_ = static_cast<uint32_t>(n);
+    }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            const T copy = value; // value 可能就在本容器里
+            grow(capacity_ * 2);
+            data()[size_++] = copy;
+            return;
+        }
+        data()[size_++] = value;
+    }
+
+    template <typename It>
+    void append(It first, It last) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        reserve(size_ + count);
+        T* out = data() + size_;
+        for (; first != last; ++first) *out++ = *first;
+        size_ += static_cast<uint32_t>(count);
+    }
+    // 在 pos 处插入 [first, last)，区间不能来自本容器
+    template <typename It>
+    iterator insert(const_iterator pos, It first, It last) {
+        const size_t offset = static_cast<size_t>(pos - begin());
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        reserve(size_ + count);
+        T* at = data() + offset;
+        std::memmove(static_cast<void*>(at + count), at, (size_ - offset) * sizeof(T));
+        for (T* out = at; first != last; ++first) *out++ = *first;
+        size_ += static_cast<uint32_t>(count);
+        return at;
+    }
+
+    friend bool operator==(const SmallVector& a, const SmallVector& b) {
+        if (a.size_ != b.size_) return false;
+        for (size_t i = 0; i < a.size_; ++i) {
+            if (!(a[i] == b[i])) return false;
+        }
+        return true;
+    }
+
+private:
+    T* inlineData() noexcept { return std::launder(reinterpret_cast<T*>(storage_)); }
+    const T* inlineData() const noexcept { return std::launder(reinterpret_cast<const T*>(storage_)); }
+
+    void grow(size_t n) {
+        T* bigger = static_cast<T*>(::operator new(n * sizeof(T)));
+        std::memcpy(static_cast<void*>(bigger), data(), size_ * sizeof(T));
+        release();
+        heap_ = bigger;
+        capacity_ = static_cast<uint32_t>(n);
+    }
+    void release() noexcept {
+        if (heap_) ::operator delete(heap_);
+        heap_ = nullptr;
+        capacity_ = N;
+    }
+    void takeFrom(SmallVector& other) noexcept {
+        if (other.heap_) {
+            heap_ = other.heap_;
+            capacity_ = other.capacity_;
+            other.heap_ = nullptr;
+            other.capacity_ = N;
+        } else {
+            std::memcpy(static_cast<void*>(storage_), other.storage_, other.size_ * sizeof(T));
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+    T* heap_ = nullptr;
+    uint32_t size_ = 0;
+    uint32_t capacity_ = N;
+};
+
+#endif // SMALLVECTOR_H
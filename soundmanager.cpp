@@ -1,29 +1,57 @@
 #include "soundmanager.h"
+#include "pcmMixer.h"
 #include <QDebug>
+#include <QMetaObject>
+#include <QCoreApplication>
 
 SoundManager::SoundManager(QObject* parent)
     : QObject(parent) {
+    // 混音器放在独立的音频线程里，readData 不会被 UI 绘制或 AI 计算阻塞
+    m_mixer = new PcmMixer;
+    m_mixer->moveToThread(&m_audioThread);
+    connect(&m_audioThread, &QThread::finished, m_mixer, &QObject::deleteLater);
+    m_audioThread.setObjectName("SoundManagerAudio");
+    m_audioThread.start(QThread::TimeCriticalPriority);
+    m_mixer->setBusVolume(EffectBus, m_volume);
+
+    // 单例是函数内静态对象，析构时 QApplication 已销毁；音频输出必须在事件循环结束前关闭
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &SoundManager::shutdown);
+    }
 }
 
 SoundManager::~SoundManager() {
-    qDeleteAll(m_sounds.values());
-    m_sounds.clear();
-    if (m_initBackgroundSound) {
-        m_initBackgroundSound->deleteLater();
+    // 正常退出时 aboutToQuit 已完成 shutdown()，这里不再跨线程阻塞调用
+    if (m_audioThread.isRunning()) {
+        qWarning() << "SoundManager destroyed without shutdown(); audio thread left running";
     }
 }
 
+void SoundManager::shutdown() {
+    if (!m_mixer) return;
+    QMetaObject::invokeMethod(m_mixer, "stopOutput", Qt::BlockingQueuedConnection);
+    m_audioThread.quit();
+    m_audioThread.wait();
+    m_mixer = nullptr;  // 线程结束时已 deleteLater
+    m_initBackgroundVoice = 0;
+    m_gameBackgroundVoice = 0;
+    m_sounds.clear();
+}
+
 SoundManager& SoundManager::instance() {
     static SoundManager manager;
     return manager;
 }
 
 void SoundManager::init() {
+    if (!m_mixer) return;
+    QMetaObject::invokeMethod(m_mixer, "startOutput", Qt::QueuedConnection, Q_ARG(int, 10));
+
     // 1. 加载初始化背景音并淡入
     loadInitBackgroundSound();
     fadeInInitBackground();
 
-    // 2. 加载游戏内音效
+    // 2. 加载游戏内音效（只解码一次，之后所有播放共享同一份 PCM）
     loadSound("deal", ":/sounds/deal.wav");          // 发牌音效
     loadSound("bid", ":/sounds/bid.wav");            // 叫地主音效
     loadSound("pass", ":/sounds/pass.wav");          // 不要音效
@@ -31,102 +59,99 @@ void SoundManager::init() {
     loadSound("win", ":/sounds/win.wav");            // 胜利音效
     loadSound("lose", ":/sounds/lose.wav");          // 失败音效
     loadSound("background", ":/sounds/background.wav"); // 游戏背景音（先不自动播放）
+    loadSound("load_tick", ":/sounds/load_tick.wav");   // 加载反馈音
 }
 
 void SoundManager::loadSound(const QString& soundName, const QString& filePath) {
-    QSoundEffect* effect = new QSoundEffect(this);
-    effect->setSource(QUrl(filePath));  // 修正：使用qrc资源路径，而非本地文件
-    effect->setVolume(m_volume);
-    m_sounds[soundName] = effect;
+    if (m_sounds.contains(soundName)) return;
+    QByteArray pcm = PcmMixer::decodeWav(filePath);
+    if (pcm.isEmpty()) {
+        qWarning() << "Sound decode failed:" << soundName << filePath;
+        return;
+    }
+    m_sounds.insert(soundName, pcm);
 }
 
 void SoundManager::loadInitBackgroundSound() {
-    m_initBackgroundSound = new QSoundEffect(this);
-    m_initBackgroundSound->setSource(QUrl("qrc:/sounds/init_background.wav"));
-    m_initBackgroundSound->setLoopCount(QSoundEffect::Infinite);  // 循环播放
-    m_initBackgroundSound->setVolume(0.0);  // 初始音量0，准备淡入
+    loadSound("init_background", ":/sounds/init_background.wav");
+    if (m_initBackgroundVoice || !m_mixer) return;
+    // 初始音量0，准备淡入；循环播放
+    m_initBackgroundVoice = m_mixer->play(m_sounds.value("init_background"), 0.0, true);
 }
 
 void SoundManager::fadeInInitBackground(qreal duration) {
-    if (!m_initBackgroundSound) return;
-    QPropertyAnimation* fadeAnim = new QPropertyAnimation(m_initBackgroundSound, "volume");
-    fadeAnim->setDuration(duration);
-    fadeAnim->setStartValue(0.0);
-    fadeAnim->setEndValue(0.3);  // 初始化背景音音量较低，营造轻柔氛围
-    fadeAnim->start(QAbstractAnimation::DeleteWhenStopped);
-    m_initBackgroundSound->play();
+    if (!m_initBackgroundVoice) return;
+    m_initBackgroundVolume = 0.3;  // 初始化背景音音量较低，营造轻柔氛围
+    m_mixer->fade(m_initBackgroundVoice, m_initBackgroundVolume, static_cast<int>(duration));
 }
 
 void SoundManager::fadeOutInitBackground(qreal duration) {
-    if (!m_initBackgroundSound) return;
-    QPropertyAnimation* fadeAnim = new QPropertyAnimation(m_initBackgroundSound, "volume");
-    fadeAnim->setDuration(duration);
-    fadeAnim->setStartValue(m_initBackgroundSound->volume());
-    fadeAnim->setEndValue(0.0);
-    fadeAnim->start(QAbstractAnimation::DeleteWhenStopped);
-    connect(fadeAnim, &QPropertyAnimation::finished,
-            m_initBackgroundSound, &QSoundEffect::stop);
+    if (!m_initBackgroundVoice) return;
+    m_mixer->fade(m_initBackgroundVoice, 0.0, static_cast<int>(duration), true);
+    m_initBackgroundVoice = 0;
+    m_initBackgroundVolume = 0.0;
 }
 
 void SoundManager::playSound(const QString& soundName) {
-    if (!m_enabled) return;
-    if (m_sounds.contains(soundName)) {
-        m_sounds[soundName]->play();
+    if (!m_enabled || !m_mixer) return;
+    auto it = m_sounds.constFind(soundName);
+    if (it != m_sounds.constEnd()) {
+        m_mixer->play(it.value(), 1.0, false, EffectBus);
     } else {
         qWarning() << "Sound not found:" << soundName;
     }
 }
 
 void SoundManager::playLoadTick() {
-    QSoundEffect* tick = new QSoundEffect(this);
-    tick->setSource(QUrl("qrc:/sounds/load_tick.wav"));
-    tick->setVolume(m_volume * 0.5);  // 加载反馈音音量稍低
-    tick->play();
-    connect(tick, &QSoundEffect::playingChanged, [tick]() {
-        if (!tick->isPlaying()) {
-            tick->deleteLater();
-        }
-    });
+    if (!m_enabled || !m_mixer) return;
+    m_mixer->play(m_sounds.value("load_tick"), 0.5, false, EffectBus);  // 加载反馈音音量稍低
+}
+
+void SoundManager::playBackgroundMusic(qreal volume) {
+    if (!m_mixer) return;
+    if (!m_sounds.contains("background")) {
+        qWarning() << "Game background sound not loaded!";
+        return;
+    }
+    if (m_gameBackgroundVoice) {
+        m_mixer->setVoiceVolume(m_gameBackgroundVoice, volume);
+        return;
+    }
+    m_gameBackgroundVoice = m_mixer->play(m_sounds.value("background"), volume, true);
+    if (!m_enabled) m_mixer->setPaused(m_gameBackgroundVoice, true);
 }
 
 void SoundManager::switchToGameBackground() {
+    if (!m_mixer) return;
     if (!m_sounds.contains("background")) {
         qWarning() << "Game background sound not loaded!";
         return;
     }
-    m_gameBackgroundSound = m_sounds["background"];
-    m_gameBackgroundSound->setLoopCount(QSoundEffect::Infinite);
-    m_gameBackgroundSound->setVolume(0.0);
-    m_gameBackgroundSound->play();
+    if (!m_gameBackgroundVoice) {
+        m_gameBackgroundVoice = m_mixer->play(m_sounds.value("background"), 0.0, true);
+    }
 
     // 淡入游戏背景音
-    QPropertyAnimation* gameFadeIn = new QPropertyAnimation(m_gameBackgroundSound, "volume");
-    gameFadeIn->setDuration(3000);
-    gameFadeIn->setStartValue(0.0);
-    gameFadeIn->setEndValue(0.5);
-    gameFadeIn->start(QAbstractAnimation::DeleteWhenStopped);
+    m_mixer->fade(m_gameBackgroundVoice, 0.5, 3000);
 
     // 淡出初始化背景音
     fadeOutInitBackground();
 }
 
 void SoundManager::setVolume(qreal volume) {
-    m_volume = volume;
-    foreach (QSoundEffect* effect, m_sounds.values()) {
-        effect->setVolume(volume);
-    }
-    if (m_initBackgroundSound) {
-        m_initBackgroundSound->setVolume(m_initBackgroundSound->volume() * volume / 0.7);
+    if (!m_mixer) return;
+    // 音效总线的增益对正在播放和之后触发的音效同时生效
+    m_mixer->setBusVolume(EffectBus, volume);
+    if (m_initBackgroundVoice) {
+        m_initBackgroundVolume = m_initBackgroundVolume * volume / 0.7;
+        m_mixer->setVoiceVolume(m_initBackgroundVoice, m_initBackgroundVolume);
     }
+    m_volume = volume;
 }
 
 void SoundManager::setEnabled(bool enabled) {
     m_enabled = enabled;
-    if (!enabled) {
-        if (m_initBackgroundSound) m_initBackgroundSound->stop();
-        if (m_gameBackgroundSound) m_gameBackgroundSound->stop();
-    } else {
-        if (m_initBackgroundSound) m_initBackgroundSound->play();
-        if (m_gameBackgroundSound) m_gameBackgroundSound->play();
-    }
+    if (!m_mixer) return;
+    if (m_initBackgroundVoice) m_mixer->setPaused(m_initBackgroundVoice, !enabled);
+    if (m_gameBackgroundVoice) m_mixer->setPaused(m_gameBackgroundVoice, !enabled);
 }
@@ -0,0 +1,53 @@
+#ifndef SOUNDMANAGER_H
+#define SOUNDMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QByteArray>
+#include <QThread>
+
+class PcmMixer;
+
+// 全局音效管理：所有音效在 init() 时一次性解码进内存，交给音频线程中的 PcmMixer 混音播放
+class SoundManager : public QObject {
+    Q_OBJECT
+public:
+    static SoundManager& instance();
+
+    void init();
+    void playSound(const QString& soundName);
+    void playLoadTick();
+    // 循环播放游戏背景音（与 switchToGameBackground 共用同一份解码数据）
+    void playBackgroundMusic(qreal volume = 0.3);
+    void switchToGameBackground();
+    void fadeInInitBackground(qreal duration = 2000);
+    void fadeOutInitBackground(qreal duration = 2000);
+    void setVolume(qreal volume);
+    void setEnabled(bool enabled);
+    // 停止输出并结束音频线程；须在 QApplication 析构前调用（已连接到 aboutToQuit），可重复调用
+    void shutdown();
+
+private:
+    // 混音总线：音效统一受 setVolume 控制，背景音各自管理音量
+    enum Bus { MusicBus = 0, EffectBus = 1 };
+
+    explicit SoundManager(QObject* parent = nullptr);
+    ~SoundManager() override;
+    SoundManager(const SoundManager&) = delete;
+    SoundManager& operator=(const SoundManager&) = delete;
+
+    void loadSound(const QString& soundName, const QString& filePath);
+    void loadInitBackgroundSound();
+
+    QThread m_audioThread;
+    PcmMixer* m_mixer = nullptr;
+    QHash<QString, QByteArray> m_sounds;   // 预解码 PCM，按名称共享
+    int m_initBackgroundVoice = 0;
+    int m_gameBackgroundVoice = 0;
+    qreal m_initBackgroundVolume = 0.0;
+    qreal m_volume = 0.7;
+    bool m_enabled = true;
+};
+
+#endif // SOUNDMANAGER_H
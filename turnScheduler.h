@@ -0,0 +1,24 @@
+#ifndef TURNSCHEDULER_H
+#define TURNSCHEDULER_H
+
+#include <chrono>
+#include <functional>
+
+// Judge 的延时任务出口（AI 思考延迟、进贡步骤、状态增量合并、空闲时的预想）。
+// 未设置时 Judge 使用 QTimer；服务器为成千上万张牌桌提供统一的调度实现，避免每桌一个定时器。
+class TurnScheduler {
+public:
+    // 可有可无的后台工作，deadline 为这次最多能用到的时刻
+    using IdleTask = std::function<void(std::chrono::steady_clock::time_point deadline)>;
+
+    virtual ~TurnScheduler() = default;
+
+    // delayMs 毫秒后在牌桌所属线程上执行 task
+    virtual void schedule(int delayMs, std::function<void()> task) = 0;
+    // 线程空闲时执行 task，可能很晚才执行或被丢弃。默认当作 0 延时任务、不另设时限，由 task 自己控制时长
+    virtual void scheduleIdle(IdleTask task) {
+        schedule(0, [task = std::move(task)]() { task(std::chrono::steady_clock::time_point::max()); });
+    }
+};
+
+#endif // TURNSCHEDULER_H